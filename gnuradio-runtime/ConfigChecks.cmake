@@ -164,6 +164,15 @@ CHECK_CXX_SOURCE_COMPILES("
 GR_ADD_COND_DEF(HAVE_SHM_OPEN)
 SET(CMAKE_REQUIRED_LIBRARIES)
 
+########################################################################
+CHECK_CXX_SOURCE_COMPILES("
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    int main(){syscall(SYS_memfd_create, \"\", 0); return 0;}
+    " HAVE_MEMFD_CREATE
+)
+GR_ADD_COND_DEF(HAVE_MEMFD_CREATE)
+
 ########################################################################
 CHECK_CXX_SOURCE_COMPILES("
     #define _GNU_SOURCE
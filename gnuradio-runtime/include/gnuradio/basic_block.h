@@ -28,6 +28,7 @@
 #include <gnuradio/msg_accepter.h>
 #include <gnuradio/runtime_types.h>
 #include <gnuradio/io_signature.h>
+#include <gnuradio/msg_port_queue.h>
 #include <gnuradio/thread/thread.h>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/function.hpp>
@@ -35,7 +36,6 @@
 #include <boost/thread/condition_variable.hpp>
 #include <iostream>
 #include <string>
-#include <deque>
 #include <map>
 
 #ifdef GR_CTRLPORT
@@ -65,17 +65,19 @@ namespace gr {
     typedef std::map<pmt::pmt_t , msg_handler_t, pmt::comperator> d_msg_handlers_t;
     d_msg_handlers_t d_msg_handlers;
   
-    typedef std::deque<pmt::pmt_t> msg_queue_t;
-    typedef std::map<pmt::pmt_t, msg_queue_t, pmt::comperator> msg_queue_map_t;
-    typedef std::map<pmt::pmt_t, msg_queue_t, pmt::comperator>::iterator msg_queue_map_itr;
-    std::map<pmt::pmt_t, boost::shared_ptr<boost::condition_variable>, pmt::comperator> msg_queue_ready;
-  
-    gr::thread::mutex mutex;          //< protects all vars
+    typedef std::map<pmt::pmt_t, msg_port_queue_sptr, pmt::comperator> msg_queue_map_t;
+    typedef msg_queue_map_t::iterator msg_queue_map_itr;
+
+    long d_msgs_pending;              //< messages queued on all ports
+
+    msg_port_queue *port_queue(pmt::pmt_t which_port);
   
   protected:
     friend class flowgraph;
     friend class flat_flowgraph; // TODO: will be redundant
     friend class tpb_thread_body;
+    friend class scheduler_pool;
+    friend class scheduler_cluster;
   
     enum vcolor { WHITE, GREY, BLACK };
   
@@ -92,7 +94,7 @@ namespace gr {
     msg_queue_map_t msg_queue;
     std::vector<boost::any> d_rpc_vars; // container for all RPC variables
   
-    basic_block(void) {} // allows pure virtual interface sub-classes
+    basic_block(void) : d_msgs_pending(0) {} // allows pure virtual interface sub-classes
   
     //! Protected constructor prevents instantiation by non-derived classes
     basic_block(const std::string &name,
@@ -155,6 +157,16 @@ namespace gr {
   
     // ** Message passing interface **
     void message_port_register_in(pmt::pmt_t port_id);
+
+    /*!
+     * \brief Register an input message port with its own queue size
+     * and overflow policy.
+     *
+     * The one argument version takes both from the [DEFAULT]
+     * msg_queue_capacity and msg_queue_policy preferences.
+     */
+    void message_port_register_in(pmt::pmt_t port_id, size_t capacity,
+                                  msg_port_queue::policy_t policy);
     void message_port_register_out(pmt::pmt_t port_id);
     void message_port_pub(pmt::pmt_t port_id, pmt::pmt_t msg);
     void message_port_sub(pmt::pmt_t port_id, pmt::pmt_t target);
@@ -187,16 +199,10 @@ namespace gr {
   
     //! is the queue empty?
     bool empty_p(pmt::pmt_t which_port) { 
-      if(msg_queue.find(which_port) == msg_queue.end())
-        throw std::runtime_error("port does not exist!");
-      return msg_queue[which_port].empty(); 
+      return port_queue(which_port)->empty_p();
     }
     bool empty_p() { 
-      bool rv = true;
-      BOOST_FOREACH(msg_queue_map_t::value_type &i, msg_queue) {
-        rv &= msg_queue[i.first].empty();
-      }
-      return rv;
+      return gr::thread::atomic_load_acquire(&d_msgs_pending) == 0;
     }
 
     //! are all msg ports with handlers empty?
@@ -204,40 +210,46 @@ namespace gr {
         return (empty_p(which_port) || !has_msg_handler(which_port));
     }
     bool empty_handled_p() { 
-      bool rv = true;
+      // Cheap check first; only look at the ports if something is queued.
+      if(empty_p())
+        return true;
       BOOST_FOREACH(msg_queue_map_t::value_type &i, msg_queue) {
-        rv &= empty_handled_p(i.first);
+        if(!empty_handled_p(i.first))
+          return false;
       }
-      return rv;
+      return true;
     }
 
     //! How many messages in the queue?
     size_t nmsgs(pmt::pmt_t which_port) { 
-      if(msg_queue.find(which_port) == msg_queue.end())
-        throw std::runtime_error("port does not exist!");
-      return msg_queue[which_port].size(); 
+      return port_queue(which_port)->nmsgs();
+    }
+
+    //! How many messages has the port's overflow policy dropped?
+    long nmsgs_dropped(pmt::pmt_t which_port) {
+      return port_queue(which_port)->ndropped();
+    }
+
+    //! How many messages has the port's REJECT policy refused?
+    long nmsgs_rejected(pmt::pmt_t which_port) {
+      return port_queue(which_port)->nrejected();
     }
   
-    //| Acquires and release the mutex
-    void insert_tail( pmt::pmt_t which_port, pmt::pmt_t msg);
+    /*!
+     * \returns false if the message was refused because the port's
+     * queue is full and its policy is msg_port_queue::REJECT.
+     */
+    bool insert_tail( pmt::pmt_t which_port, pmt::pmt_t msg);
     /*!
      * \returns returns pmt at head of queue or pmt::pmt_t() if empty.
      */
     pmt::pmt_t delete_head_nowait( pmt::pmt_t which_port);
   
     /*!
-     * \returns returns pmt at head of queue or pmt::pmt_t() if empty.
+     * \returns returns pmt at head of queue, waiting for one if empty.
      */
     pmt::pmt_t delete_head_blocking( pmt::pmt_t which_port);
   
-    msg_queue_t::iterator get_iterator(pmt::pmt_t which_port) {
-      return msg_queue[which_port].begin();
-    }
-
-    void erase_msg(pmt::pmt_t which_port, msg_queue_t::iterator it) {
-      msg_queue[which_port].erase(it);
-    }
-  
     virtual bool has_msg_port(pmt::pmt_t which_port) {
       if(msg_queue.find(which_port) != msg_queue.end()) {
         return true;
@@ -73,6 +73,18 @@ namespace gr {
       TPP_ONE_TO_ONE = 2
     };
 
+    /*!
+     * \brief How the thread-per-block scheduler waits when the block
+     * is blocked on input or output.
+     */
+    enum wait_policy_t {
+      WP_DEFAULT = 0,     //!< use the [DEFAULT] wait_policy preference
+      WP_BLOCK = 1,       //!< sleep on a condition variable right away
+      WP_SPIN = 2,        //!< busy-wait with pause instructions; never sleep
+      WP_SPIN_YIELD = 3,  //!< busy-wait, yielding the CPU between rounds
+      WP_SPIN_BLOCK = 4   //!< busy-wait for a while, then sleep
+    };
+
     virtual ~block();
 
     /*!
@@ -260,6 +272,63 @@ namespace gr {
      */
     void set_tag_propagation_policy(tag_propagation_policy_t p);
 
+    /*!
+     * \brief Asks for the policy used by the scheduler to wait for
+     * input data or output buffer space.
+     */
+    wait_policy_t wait_policy() const { return d_wait_policy; }
+
+    /*!
+     * \brief Set the policy used by the scheduler to wait for input
+     * data or output buffer space.
+     *
+     * The spinning policies trade CPU time for lower hand-off
+     * latency between blocks; the number of spins per round is set
+     * by the [DEFAULT] wait_spin_count preference. WP_DEFAULT uses
+     * the flowgraph-wide [DEFAULT] wait_policy preference. Only used
+     * by the thread-per-block scheduler; may be changed while the
+     * flowgraph is running.
+     */
+    void set_wait_policy(wait_policy_t p) { d_wait_policy = p; }
+
+    /*!
+     * \brief Asks which cluster the clustered scheduler puts this
+     * block in; -1 if it is free to choose.
+     */
+    int cluster() const { return d_cluster; }
+
+    /*!
+     * \brief Put this block in cluster \p id (0 or more) of the
+     * clustered scheduler, or let it choose with -1.
+     *
+     * All blocks of a cluster run on one thread, called one after
+     * the other without any waking up in between, so a cluster suits
+     * a chain of cheap blocks. Only used by the clustered scheduler
+     * (GR_SCHEDULER=CLUSTER); takes effect when the flowgraph is
+     * started.
+     */
+    void set_cluster(int id) { d_cluster = id; }
+
+    /*!
+     * \brief Is this block stamping latency probes?
+     */
+    bool latency_probe() const { return d_latency_probe; }
+
+    /*!
+     * \brief Make this source stamp latency probes.
+     *
+     * With the performance counters on, a source with probes on tags
+     * the first item of a work call with a "gr_latency_probe" tag
+     * holding its unique_id and the time, at most once every [PerfCounters]
+     * latency_probe_period milliseconds. The tags travel downstream
+     * under the blocks' tag propagation policies, and every sink they
+     * reach adds the time they took to a histogram for the path from
+     * that source; see pc_path_latency_percentile(). The
+     * [PerfCounters] latency_probe preference turns probes on for
+     * all sources. Only sources stamp probes.
+     */
+    void set_latency_probe(bool on) { d_latency_probe = on; }
+
     /*!
      * \brief Return the minimum number of output items this block can
      * produce during a call to work.
@@ -465,6 +534,77 @@ namespace gr {
      */
     float pc_work_time_total();
 
+    /*!
+     * \brief Gets the clock cycles spent in work that a fraction \p p
+     * (0 to 1) of work calls stay under.
+     */
+    float pc_work_time_percentile(float p);
+
+    /*!
+     * \brief Gets the 50th, 99th and 99.9th percentiles of clock
+     * cycles spent in work.
+     */
+    std::vector<float> pc_work_time_percentiles();
+
+    /*!
+     * \brief Gets the time, in high_res_timer ticks, that a fraction
+     * \p p of items stay under between being produced upstream and
+     * being consumed by this block. Sampled once per input per work
+     * call, on the oldest item consumed.
+     */
+    float pc_input_latency_percentile(float p);
+
+    /*!
+     * \brief Gets the 50th, 99th and 99.9th percentiles of input latency.
+     */
+    std::vector<float> pc_input_latency_percentiles();
+
+    /*!
+     * \brief Gets the time, in high_res_timer ticks, that a fraction
+     * \p p of waits for input stay under.
+     */
+    float pc_blocked_input_percentile(float p);
+
+    /*!
+     * \brief Gets the 50th, 99th and 99.9th percentiles of time spent
+     * waiting for input.
+     */
+    std::vector<float> pc_blocked_input_percentiles();
+
+    /*!
+     * \brief Gets the time, in high_res_timer ticks, that a fraction
+     * \p p of waits for output space stay under.
+     */
+    float pc_blocked_output_percentile(float p);
+
+    /*!
+     * \brief Gets the 50th, 99th and 99.9th percentiles of time spent
+     * waiting for output space.
+     */
+    std::vector<float> pc_blocked_output_percentiles();
+
+    /*!
+     * \brief Gets the unique_id of every source whose latency probes
+     * have reached this block, in the order they first arrived.
+     */
+    std::vector<int> pc_path_latency_sources();
+
+    /*!
+     * \brief Gets the time, in high_res_timer ticks, that a fraction
+     * \p p of latency probes from source \p source_id took to reach
+     * this block. Returns 0 if none have arrived.
+     */
+    float pc_path_latency_percentile(long source_id, float p);
+
+    /*!
+     * \brief Gets the 50th, 99th and 99.9th percentiles of the probes'
+     * travel time, three per source, for the sources in the order of
+     * pc_path_latency_sources(). Sources only get added at the end,
+     * so the first length/3 of a later pc_path_latency_sources()
+     * are the ones these belong to.
+     */
+    std::vector<float> pc_path_latency_percentiles();
+
     /*!
      * \brief Resets the performance counters
      */
@@ -539,6 +679,9 @@ namespace gr {
     int                   d_max_noutput_items;         // value of max_noutput_items for this block
     int                   d_min_noutput_items;
     tag_propagation_policy_t d_tag_propagation_policy; // policy for moving tags downstream
+    wait_policy_t         d_wait_policy;           // how the scheduler waits when blocked
+    int                   d_cluster;               // clustered scheduler's cluster, or -1
+    bool                  d_latency_probe;         // stamp latency probe tags
     std::vector<int>      d_affinity;              // thread affinity proc. mask
     int                   d_priority;              // thread priority level
     bool                  d_pc_rpc_set;
@@ -28,6 +28,9 @@
 #include <gnuradio/tpb_detail.h>
 #include <gnuradio/tags.h>
 #include <gnuradio/high_res_timer.h>
+#include <gnuradio/latency_histogram.h>
+#include <gnuradio/thread/thread.h>
+#include <map>
 #include <stdexcept>
 
 namespace gr {
@@ -203,6 +206,9 @@ namespace gr {
     void stop_perf_counters(int noutput_items, int nproduced);
     void reset_perf_counters();
 
+    //! Note that the block is blocked on its inputs (or outputs).
+    void blocked_perf_counters(bool input);
+
     // Calls to get performance counter items
     float pc_noutput_items();
     float pc_nproduced();
@@ -229,6 +235,22 @@ namespace gr {
     float pc_work_time_var();
 
     float pc_work_time_total();
+
+    // Latency histograms. Work time is in the same ticks as
+    // pc_work_time; the others are in high_res_timer ticks.
+    const latency_histogram &pc_work_time_hist() const { return d_work_time_hist; }
+    const latency_histogram &pc_input_latency_hist() const { return d_input_latency_hist; }
+    const latency_histogram &pc_blocked_input_hist() const { return d_blocked_input_hist; }
+    const latency_histogram &pc_blocked_output_hist() const { return d_blocked_output_hist; }
+
+    // Travel times of latency probes, per source block unique_id.
+    void add_path_latency(long source_id, gr::high_res_timer_type ticks);
+    std::vector<int> pc_path_latency_sources();
+    float pc_path_latency_percentile(long source_id, float p);
+    std::vector<float> pc_path_latency_percentiles();
+
+    //! Number of work calls averaged into the counters; 0 if they are off.
+    float pc_counter() const { return d_pc_counter; }
  
     tpb_detail d_tpb;	// used by thread-per-block scheduler
     int d_produce_or;
@@ -261,6 +283,16 @@ namespace gr {
     float d_var_work_time;
     float d_total_work_time;
     float d_pc_counter;
+    latency_histogram d_work_time_hist;
+    latency_histogram d_input_latency_hist;	// produce to consume, all inputs
+    latency_histogram d_blocked_input_hist;
+    latency_histogram d_blocked_output_hist;
+    std::vector<uint64_t> d_pc_start_nitems_read;
+    gr::high_res_timer_type d_blocked_since;	// 0 if not blocked
+    bool d_blocked_on_input;
+    gr::thread::mutex d_path_latency_mutex;	// a new path may show up at any time
+    std::map<long, latency_histogram> d_path_latency_hist;
+    std::vector<int> d_path_latency_sources;	// in order of arrival
   
     block_detail(unsigned int ninputs, unsigned int noutputs);
 
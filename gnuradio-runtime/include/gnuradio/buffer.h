@@ -26,9 +26,11 @@
 #include <gnuradio/api.h>
 #include <gnuradio/runtime_types.h>
 #include <gnuradio/tags.h>
+#include <gnuradio/high_res_timer.h>
 #include <boost/weak_ptr.hpp>
 #include <gnuradio/thread/thread.h>
-#include <deque>
+#include <gnuradio/thread/atomic.h>
+#include <map>
 
 namespace gr {
   
@@ -81,7 +83,7 @@ namespace gr {
     void update_write_pointer(int nitems);
 
     void set_done(bool done);
-    bool done() const { return d_done; }
+    bool done() const { return gr::thread::atomic_load_acquire(&d_done); }
 
     /*!
      * \brief Return the block that writes to this buffer.
@@ -93,7 +95,29 @@ namespace gr {
 
     gr::thread::mutex *mutex() { return &d_mutex; }
 
-    uint64_t nitems_written() { return d_abs_write_offset; }
+    uint64_t nitems_written() { return gr::thread::atomic_load_acquire(&d_abs_write_offset); }
+
+    /*!
+     * \brief Number the items of a buffer that takes over the stream
+     * of another one: the next item written is item \p nitems.
+     *
+     * Only for a buffer that nothing has been written to yet, while
+     * its writer and readers are stopped.
+     */
+    void set_nitems_written(uint64_t nitems);
+
+    /*!
+     * \brief Find when item \p abs_offset was produced.
+     *
+     * Produce times are only kept while the performance counters
+     * are on, and only for the most recent produce calls.
+     *
+     * \param abs_offset  absolute item number
+     * \param t           set to the high_res_timer_now() of the
+     *                    produce call that made the item
+     * \returns false if the time is not known.
+     */
+    bool write_time(uint64_t abs_offset, high_res_timer_type &t) const;
 
     size_t get_sizeof_item() { return d_sizeof_item; }
 
@@ -104,6 +128,16 @@ namespace gr {
      */
     void add_item_tag(const tag_t &tag);
 
+    /*!
+     * \brief  Adds a range of tags to the buffer, taking the buffer
+     * lock only once.
+     *
+     * \param begin      iterator to the first tag to add
+     * \param end        iterator past the last tag to add
+     */
+    void add_item_tags(std::vector<tag_t>::const_iterator begin,
+                       std::vector<tag_t>::const_iterator end);
+
     /*!
      * \brief  Removes an existing tag from the buffer.
      *
@@ -125,8 +159,22 @@ namespace gr {
      */
     void prune_tags(uint64_t max_time);
 
-    std::deque<tag_t>::iterator get_tags_begin() { return d_item_tags.begin(); }
-    std::deque<tag_t>::iterator get_tags_end() { return d_item_tags.end(); }
+    /*!
+     * \brief Tags are kept ordered by offset; tags with the same
+     * offset keep the order in which they were added.
+     */
+    typedef std::multimap<uint64_t, tag_t> tag_map_t;
+
+    tag_map_t::iterator get_tags_begin() { return d_item_tags.begin(); }
+    tag_map_t::iterator get_tags_end() { return d_item_tags.end(); }
+
+    /*!
+     * \brief Return an iterator to the first tag at or after item \p abs_offset.
+     */
+    tag_map_t::iterator get_tags_lower_bound(uint64_t abs_offset)
+    {
+      return d_item_tags.lower_bound(abs_offset);
+    }
 
     // -------------------------------------------------------------------------
 
@@ -145,16 +193,32 @@ namespace gr {
     boost::weak_ptr<block>		d_link;		// block that writes to this buffer
 
     //
-    // The mutex protects d_write_index, d_abs_write_offset, d_done, d_item_tags
-    // and the d_read_index's and d_abs_read_offset's in the buffer readers.
+    // The mutex protects d_item_tags and d_last_min_items_read.
+    //
+    // d_write_index and d_abs_write_offset (written only by the
+    // writer), the d_read_index's and d_abs_read_offset's (written
+    // only by their reader) and d_done are published with release
+    // stores and read with acquire loads, so the reader and writer of
+    // a buffer never need the mutex to exchange items.
     //
     gr::thread::mutex			d_mutex;
     unsigned int			d_write_index;	// in items [0,d_bufsize)
     uint64_t                            d_abs_write_offset; // num items written since the start
     bool				d_done;
-    std::deque<tag_t>                d_item_tags;
+    tag_map_t                           d_item_tags;
     uint64_t                            d_last_min_items_read;
 
+    // The end offset and time of the last produce calls, for
+    // write_time(). Empty unless the performance counters are on.
+    // Entry i lives at [i % size] and is published by bumping
+    // d_write_times_head, the same way the write index is.
+    struct write_time_t {
+      uint64_t			end;
+      high_res_timer_type	t;
+    };
+    std::vector<write_time_t>		d_write_times;
+    size_t				d_write_times_head;
+
     unsigned index_add(unsigned a, unsigned b)
     {
       unsigned s = a + b;
@@ -257,7 +321,14 @@ namespace gr {
 
     gr::thread::mutex *mutex() { return d_buffer->mutex(); }
 
-    uint64_t nitems_read() { return d_abs_read_offset; }
+    uint64_t nitems_read() { return gr::thread::atomic_load_acquire(&d_abs_read_offset); }
+
+    /*!
+     * \brief Set the number of items read, for a reader that takes
+     * over from a reader of another buffer. Only while the reader's
+     * block is stopped.
+     */
+    void set_nitems_read(uint64_t nitems);
 
     size_t get_sizeof_item() { return d_buffer->get_sizeof_item(); }
 
@@ -285,6 +356,22 @@ namespace gr {
                            uint64_t abs_end,
 			   long id);
 
+    /*!
+     * \brief Given a [start,end), returns a vector of all tags in the
+     * range with a given key.
+     *
+     * \param v            a vector reference to return tags into
+     * \param abs_start    a uint64 count of the start of the range of interest
+     * \param abs_end      a uint64 count of the end of the range of interest
+     * \param key          a PMT symbol to select only tags of this key
+     * \param id           the unique ID of the block to make sure already deleted tags are not returned
+     */
+    void get_tags_in_range(std::vector<tag_t> &v,
+                           uint64_t abs_start,
+                           uint64_t abs_end,
+                           const pmt::pmt_t &key,
+			   long id);
+
     // -------------------------------------------------------------------------
 
   private:
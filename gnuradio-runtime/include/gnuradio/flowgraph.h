@@ -27,6 +27,7 @@
 #include <gnuradio/basic_block.h>
 #include <gnuradio/io_signature.h>
 #include <iostream>
+#include <map>
 
 namespace gr {
 
@@ -192,15 +193,23 @@ namespace gr {
     std::vector<basic_block_vector_t> partition();
 
   protected:
-    basic_block_vector_t d_blocks;
+    basic_block_vector_t d_blocks;	// sorted; set by validate()
     edge_vector_t d_edges;
     msg_edge_vector_t d_msg_edges;
 
+    // d_edges by the block at their destination and source end, in
+    // the order they are in d_edges; kept up to date by connect(),
+    // disconnect() and clear().
+    typedef std::map<basic_block_sptr, edge_vector_t> edge_index_t;
+    edge_index_t d_in_edges;
+    edge_index_t d_out_edges;
+
     flowgraph();
     std::vector<int> calc_used_ports(basic_block_sptr block, bool check_inputs);
     basic_block_vector_t calc_downstream_blocks(basic_block_sptr block, int port);
     edge_vector_t calc_upstream_edges(basic_block_sptr block);
     bool has_block_p(basic_block_sptr block);
+    bool has_edge_p(const edge &e);
     edge calc_upstream_edge(basic_block_sptr block, int port);
 
   private:
@@ -213,7 +222,7 @@ namespace gr {
 
     basic_block_vector_t calc_downstream_blocks(basic_block_sptr block);
     basic_block_vector_t calc_reachable_blocks(basic_block_sptr block, basic_block_vector_t &blocks);
-    void reachable_dfs_visit(basic_block_sptr block, basic_block_vector_t &blocks);
+    void reachable_dfs_visit(basic_block_sptr block, basic_block_vector_t &reached);
     basic_block_vector_t calc_adjacent_blocks(basic_block_sptr block, basic_block_vector_t &blocks);
     basic_block_vector_t sort_sources_first(basic_block_vector_t &blocks);
     bool source_p(basic_block_sptr block);
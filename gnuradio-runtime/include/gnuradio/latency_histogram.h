@@ -0,0 +1,120 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDED_GR_RUNTIME_LATENCY_HISTOGRAM_H
+#define INCLUDED_GR_RUNTIME_LATENCY_HISTOGRAM_H
+
+#include <gnuradio/api.h>
+#include <gnuradio/high_res_timer.h>
+#include <vector>
+
+namespace gr {
+
+  /*!
+   * \brief Histogram of durations with bounded relative error, in the
+   * style of HdrHistogram.
+   * \ingroup internal
+   *
+   * \details
+   * Values below 2^SUB_BITS ticks are counted exactly. Above that,
+   * each power of two is split into 2^SUB_BITS equal buckets, so a
+   * value is known to within 1/2^SUB_BITS (about 3%) of itself. The
+   * range goes up to 2^MAX_BITS ticks (about 18 minutes of
+   * nanoseconds); anything longer lands in the last bucket.
+   *
+   * Adding a value is a few instructions and touches one counter.
+   * There is one writer, the thread running the block; readers may
+   * see a count that is a value or two behind.
+   */
+  class GR_RUNTIME_API latency_histogram
+  {
+  public:
+    enum {
+      SUB_BITS = 5,
+      MAX_BITS = 40,
+      NBUCKETS = (MAX_BITS - SUB_BITS + 1) << SUB_BITS
+    };
+
+    latency_histogram();
+
+    //! Count one value of \p ticks.
+    void add(high_res_timer_type ticks)
+    {
+      d_counts[bucket(ticks)]++;
+      d_count++;
+      if(ticks > d_max)
+        d_max = ticks;
+    }
+
+    //! Forget all values.
+    void reset();
+
+    //! Number of values counted.
+    unsigned long count() const { return d_count; }
+
+    //! Largest value counted.
+    high_res_timer_type max() const { return d_max; }
+
+    /*!
+     * \brief The value below which a fraction \p p (0 to 1) of the
+     * values fall. Returns 0 if nothing has been counted.
+     */
+    double percentile(double p) const;
+
+    //! p50, p99 and p99.9, in that order.
+    std::vector<float> percentiles() const;
+
+    static int bucket(high_res_timer_type ticks)
+    {
+      if(ticks < (1 << SUB_BITS))
+        return ticks < 0 ? 0 : (int)ticks;
+      int e = msb(ticks);
+      if(e >= MAX_BITS)
+        return NBUCKETS - 1;
+      int shift = e - SUB_BITS;
+      return ((shift + 1) << SUB_BITS) + (int)((ticks >> shift) - (1 << SUB_BITS));
+    }
+
+    //! Smallest value that lands in bucket \p b.
+    static high_res_timer_type bucket_low(int b);
+
+  private:
+    std::vector<unsigned long> d_counts;
+    unsigned long d_count;
+    high_res_timer_type d_max;
+
+    // index of the highest set bit of v > 0
+    static int msb(high_res_timer_type v)
+    {
+#if defined(__GNUC__)
+      return 63 - __builtin_clzll((unsigned long long)v);
+#else
+      int n = 0;
+      while(v >>= 1)
+        n++;
+      return n;
+#endif
+    }
+  };
+
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_RUNTIME_LATENCY_HISTOGRAM_H */
@@ -0,0 +1,172 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDED_GR_MSG_PORT_QUEUE_H
+#define INCLUDED_GR_MSG_PORT_QUEUE_H
+
+#include <gnuradio/api.h>
+#include <gnuradio/thread/thread.h>
+#include <gnuradio/thread/atomic.h>
+#include <pmt/pmt.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace gr {
+
+  class msg_port_queue;
+  typedef boost::shared_ptr<msg_port_queue> msg_port_queue_sptr;
+
+  /*!
+   * \brief Bounded queue of PMT messages for one block input message port.
+   * \ingroup internal
+   *
+   * \details
+   * Any number of threads may post to the queue concurrently; posting
+   * and removing messages don't take a lock while the queue holds
+   * fewer than capacity() messages. What happens when a message is
+   * posted to a full queue is decided by the queue's policy. Under
+   * the default, UNBOUNDED, the queue keeps the extra messages in a
+   * list behind a lock until it has drained; nothing is lost.
+   *
+   * Otherwise locks are only taken when a thread has to sleep: a
+   * sender waiting for room under the BLOCK policy, or a receiver in
+   * delete_head_blocking().
+   */
+  class GR_RUNTIME_API msg_port_queue : boost::noncopyable
+  {
+  public:
+    //! What to do with a message posted to a full queue.
+    enum policy_t {
+      BLOCK = 0,	//!< wait until there is room
+      DROP_OLDEST,	//!< discard the message at the head to make room
+      DROP_NEWEST,	//!< discard the message being posted
+      REJECT,		//!< discard the message being posted and tell the sender
+      UNBOUNDED		//!< keep the message in an overflow list
+    };
+
+    /*!
+     * \brief Make a queue.
+     *
+     * \param capacity maximum number of messages held without
+     *        overflowing; rounded up to a power of 2.
+     * \param policy what to do when the queue is full.
+     * \param pending if not null, incremented for every message
+     *        added and decremented for every message removed. This
+     *        lets the owning block keep one count for all its ports.
+     * \param name used in the warning printed the first time the
+     *        queue discards or refuses a message.
+     */
+    msg_port_queue(size_t capacity, policy_t policy, long *pending=0,
+                   const std::string &name="");
+    ~msg_port_queue();
+
+    /*!
+     * \brief Append \p msg to the queue.
+     *
+     * \returns false if \p msg was not queued because the queue was
+     * full and the policy is REJECT. Messages discarded under the
+     * other policies are counted in ndropped().
+     */
+    bool insert_tail(const pmt::pmt_t &msg);
+
+    /*!
+     * \brief Remove and return the message at the head of the queue.
+     * \returns pmt::pmt_t() if the queue is empty.
+     */
+    pmt::pmt_t delete_head_nowait();
+
+    /*!
+     * \brief Remove and return the message at the head of the queue,
+     * waiting for one to arrive if the queue is empty.
+     */
+    pmt::pmt_t delete_head_blocking();
+
+    //! Is the queue empty?
+    bool empty_p() const { return nmsgs() == 0; }
+
+    //! Number of messages in the queue.
+    size_t nmsgs() const;
+
+    size_t capacity() const { return d_mask + 1; }
+    policy_t policy() const { return d_policy; }
+
+    //! Number of messages discarded by the DROP_OLDEST or DROP_NEWEST policy.
+    long ndropped() const { return gr::thread::atomic_load_acquire(&d_ndropped); }
+
+    //! Number of messages refused by the REJECT policy.
+    long nrejected() const { return gr::thread::atomic_load_acquire(&d_nrejected); }
+
+    /*!
+     * \brief Parse a policy name: "unbounded", "block",
+     * "drop_oldest", "drop_newest" or "reject".
+     * \throws std::invalid_argument for anything else.
+     */
+    static policy_t policy_from_string(const std::string &name);
+
+  private:
+    struct cell {
+      size_t		seq;
+      pmt::pmt_t	msg;
+    };
+
+    std::vector<cell>	d_cells;
+    size_t		d_mask;
+    policy_t		d_policy;
+    long	       *d_pending;
+
+    // Producers and the consumer work on opposite ends; keep them
+    // off each other's cache line.
+    char		d_pad0[64];
+    size_t		d_enqueue_pos;
+    char		d_pad1[64];
+    size_t		d_dequeue_pos;
+    char		d_pad2[64];
+
+    long		d_ndropped;
+    long		d_nrejected;
+    std::string		d_name;
+
+    // Used only by threads that have to sleep.
+    gr::thread::mutex			d_mutex;
+    gr::thread::condition_variable	d_not_empty;
+    gr::thread::condition_variable	d_not_full;
+    long				d_nwaiting_consumers;
+    long				d_nwaiting_producers;
+
+    // UNBOUNDED only: messages posted while the ring was full, or
+    // while earlier ones were still here, so a sender's messages stay
+    // in order. Guarded by d_mutex; d_noverflow is also read without it.
+    std::deque<pmt::pmt_t>		d_overflow;
+    long				d_noverflow;
+
+    bool try_push(const pmt::pmt_t &msg);
+    bool try_pop(pmt::pmt_t &msg);
+    bool pop_overflow(pmt::pmt_t &msg);
+    void count_discard(long *counter);
+    void wake(long *nwaiting, gr::thread::condition_variable &cond);
+  };
+
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_MSG_PORT_QUEUE_H */
@@ -62,6 +62,20 @@ namespace gr {
 
     int fixed_rate_ninput_to_noutput(int ninput);
     int fixed_rate_noutput_to_ninput(int noutput);
+
+    /*!
+     * \brief May the runtime call work() directly, as one stage of a
+     * fused chain of blocks?
+     *
+     * Return true only if work() reads nothing but its input items,
+     * writes nothing but its output items and always returns
+     * noutput_items: no tags, no item counts, nothing else that goes
+     * through the block's detail, which a fused block doesn't have.
+     * Such blocks with one input, one output, no history and no
+     * message ports are fused when the [DEFAULT] block_fusion
+     * preference is on. Defaults to false.
+     */
+    virtual bool fusable() const { return false; }
   };
 
 } /* namespace gr */
@@ -0,0 +1,198 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_THREAD_ATOMIC_H
+#define INCLUDED_THREAD_ATOMIC_H
+
+/*
+ * Minimal set of atomic operations on plain integer and pointer
+ * variables, used where the runtime hands data between threads
+ * without taking a mutex. We can't rely on Boost.Atomic (Boost >=
+ * 1.53) or C++11, so these map onto the compiler intrinsics.
+ */
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace gr {
+  namespace thread {
+
+#if defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+
+    /*! \brief Load \p *p; later reads can't be reordered before it. */
+    template<typename T>
+    inline T atomic_load_acquire(const T *p)
+    {
+      return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+
+    /*! \brief Store \p v in \p *p; earlier writes can't be reordered after it. */
+    template<typename T>
+    inline void atomic_store_release(T *p, T v)
+    {
+      __atomic_store_n(p, v, __ATOMIC_RELEASE);
+    }
+
+    /*! \brief Atomically add \p v to \p *p and return the old value. */
+    template<typename T>
+    inline T atomic_fetch_add(T *p, T v)
+    {
+      return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+    }
+
+    /*!
+     * \brief If \p *p equals \p expected, replace it with \p desired.
+     * \returns true if the swap happened.
+     */
+    template<typename T>
+    inline bool atomic_compare_exchange(T *p, T expected, T desired)
+    {
+      return __atomic_compare_exchange_n(p, &expected, desired, false,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+
+    /*! \brief Reads before the fence can't be reordered after later ones. */
+    inline void atomic_fence_acquire()
+    {
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    }
+
+    /*! \brief Writes after the fence can't be reordered before earlier ones. */
+    inline void atomic_fence_release()
+    {
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+#elif defined(__GNUC__)
+
+    // Older GCC: only the full-barrier __sync builtins are available.
+
+    template<typename T>
+    inline T atomic_load_acquire(const T *p)
+    {
+      T v = *const_cast<const volatile T *>(p);
+      __sync_synchronize();
+      return v;
+    }
+
+    template<typename T>
+    inline void atomic_store_release(T *p, T v)
+    {
+      __sync_synchronize();
+      *const_cast<volatile T *>(p) = v;
+    }
+
+    template<typename T>
+    inline T atomic_fetch_add(T *p, T v)
+    {
+      return __sync_fetch_and_add(p, v);
+    }
+
+    template<typename T>
+    inline bool atomic_compare_exchange(T *p, T expected, T desired)
+    {
+      return __sync_bool_compare_and_swap(p, expected, desired);
+    }
+
+    inline void atomic_fence_acquire()
+    {
+      __sync_synchronize();
+    }
+
+    inline void atomic_fence_release()
+    {
+      __sync_synchronize();
+    }
+
+#elif defined(_MSC_VER)
+
+    // Aligned volatile accesses on x86/x64 have acquire/release
+    // semantics under MSVC; the compiler barrier keeps the optimizer
+    // from moving other accesses across them.
+
+    template<typename T>
+    inline T atomic_load_acquire(const T *p)
+    {
+      T v = *const_cast<const volatile T *>(p);
+      _ReadWriteBarrier();
+      return v;
+    }
+
+    template<typename T>
+    inline void atomic_store_release(T *p, T v)
+    {
+      _ReadWriteBarrier();
+      *const_cast<volatile T *>(p) = v;
+    }
+
+    template<typename T>
+    inline T atomic_fetch_add(T *p, T v)
+    {
+      if(sizeof(T) == sizeof(long))
+        return (T)_InterlockedExchangeAdd((volatile long *)p, (long)v);
+      return (T)_InterlockedExchangeAdd64((volatile __int64 *)p, (__int64)v);
+    }
+
+    template<typename T>
+    inline bool atomic_compare_exchange(T *p, T expected, T desired)
+    {
+      if(sizeof(T) == sizeof(long))
+        return _InterlockedCompareExchange((volatile long *)p, (long)desired,
+                                           (long)expected) == (long)expected;
+      return _InterlockedCompareExchange64((volatile __int64 *)p, (__int64)desired,
+                                           (__int64)expected) == (__int64)expected;
+    }
+
+    inline void atomic_fence_acquire()
+    {
+      _ReadWriteBarrier();
+    }
+
+    inline void atomic_fence_release()
+    {
+      _ReadWriteBarrier();
+    }
+
+#else
+#error "gnuradio/thread/atomic.h: no atomic operations for this compiler"
+#endif
+
+    /*!
+     * \brief Hint to the CPU that we are in a spin-wait loop.
+     */
+    inline void cpu_relax()
+    {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+      __asm__ __volatile__("pause");
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+      _mm_pause();
+#endif
+    }
+
+  } /* namespace thread */
+} /* namespace gr */
+
+#endif /* INCLUDED_THREAD_ATOMIC_H */
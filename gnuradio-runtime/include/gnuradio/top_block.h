@@ -109,6 +109,11 @@ namespace gr {
      * equal number of calls to lock() and unlock() have occurred, the
      * flowgraph will be reconfigured.
      *
+     * With the thread-per-block scheduler only the blocks that were
+     * added, removed or connected differently are stopped and
+     * started again; the rest keep running (see the [DEFAULT]
+     * incremental_reconfig preference).
+     *
      * N.B. lock() and unlock() may not be called from a flowgraph thread
      * (E.g., block::work method) or deadlock will occur when
      * reconfiguration happens.
@@ -138,6 +143,34 @@ namespace gr {
     //! Set the maximum number of noutput_items in the flowgraph
     void set_max_noutput_items(int nmax);
 
+    /*!
+     * \brief Turn automatic thread placement on or off.
+     *
+     * When on, start() pins the thread of every block that has no
+     * processor affinity of its own to one cpu, chosen so that
+     * connected blocks run on cores sharing a last level cache. The
+     * default comes from the [DEFAULT] auto_affinity preference.
+     * Takes effect at the next start() or reconfiguration.
+     */
+    void set_auto_affinity(bool on);
+
+    //! Is automatic thread placement on?
+    bool auto_affinity();
+
+    /*!
+     * \brief Keep \p cores out of automatic thread placement.
+     *
+     * Use this to give I/O blocks cores of their own: reserve the
+     * cores here and pin the I/O blocks to them with
+     * block::set_processor_affinity. Replaces any earlier
+     * reservation; the default comes from the [DEFAULT]
+     * reserved_cores preference.
+     */
+    void reserve_cores(const std::vector<int> &cores);
+
+    //! The cores kept out of automatic thread placement.
+    std::vector<int> reserved_cores();
+
     top_block_sptr to_top_block(); // Needed for Python type coercion
 
     void setup_rpc();
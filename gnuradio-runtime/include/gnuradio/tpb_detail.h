@@ -24,6 +24,8 @@
 
 #include <gnuradio/api.h>
 #include <gnuradio/thread/thread.h>
+#include <gnuradio/thread/atomic.h>
+#include <boost/function.hpp>
 #include <deque>
 #include <pmt/pmt.h>
 
@@ -41,6 +43,12 @@ namespace gr {
     bool				output_changed;
     gr::thread::condition_variable	output_cond;
 
+    //! Set by schedulers that don't give each block its own thread
+    //! (e.g., scheduler_pool), through set_ready_callback. Called
+    //! with \p mutex held whenever our input, output or message
+    //! queue may have changed.
+    boost::function<void()>		ready_callback;
+
   public:
     tpb_detail()
       : input_changed(false), output_changed(false) { }
@@ -58,33 +66,63 @@ namespace gr {
 
     //! Called by pmt msg posters
     void notify_msg() {
+      // Take the mutex so we can't slip in between the block's
+      // check of its queues and its wait.
+      gr::thread::scoped_lock guard(mutex);
       input_cond.notify_one();
       output_cond.notify_one();
+      if(ready_callback)
+        ready_callback();
+    }
+
+    //! Called by schedulers that set ready_callback, to poke us
+    void notify_ready()
+    {
+      gr::thread::scoped_lock guard(mutex);
+      if(ready_callback)
+        ready_callback();
+    }
+
+    //! Set ready_callback, or clear it with an empty function. Once
+    //! this returns, the old callback is neither running nor called
+    //! again, so its target may go away.
+    void set_ready_callback(const boost::function<void()> &f)
+    {
+      gr::thread::scoped_lock guard(mutex);
+      ready_callback = f;
     }
 
     //! Called by us
     void clear_changed()
     {
       gr::thread::scoped_lock guard(mutex);
-      input_changed = false;
-      output_changed = false;
+      gr::thread::atomic_store_release(&input_changed, false);
+      gr::thread::atomic_store_release(&output_changed, false);
     }
 
+    //! Called by us to poll for changes without taking the mutex
+    bool input_changed_p() const { return gr::thread::atomic_load_acquire(&input_changed); }
+    bool output_changed_p() const { return gr::thread::atomic_load_acquire(&output_changed); }
+
   private:
     //! Used by notify_downstream
     void set_input_changed()
     {
       gr::thread::scoped_lock guard(mutex);
-      input_changed = true;
+      gr::thread::atomic_store_release(&input_changed, true);
       input_cond.notify_one();
+      if(ready_callback)
+        ready_callback();
     }
 
     //! Used by notify_upstream
     void set_output_changed()
     {
       gr::thread::scoped_lock guard(mutex);
-      output_changed = true;
+      gr::thread::atomic_store_release(&output_changed, true);
       output_cond.notify_one();
+      if(ready_callback)
+        ready_callback();
     }
   };
 
@@ -0,0 +1,100 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDED_GR_RUNTIME_TRACER_H
+#define INCLUDED_GR_RUNTIME_TRACER_H
+
+#include <gnuradio/api.h>
+#include <string>
+
+namespace gr {
+
+  /*!
+   * \brief Records what the schedulers do, for viewing on a timeline.
+   * \ingroup misc
+   *
+   * \details
+   * When tracing is on, the schedulers record every call to
+   * general_work (with noutput_items and the result), every time a
+   * block is blocked on input or output, every message dispatch and
+   * when a block is done. Each thread writes into a ring buffer of
+   * its own without taking locks; once a ring is full the oldest
+   * events are overwritten.
+   *
+   * dump_chrome_json() writes the events in the Chrome trace event
+   * format, which chrome://tracing and the Perfetto UI
+   * (ui.perfetto.dev) both open. It may be called while the
+   * flowgraph is running.
+   *
+   * Tracing starts off unless [Tracer] on is set in the preferences;
+   * [Tracer] ring_size sets the number of events kept per thread.
+   */
+  class GR_RUNTIME_API tracer
+  {
+  public:
+    enum event_t {
+      WORK_BEGIN = 0,	//!< arg is noutput_items
+      WORK_END,		//!< arg is what general_work returned
+      BLKD_IN,		//!< blocked waiting for input
+      BLKD_OUT,		//!< blocked waiting for output space
+      MSG_BEGIN,	//!< about to dispatch a message
+      MSG_END,		//!< message handler returned
+      DONE		//!< block is done
+    };
+
+    //! Turn tracing on or off.
+    static void enable(bool on);
+
+    //! Is tracing on?
+    static bool enabled() { return s_enabled; }
+
+    /*!
+     * \brief Record \p ev for block \p block_id (basic_block::unique_id)
+     * on the calling thread. Does nothing unless tracing is on.
+     */
+    static void trace(event_t ev, long block_id, long arg=0)
+    {
+      if(s_enabled)
+        record(ev, block_id, arg);
+    }
+
+    //! Name shown for block \p block_id in dumps.
+    static void register_block(long block_id, const std::string &name);
+
+    /*!
+     * \brief Write all recorded events to \p filename as a Chrome
+     * trace event JSON file.
+     * \throws std::runtime_error if the file can't be written.
+     */
+    static void dump_chrome_json(const std::string &filename);
+
+    //! Throw away all recorded events.
+    static void clear();
+
+  private:
+    static bool s_enabled;
+
+    static void record(event_t ev, long block_id, long arg);
+  };
+
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_RUNTIME_TRACER_H */
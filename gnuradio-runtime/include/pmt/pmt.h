@@ -539,6 +539,61 @@ PMT_API double   *f64vector_writable_elements(pmt_t v, size_t &len); //< len is
 PMT_API std::complex<float>  *c32vector_writable_elements(pmt_t v, size_t &len); //< len is in elements
 PMT_API std::complex<double> *c64vector_writable_elements(pmt_t v, size_t &len); //< len is in elements
 
+/*
+ * ------------------------------------------------------------------------
+ *		   Memory shared by uniform vectors
+ *
+ * A uniform vector normally owns its elements. The *_view functions
+ * instead make a uniform vector that uses memory in an aligned,
+ * reference counted memory block, starting \p offset bytes in. Any
+ * number of vectors can share one block, and it is freed when the
+ * last of them goes away. Large payloads can then be passed around
+ * and sliced without being copied.
+ *
+ * Since the memory is shared, writing through one view is seen by
+ * all the others.
+ * ------------------------------------------------------------------------
+ */
+
+class memory_block;
+typedef boost::intrusive_ptr<memory_block> memory_block_t;
+
+extern PMT_API void intrusive_ptr_add_ref(memory_block*);
+extern PMT_API void intrusive_ptr_release(memory_block*);
+
+//! Allocate \p nbytes of memory, aligned to \p alignment bytes (a power of 2)
+PMT_API memory_block_t make_memory_block(size_t nbytes, size_t alignment = 64);
+
+//! Return a pointer to the start of the memory in \p mem
+PMT_API void *memory_block_data(memory_block_t mem);
+
+//! Return the size of \p mem in bytes
+PMT_API size_t memory_block_size(memory_block_t mem);
+
+/*!
+ * \brief Return a vector of \p k items that uses the memory of \p mem
+ * starting \p offset bytes in, which must be a multiple of the item
+ * size. Throws out_of_range otherwise, or if the items don't fit.
+ */
+PMT_API pmt_t make_u8vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_s8vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_u16vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_s16vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_u32vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_s32vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_u64vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_s64vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_f32vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_f64vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_c32vector_view(memory_block_t mem, size_t offset, size_t k);
+PMT_API pmt_t make_c64vector_view(memory_block_t mem, size_t offset, size_t k);
+
+/*!
+ * \brief Return a uniform vector of the same type as \p v holding
+ * its elements [\p start, \p start + \p k), without copying them.
+ */
+PMT_API pmt_t uniform_vector_slice(pmt_t v, size_t start, size_t k);
+
 /*
  * ------------------------------------------------------------------------
  *	   Dictionary (a.k.a associative array, hash, map)
@@ -567,7 +622,7 @@ PMT_API bool  dict_has_key(const pmt_t &dict, const pmt_t &key);
 //! If \p key exists in \p dict, return associated value; otherwise return \p not_found.
 PMT_API pmt_t dict_ref(const pmt_t &dict, const pmt_t &key, const pmt_t &not_found);
 
-//! Return list of (key . value) pairs
+//! Return list of (key . value) pairs, most recently added key first
 PMT_API pmt_t dict_items(pmt_t dict);
 
 //! Return list of keys
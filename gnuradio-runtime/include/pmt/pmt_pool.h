@@ -31,8 +31,11 @@ namespace pmt {
 /*!
  * \brief very simple thread-safe fixed-size allocation pool
  *
- * FIXME may want to go to global allocation with per-thread free list.
- * This would eliminate virtually all lock contention.
+ * Each thread keeps a small cache ("magazine") of free items in front
+ * of the shared free list, so most malloc/free pairs don't touch the
+ * pool mutex at all. Items move between a thread's cache and the
+ * shared free list in batches. Pools with a \p max_items limit
+ * bypass the caches so the limit stays exact.
  */
 class PMT_API pmt_pool {
 
@@ -40,6 +43,14 @@ class PMT_API pmt_pool {
     struct item	*d_next;
   };
 
+  struct magazine {
+    pmt_pool   *d_pool;         // 0 once the pool is gone
+    unsigned long d_generation; // that of the pool it was made for
+    item       *d_items;
+    size_t      d_n_items;
+    size_t      d_hits;         // not yet folded into the pool's count
+  };
+
   typedef boost::unique_lock<boost::mutex>  scoped_lock;
   mutable boost::mutex 		d_mutex;
   boost::condition_variable	d_cond;
@@ -51,6 +62,22 @@ class PMT_API pmt_pool {
   size_t	      d_n_items;
   item	       	     *d_freelist;
   std::vector<char *> d_allocations;
+  size_t	      d_hits;
+  size_t	      d_misses;
+
+  // Tells this pool apart from an earlier one at the same address,
+  // whose caches the thread_specific_ptr would hand out again.
+  unsigned long	      d_generation;
+
+  boost::thread_specific_ptr<magazine> d_cache;
+  std::vector<magazine *> d_magazines; // every thread's cache
+
+  item *grab(size_t n, size_t &ngot);
+  void release(item *head, item *tail, size_t n, size_t hits);
+  magazine *cache();
+  void refill(magazine *m);
+  void flush(magazine *m, size_t keep);
+  static void cleanup(magazine *m);
 
 public:
   /*!
@@ -66,8 +93,24 @@ public:
 
   void *malloc();
   void free(void *p);
+
+  /*!
+   * \brief Allocation counters, for tuning.
+   *
+   * \p nhits counts allocations served from a thread's cache and
+   * \p nmisses those that had to go to the shared free list. Hits
+   * are folded in from a thread's cache whenever it refills or
+   * flushes, so they may lag a little behind.
+   */
+  void counts(size_t &nhits, size_t &nmisses) const;
 };
 
+/*!
+ * \brief Allocation counters summed over the pools that PMT objects
+ * are allocated from. See pmt_pool::counts.
+ */
+PMT_API void object_pool_counts(size_t &nhits, size_t &nmisses);
+
 } /* namespace pmt */
 
 #endif /* INCLUDED_PMT_POOL_H */
@@ -26,6 +26,7 @@
 
 #include <gnuradio/basic_block.h>
 #include <gnuradio/block_registry.h>
+#include <gnuradio/prefs.h>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
@@ -44,7 +45,8 @@ namespace gr {
   basic_block::basic_block(const std::string &name,
                            io_signature::sptr input_signature,
                            io_signature::sptr output_signature)
-    : d_name(name),
+    : d_msgs_pending(0),
+      d_name(name),
       d_input_signature(input_signature),
       d_output_signature(output_signature),
       d_unique_id(s_next_id++),
@@ -80,12 +82,23 @@ namespace gr {
   //  - register a new input message port
   void
   basic_block::message_port_register_in(pmt::pmt_t port_id)
+  {
+    prefs *p = prefs::singleton();
+    size_t capacity = static_cast<size_t>(p->get_long("DEFAULT", "msg_queue_capacity", 2048));
+    msg_port_queue::policy_t policy =
+      msg_port_queue::policy_from_string(p->get_string("DEFAULT", "msg_queue_policy", "unbounded"));
+    message_port_register_in(port_id, capacity, policy);
+  }
+
+  void
+  basic_block::message_port_register_in(pmt::pmt_t port_id, size_t capacity,
+                                        msg_port_queue::policy_t policy)
   {
     if(!pmt::is_symbol(port_id)) {
       throw std::runtime_error("message_port_register_in: bad port id");
     }
-    msg_queue[port_id] = msg_queue_t();
-    msg_queue_ready[port_id] = boost::shared_ptr<boost::condition_variable>(new boost::condition_variable());
+    std::string name = alias() + ":" + pmt::symbol_to_string(port_id);
+    msg_queue[port_id] = msg_port_queue_sptr(new msg_port_queue(capacity, policy, &d_msgs_pending, name));
   }
 
   pmt::pmt_t
@@ -184,50 +197,42 @@ namespace gr {
     insert_tail(which_port, msg);
   }
 
-  void
-  basic_block::insert_tail(pmt::pmt_t which_port, pmt::pmt_t msg)
+  msg_port_queue *
+  basic_block::port_queue(pmt::pmt_t which_port)
   {
-    gr::thread::scoped_lock guard(mutex);
+    msg_queue_map_itr i = msg_queue.find(which_port);
+    if(i == msg_queue.end())
+      throw std::runtime_error("port does not exist!");
+    return i->second.get();
+  }
 
-    if((msg_queue.find(which_port) == msg_queue.end()) || (msg_queue_ready.find(which_port) == msg_queue_ready.end())) {
+  bool
+  basic_block::insert_tail(pmt::pmt_t which_port, pmt::pmt_t msg)
+  {
+    msg_queue_map_itr i = msg_queue.find(which_port);
+    if(i == msg_queue.end()) {
       std::cout << "target port = " << pmt::symbol_to_string(which_port) << std::endl;
       throw std::runtime_error("attempted to insert_tail on invalid queue!");
     }
 
-    msg_queue[which_port].push_back(msg);
-    msg_queue_ready[which_port]->notify_one();
+    if(!i->second->insert_tail(msg))
+      return false;
 
     // wake up thread if BLKD_IN or BLKD_OUT
     global_block_registry.notify_blk(alias());
+    return true;
   }
 
   pmt::pmt_t
   basic_block::delete_head_nowait(pmt::pmt_t which_port)
   {
-    gr::thread::scoped_lock guard(mutex);
-
-    if(empty_p(which_port)) {
-      return pmt::pmt_t();
-    }
-
-    pmt::pmt_t m(msg_queue[which_port].front());
-    msg_queue[which_port].pop_front();
-
-    return m;
+    return port_queue(which_port)->delete_head_nowait();
   }
 
   pmt::pmt_t
   basic_block::delete_head_blocking(pmt::pmt_t which_port)
   {
-    gr::thread::scoped_lock guard(mutex);
-
-    while(empty_p(which_port)) {
-      msg_queue_ready[which_port]->wait(guard);
-    }
-
-    pmt::pmt_t m(msg_queue[which_port].front());
-    msg_queue[which_port].pop_front();
-    return m;
+    return port_queue(which_port)->delete_head_blocking();
   }
 
 } /* namespace gr */
@@ -48,6 +48,9 @@ namespace gr {
       d_max_noutput_items(0),
       d_min_noutput_items(0),
       d_tag_propagation_policy(TPP_ALL_TO_ALL),
+      d_wait_policy(WP_DEFAULT),
+      d_cluster(-1),
+      d_latency_probe(false),
       d_priority(-1),
       d_pc_rpc_set(false),
       d_max_output_buffer(std::max(output_signature->max_streams(),1), -1),
@@ -646,6 +649,127 @@ namespace gr {
     }
   }
 
+  float
+  block::pc_work_time_percentile(float p)
+  {
+    if(d_detail) {
+      return d_detail->pc_work_time_hist().percentile(p);
+    }
+    else {
+      return 0;
+    }
+  }
+
+  std::vector<float>
+  block::pc_work_time_percentiles()
+  {
+    if(d_detail) {
+      return d_detail->pc_work_time_hist().percentiles();
+    }
+    else {
+      return std::vector<float>(3, 0);
+    }
+  }
+
+  float
+  block::pc_input_latency_percentile(float p)
+  {
+    if(d_detail) {
+      return d_detail->pc_input_latency_hist().percentile(p);
+    }
+    else {
+      return 0;
+    }
+  }
+
+  std::vector<float>
+  block::pc_input_latency_percentiles()
+  {
+    if(d_detail) {
+      return d_detail->pc_input_latency_hist().percentiles();
+    }
+    else {
+      return std::vector<float>(3, 0);
+    }
+  }
+
+  float
+  block::pc_blocked_input_percentile(float p)
+  {
+    if(d_detail) {
+      return d_detail->pc_blocked_input_hist().percentile(p);
+    }
+    else {
+      return 0;
+    }
+  }
+
+  std::vector<float>
+  block::pc_blocked_input_percentiles()
+  {
+    if(d_detail) {
+      return d_detail->pc_blocked_input_hist().percentiles();
+    }
+    else {
+      return std::vector<float>(3, 0);
+    }
+  }
+
+  float
+  block::pc_blocked_output_percentile(float p)
+  {
+    if(d_detail) {
+      return d_detail->pc_blocked_output_hist().percentile(p);
+    }
+    else {
+      return 0;
+    }
+  }
+
+  std::vector<float>
+  block::pc_blocked_output_percentiles()
+  {
+    if(d_detail) {
+      return d_detail->pc_blocked_output_hist().percentiles();
+    }
+    else {
+      return std::vector<float>(3, 0);
+    }
+  }
+
+  std::vector<int>
+  block::pc_path_latency_sources()
+  {
+    if(d_detail) {
+      return d_detail->pc_path_latency_sources();
+    }
+    else {
+      return std::vector<int>();
+    }
+  }
+
+  float
+  block::pc_path_latency_percentile(long source_id, float p)
+  {
+    if(d_detail) {
+      return d_detail->pc_path_latency_percentile(source_id, p);
+    }
+    else {
+      return 0;
+    }
+  }
+
+  std::vector<float>
+  block::pc_path_latency_percentiles()
+  {
+    if(d_detail) {
+      return d_detail->pc_path_latency_percentiles();
+    }
+    else {
+      return std::vector<float>();
+    }
+  }
+
   void
   block::reset_perf_counters()
   {
@@ -770,6 +894,48 @@ namespace gr {
         pmt::make_c32vector(0,0), pmt::make_c32vector(0,1), pmt::make_c32vector(0,0),
         "", "Var. of how full output buffers are", RPC_PRIVLVL_MIN,
         DISPTIME | DISPOPTSTRIP)));
+
+    d_rpc_vars.push_back(
+      rpcbasic_sptr(new rpcbasic_register_get<block, std::vector<float> >(
+        alias(), "work time percentiles", &block::pc_work_time_percentiles,
+        pmt::make_c32vector(0,0), pmt::make_c32vector(0,1e9), pmt::make_c32vector(0,0),
+        "", "p50, p99 and p99.9 of clock cycles in call to work", RPC_PRIVLVL_MIN,
+        DISPTIME | DISPOPTSTRIP)));
+
+    d_rpc_vars.push_back(
+      rpcbasic_sptr(new rpcbasic_register_get<block, std::vector<float> >(
+        alias(), "input latency percentiles", &block::pc_input_latency_percentiles,
+        pmt::make_c32vector(0,0), pmt::make_c32vector(0,1e9), pmt::make_c32vector(0,0),
+        "", "p50, p99 and p99.9 of time from produce to consume", RPC_PRIVLVL_MIN,
+        DISPTIME | DISPOPTSTRIP)));
+
+    d_rpc_vars.push_back(
+      rpcbasic_sptr(new rpcbasic_register_get<block, std::vector<float> >(
+        alias(), "blocked input percentiles", &block::pc_blocked_input_percentiles,
+        pmt::make_c32vector(0,0), pmt::make_c32vector(0,1e9), pmt::make_c32vector(0,0),
+        "", "p50, p99 and p99.9 of time waiting for input", RPC_PRIVLVL_MIN,
+        DISPTIME | DISPOPTSTRIP)));
+
+    d_rpc_vars.push_back(
+      rpcbasic_sptr(new rpcbasic_register_get<block, std::vector<float> >(
+        alias(), "blocked output percentiles", &block::pc_blocked_output_percentiles,
+        pmt::make_c32vector(0,0), pmt::make_c32vector(0,1e9), pmt::make_c32vector(0,0),
+        "", "p50, p99 and p99.9 of time waiting for output space", RPC_PRIVLVL_MIN,
+        DISPTIME | DISPOPTSTRIP)));
+
+    d_rpc_vars.push_back(
+      rpcbasic_sptr(new rpcbasic_register_get<block, std::vector<int> >(
+        alias(), "path latency sources", &block::pc_path_latency_sources,
+        pmt::make_s32vector(0,0), pmt::make_s32vector(0,0), pmt::make_s32vector(0,0),
+        "", "unique_id of every source whose latency probes got here",
+        RPC_PRIVLVL_MIN, DISPNULL)));
+
+    d_rpc_vars.push_back(
+      rpcbasic_sptr(new rpcbasic_register_get<block, std::vector<float> >(
+        alias(), "path latency percentiles", &block::pc_path_latency_percentiles,
+        pmt::make_c32vector(0,0), pmt::make_c32vector(0,1e9), pmt::make_c32vector(0,0),
+        "", "p50, p99 and p99.9 of latency probe travel time, per path latency source",
+        RPC_PRIVLVL_MIN, DISPTIME | DISPOPTSTRIP)));
 #endif /* GR_CTRLPORT */
   }
 
@@ -58,7 +58,10 @@ namespace gr {
       d_ins_work_time(0),
       d_avg_work_time(0),
       d_var_work_time(0),
-      d_pc_counter(0)
+      d_pc_counter(0),
+      d_pc_start_nitems_read(ninputs, 0),
+      d_blocked_since(0),
+      d_blocked_on_input(false)
   {
     s_ncurrently_allocated++;
   }
@@ -201,22 +204,8 @@ namespace gr {
                                   const pmt::pmt_t &key,
 				  long id)
   {
-    std::vector<tag_t> found_items;
-
-    v.resize(0);
-
-    // get from gr_buffer_reader's deque of tags
-    d_input[which_input]->get_tags_in_range(found_items, abs_start, abs_end, id);
-
-    // Filter further by key name
-    pmt::pmt_t itemkey;
-    std::vector<tag_t>::iterator itr;
-    for(itr = found_items.begin(); itr != found_items.end(); itr++) {
-      itemkey = (*itr).key;
-      if(pmt::eqv(key, itemkey)) {
-        v.push_back(*itr);
-      }
-    }
+    // get from gr_buffer_reader's tags, filtered by key name
+    d_input[which_input]->get_tags_in_range(v, abs_start, abs_end, key, id);
   }
 
   void
@@ -259,14 +248,52 @@ namespace gr {
   void
   block_detail::start_perf_counters()
   {
+    // Back from being blocked: the perfmon clock may be counting cpu
+    // time, so the wait is measured on the wall clock.
+    if(d_blocked_since != 0) {
+      gr::high_res_timer_type waited = gr::high_res_timer_now() - d_blocked_since;
+      if(d_blocked_on_input)
+        d_blocked_input_hist.add(waited);
+      else
+        d_blocked_output_hist.add(waited);
+      d_blocked_since = 0;
+    }
+
+    for(size_t i = 0; i < d_input.size(); i++)
+      d_pc_start_nitems_read[i] = d_input[i]->nitems_read();
+
     d_start_of_work = gr::high_res_timer_now_perfmon();
   }
 
+  void
+  block_detail::blocked_perf_counters(bool input)
+  {
+    // Count from the first time we found ourselves blocked.
+    if(d_blocked_since == 0 || d_blocked_on_input != input) {
+      d_blocked_since = gr::high_res_timer_now();
+      d_blocked_on_input = input;
+    }
+  }
+
   void
   block_detail::stop_perf_counters(int noutput_items, int nproduced)
   {
     d_end_of_work = gr::high_res_timer_now_perfmon();
     gr::high_res_timer_type diff = d_end_of_work - d_start_of_work;
+    d_work_time_hist.add(diff);
+
+    // How long the oldest item we consumed on each input sat in the
+    // buffer.
+    gr::high_res_timer_type now = 0;
+    for(size_t i = 0; i < d_input.size(); i++) {
+      gr::high_res_timer_type written;
+      if(d_input[i]->nitems_read() > d_pc_start_nitems_read[i]
+         && d_input[i]->buffer()->write_time(d_pc_start_nitems_read[i], written)) {
+        if(now == 0)
+          now = gr::high_res_timer_now();
+        d_input_latency_hist.add(now - written);
+      }
+    }
 
     if(d_pc_counter == 0) {
       d_ins_work_time = diff;
@@ -280,7 +307,6 @@ namespace gr {
       d_avg_noutput_items = noutput_items;
       d_var_noutput_items = 0;
       for(size_t i=0; i < d_input.size(); i++) {
-	gr::thread::scoped_lock guard(*d_input[i]->mutex());
         float pfull = static_cast<float>(d_input[i]->items_available()) /
           static_cast<float>(d_input[i]->max_possible_items_available());
         d_ins_input_buffers_full[i] = pfull;
@@ -288,7 +314,6 @@ namespace gr {
         d_var_input_buffers_full[i] = 0;
       }
       for(size_t i=0; i < d_output.size(); i++) {
-	gr::thread::scoped_lock guard(*d_output[i]->mutex());
         float pfull = 1.0f - static_cast<float>(d_output[i]->space_available()) /
           static_cast<float>(d_output[i]->bufsize());
         d_ins_output_buffers_full[i] = pfull;
@@ -314,7 +339,6 @@ namespace gr {
       d_var_noutput_items = d_var_noutput_items + d*d;
 
       for(size_t i=0; i < d_input.size(); i++) {
-	gr::thread::scoped_lock guard(*d_input[i]->mutex());
         float pfull = static_cast<float>(d_input[i]->items_available()) /
           static_cast<float>(d_input[i]->max_possible_items_available());
       
@@ -325,7 +349,6 @@ namespace gr {
       }
 
       for(size_t i=0; i < d_output.size(); i++) {
-	gr::thread::scoped_lock guard(*d_output[i]->mutex());
         float pfull = 1.0f - static_cast<float>(d_output[i]->space_available()) /
           static_cast<float>(d_output[i]->bufsize());
 
@@ -343,6 +366,55 @@ namespace gr {
   block_detail::reset_perf_counters()
   {
     d_pc_counter = 0;
+    d_work_time_hist.reset();
+    d_input_latency_hist.reset();
+    d_blocked_input_hist.reset();
+    d_blocked_output_hist.reset();
+
+    gr::thread::scoped_lock guard(d_path_latency_mutex);
+    d_path_latency_hist.clear();
+    d_path_latency_sources.clear();
+  }
+
+  void
+  block_detail::add_path_latency(long source_id, gr::high_res_timer_type ticks)
+  {
+    gr::thread::scoped_lock guard(d_path_latency_mutex);
+    std::map<long, latency_histogram>::iterator i = d_path_latency_hist.find(source_id);
+    if(i == d_path_latency_hist.end()) {
+      i = d_path_latency_hist.insert(std::make_pair(source_id, latency_histogram())).first;
+      d_path_latency_sources.push_back(static_cast<int>(source_id));
+    }
+    i->second.add(ticks);
+  }
+
+  std::vector<int>
+  block_detail::pc_path_latency_sources()
+  {
+    gr::thread::scoped_lock guard(d_path_latency_mutex);
+    return d_path_latency_sources;
+  }
+
+  float
+  block_detail::pc_path_latency_percentile(long source_id, float p)
+  {
+    gr::thread::scoped_lock guard(d_path_latency_mutex);
+    std::map<long, latency_histogram>::const_iterator i = d_path_latency_hist.find(source_id);
+    if(i == d_path_latency_hist.end())
+      return 0;
+    return i->second.percentile(p);
+  }
+
+  std::vector<float>
+  block_detail::pc_path_latency_percentiles()
+  {
+    gr::thread::scoped_lock guard(d_path_latency_mutex);
+    std::vector<float> r;
+    for(size_t i = 0; i < d_path_latency_sources.size(); i++) {
+      std::vector<float> p = d_path_latency_hist[d_path_latency_sources[i]].percentiles();
+      r.insert(r.end(), p.begin(), p.end());
+    }
+    return r;
   }
 
   float
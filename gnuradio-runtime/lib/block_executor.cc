@@ -29,6 +29,8 @@
 #include <gnuradio/block_detail.h>
 #include <gnuradio/buffer.h>
 #include <gnuradio/prefs.h>
+#include <gnuradio/tracer.h>
+#include <gnuradio/thread/atomic.h>
 #include <boost/thread.hpp>
 #include <boost/format.hpp>
 #include <iostream>
@@ -73,7 +75,6 @@ namespace gr {
     if(min_noutput_items == 0)
       min_noutput_items = 1;
     for(int i = 0; i < d->noutputs (); i++) {
-      gr::thread::scoped_lock guard(*d->output(i)->mutex());
       int avail_n = round_down(d->output(i)->space_available(), output_multiple);
       int best_n = round_down(d->output(i)->bufsize()/2, output_multiple);
       if(best_n < min_noutput_items)
@@ -90,10 +91,25 @@ namespace gr {
     return min_space;
   }
 
+  /*
+   * Scale the offsets of tags by the block's relative rate so they
+   * line up with the output stream.
+   */
+  static void
+  rescale_tags(std::vector<tag_t>::iterator begin,
+               std::vector<tag_t>::iterator end, double rrate)
+  {
+    if(rrate == 1.0)
+      return;
+    for(; begin != end; begin++)
+      begin->offset *= rrate;
+  }
+
   static bool
   propagate_tags(block::tag_propagation_policy_t policy, block_detail *d,
                  const std::vector<uint64_t> &start_nitems_read, double rrate,
-                 std::vector<tag_t> &rtags, long block_id)
+                 std::vector<tag_t> &rtags, std::vector<tag_t> &ptags,
+                 long block_id)
   {
     // Move tags downstream
     // if a sink, we don't need to move downstream
@@ -106,25 +122,28 @@ namespace gr {
       return true;
       break;
     case block::TPP_ALL_TO_ALL:
-      // every tag on every input propogates to everyone downstream
-      for(int i = 0; i < d->ninputs(); i++) {
-        d->get_tags_in_range(rtags, i, start_nitems_read[i],
-                             d->nitems_read(i), block_id);
-
-        std::vector<tag_t>::iterator t;
-        if(rrate == 1.0) {
-          for(t = rtags.begin(); t != rtags.end(); t++) {
-            for(int o = 0; o < d->noutputs(); o++)
-              d->output(o)->add_item_tag(*t);
-          }
+      // every tag on every input propogates to everyone downstream.
+      // Collect them all first so each output buffer is locked once.
+      if(d->ninputs() == 1) {
+        d->get_tags_in_range(rtags, 0, start_nitems_read[0],
+                             d->nitems_read(0), block_id);
+        rescale_tags(rtags.begin(), rtags.end(), rrate);
+        if(!rtags.empty()) {
+          for(int o = 0; o < d->noutputs(); o++)
+            d->output(o)->add_item_tags(rtags.begin(), rtags.end());
         }
-        else {
-          for(t = rtags.begin(); t != rtags.end(); t++) {
-            tag_t new_tag = *t;
-            new_tag.offset *= rrate;
-            for(int o = 0; o < d->noutputs(); o++)
-              d->output(o)->add_item_tag(new_tag);
-          }
+      }
+      else {
+        ptags.resize(0);
+        for(int i = 0; i < d->ninputs(); i++) {
+          d->get_tags_in_range(rtags, i, start_nitems_read[i],
+                               d->nitems_read(i), block_id);
+          ptags.insert(ptags.end(), rtags.begin(), rtags.end());
+        }
+        rescale_tags(ptags.begin(), ptags.end(), rrate);
+        if(!ptags.empty()) {
+          for(int o = 0; o < d->noutputs(); o++)
+            d->output(o)->add_item_tags(ptags.begin(), ptags.end());
         }
       }
       break;
@@ -136,13 +155,8 @@ namespace gr {
         for(int i = 0; i < d->ninputs(); i++) {
           d->get_tags_in_range(rtags, i, start_nitems_read[i],
                                d->nitems_read(i), block_id);
-
-          std::vector<tag_t>::iterator t;
-          for(t = rtags.begin(); t != rtags.end(); t++) {
-            tag_t new_tag = *t;
-            new_tag.offset *= rrate;
-            d->output(i)->add_item_tag(new_tag);
-          }
+          rescale_tags(rtags.begin(), rtags.end(), rrate);
+          d->output(i)->add_item_tags(rtags.begin(), rtags.end());
         }
       }
       else  {
@@ -171,8 +185,14 @@ namespace gr {
 #ifdef GR_PERFORMANCE_COUNTERS
     prefs *prefs = prefs::singleton();
     d_use_pc = prefs->get_bool("PerfCounters", "on", false);
+    d_probe_all = prefs->get_bool("PerfCounters", "latency_probe", false);
+    d_probe_period = prefs->get_long("PerfCounters", "latency_probe_period", 10)
+      * high_res_timer_tps() / 1000;
+    d_last_probe = 0;
 #endif /* GR_PERFORMANCE_COUNTERS */
 
+    tracer::register_block(d_block->unique_id(), d_block->alias());
+
     d_block->start();			// enable any drivers, etc.
   }
 
@@ -184,6 +204,68 @@ namespace gr {
     d_block->stop();			// stop any drivers, etc.
   }
 
+  block_executor::state
+  block_executor::blocked(block *m, block_detail *d, state s)
+  {
+    tracer::trace(s == BLKD_IN ? tracer::BLKD_IN : tracer::BLKD_OUT, m->unique_id());
+
+#ifdef GR_PERFORMANCE_COUNTERS
+    if(d_use_pc)
+      d->blocked_perf_counters(s == BLKD_IN);
+#else
+    (void) d;
+#endif /* GR_PERFORMANCE_COUNTERS */
+
+    return s;
+  }
+
+#ifdef GR_PERFORMANCE_COUNTERS
+  // Set once any source has stamped a probe, so that sinks don't go
+  // looking for probes in flowgraphs that have none.
+  static bool s_latency_probes_stamped = false;
+
+  static const pmt::pmt_t s_latency_probe_key = pmt::intern("gr_latency_probe");
+
+  void
+  block_executor::stamp_latency_probe(block *m, block_detail *d)
+  {
+    high_res_timer_type now = high_res_timer_now();
+    if(now - d_last_probe < d_probe_period)
+      return;
+    d_last_probe = now;
+
+    tag_t t;
+    t.key = s_latency_probe_key;
+    t.value = pmt::cons(pmt::from_long(m->unique_id()), pmt::from_uint64(now));
+    t.srcid = m->alias_pmt();
+    for(int i = 0; i < d->noutputs(); i++) {
+      t.offset = d->nitems_written(i);
+      d->add_item_tag(i, t);
+    }
+    if(!gr::thread::atomic_load_acquire(&s_latency_probes_stamped))
+      gr::thread::atomic_store_release(&s_latency_probes_stamped, true);
+  }
+
+  void
+  block_executor::collect_latency_probes(block_detail *d)
+  {
+    high_res_timer_type now = 0;
+    for(int i = 0; i < d->ninputs(); i++) {
+      d->get_tags_in_range(d_probe_tags, i, d_start_nitems_read[i], d->nitems_read(i),
+                           s_latency_probe_key, d_block->unique_id());
+      for(size_t j = 0; j < d_probe_tags.size(); j++) {
+        const pmt::pmt_t &v = d_probe_tags[j].value;
+        if(!pmt::is_pair(v))
+          continue;
+        if(now == 0)
+          now = high_res_timer_now();
+        d->add_path_latency(pmt::to_long(pmt::car(v)),
+                            now - (high_res_timer_type)pmt::to_uint64(pmt::cdr(v)));
+      }
+    }
+  }
+#endif /* GR_PERFORMANCE_COUNTERS */
+
   block_executor::state
   block_executor::run_one_iteration()
   {
@@ -222,7 +304,7 @@ namespace gr {
 
       if(noutput_items == 0){		// we're output blocked
         LOG(*d_log << "  BLKD_OUT\n");
-        return BLKD_OUT;
+        return blocked(m, d, BLKD_OUT);
       }
 
       goto setup_call_to_work;		// jump to common code
@@ -239,14 +321,13 @@ namespace gr {
       
       max_items_avail = 0;
       for(int i = 0; i < d->ninputs (); i++) {
-        {
-          /*
-           * Acquire the mutex and grab local copies of items_available and done.
-           */
-          gr::thread::scoped_lock guard(*d->input(i)->mutex());
-          d_ninput_items[i] = d->input(i)->items_available();
-          d_input_done[i] = d->input(i)->done();
-        }
+        /*
+         * Grab local copies of done and items_available. Read done
+         * first: once we see it set, every item the writer produced
+         * before setting it is visible to items_available.
+         */
+        d_input_done[i] = d->input(i)->done();
+        d_ninput_items[i] = d->input(i)->items_available();
 
         LOG(*d_log << "  d_ninput_items[" << i << "] = " << d_ninput_items[i] << std::endl);
         LOG(*d_log << "  d_input_done[" << i << "] = " << d_input_done[i] << std::endl);
@@ -266,7 +347,7 @@ namespace gr {
 
       if(noutput_items == 0) {    // we're blocked on input
         LOG(*d_log << "  BLKD_IN\n");
-        return BLKD_IN;
+        return blocked(m, d, BLKD_IN);
       }
 
       goto try_again;     // Jump to code shared with regular case.
@@ -283,14 +364,13 @@ namespace gr {
 
       max_items_avail = 0;
       for(int i = 0; i < d->ninputs (); i++) {
-        {
-          /*
-           * Acquire the mutex and grab local copies of items_available and done.
-           */
-          gr::thread::scoped_lock guard(*d->input(i)->mutex());
-          d_ninput_items[i] = d->input(i)->items_available ();
-          d_input_done[i] = d->input(i)->done();
-        }
+        /*
+         * Grab local copies of done and items_available. Read done
+         * first: once we see it set, every item the writer produced
+         * before setting it is visible to items_available.
+         */
+        d_input_done[i] = d->input(i)->done();
+        d_ninput_items[i] = d->input(i)->items_available();
         max_items_avail = std::max(max_items_avail, d_ninput_items[i]);
       }
 
@@ -310,7 +390,7 @@ namespace gr {
 
       if(noutput_items == 0) {		// we're output blocked
         LOG(*d_log << "  BLKD_OUT\n");
-        return BLKD_OUT;
+        return blocked(m, d, BLKD_OUT);
       }
 
     try_again:
@@ -409,7 +489,7 @@ namespace gr {
           m->set_unaligned(0);
           m->set_is_unaligned(false);
         }
-        return BLKD_IN;
+        return blocked(m, d, BLKD_IN);
       }
 
       // We've got enough data on each input to produce noutput_items.
@@ -433,12 +513,22 @@ namespace gr {
 #endif /* GR_PERFORMANCE_COUNTERS */
     
       // Do the actual work of the block
+      tracer::trace(tracer::WORK_BEGIN, m->unique_id(), noutput_items);
       int n = m->general_work(noutput_items, d_ninput_items,
                               d_input_items, d_output_items);
+      tracer::trace(tracer::WORK_END, m->unique_id(), n);
 
 #ifdef GR_PERFORMANCE_COUNTERS
-      if(d_use_pc)
+      if(d_use_pc) {
         d->stop_perf_counters(noutput_items, n);
+
+        // Probes go on before the items are produced so that no
+        // reader can get past them first.
+        if(n > 0 && d->source_p() && (d_probe_all || m->latency_probe()))
+          stamp_latency_probe(m, d);
+        else if(d->sink_p() && gr::thread::atomic_load_acquire(&s_latency_probes_stamped))
+          collect_latency_probes(d);
+      }
 #endif /* GR_PERFORMANCE_COUNTERS */
 
       LOG(*d_log << "  general_work: noutput_items = " << noutput_items
@@ -452,7 +542,8 @@ namespace gr {
 
       if(!propagate_tags(m->tag_propagation_policy(), d,
                          d_start_nitems_read, m->relative_rate(),
-                         d_returned_tags, m->unique_id()))
+                         d_returned_tags, d_propagated_tags,
+                         m->unique_id()))
         goto were_done;
 
       if(n == block::WORK_DONE)
@@ -484,6 +575,7 @@ namespace gr {
 
   were_done:
     LOG(*d_log << "  were_done\n");
+    tracer::trace(tracer::DONE, m->unique_id());
     d->set_done (true);
     return DONE;
   }
@@ -26,6 +26,7 @@
 #include <gnuradio/api.h>
 #include <gnuradio/runtime_types.h>
 #include <gnuradio/tags.h>
+#include <gnuradio/high_res_timer.h>
 #include <fstream>
 
 namespace gr {
@@ -49,10 +50,15 @@ namespace gr {
     gr_vector_void_star		d_output_items;
     std::vector<uint64_t>       d_start_nitems_read; //stores where tag counts are before work
     std::vector<tag_t>          d_returned_tags;
+    std::vector<tag_t>          d_propagated_tags;
     int                         d_max_noutput_items;
 
 #ifdef GR_PERFORMANCE_COUNTERS
     bool d_use_pc;
+    bool d_probe_all;			// every source stamps latency probes
+    high_res_timer_type d_probe_period;	// minimum ticks between probes
+    high_res_timer_type d_last_probe;
+    std::vector<tag_t> d_probe_tags;
 #endif /* GR_PERFORMANCE_COUNTERS */
 
   public:
@@ -71,6 +77,18 @@ namespace gr {
      * \brief Run one iteration.
      */
     state run_one_iteration();
+
+  private:
+    // Record that we are returning BLKD_IN or BLKD_OUT.
+    state blocked(block *m, block_detail *d, state s);
+
+#ifdef GR_PERFORMANCE_COUNTERS
+    // Tag the items about to be produced by a source with a probe.
+    void stamp_latency_probe(block *m, block_detail *d);
+
+    // Record the probes among the items a sink just consumed.
+    void collect_latency_probes(block_detail *d);
+#endif /* GR_PERFORMANCE_COUNTERS */
   };
 
 } /* namespace gr */
@@ -25,7 +25,9 @@
 #endif
 
 #include <gnuradio/buffer.h>
+#include <gnuradio/block.h>
 #include <gnuradio/math.h>
+#include <gnuradio/prefs.h>
 #include "vmcircbuf.h"
 #include <stdexcept>
 #include <iostream>
@@ -83,11 +85,16 @@ namespace gr {
     : d_base(0), d_bufsize(0), d_vmcircbuf(0),
       d_sizeof_item(sizeof_item), d_link(link),
       d_write_index(0), d_abs_write_offset(0), d_done(false),
-      d_last_min_items_read(0)
+      d_last_min_items_read(0), d_write_times_head(0)
   {
     if(!allocate_buffer (nitems, sizeof_item))
       throw std::bad_alloc ();
 
+#ifdef GR_PERFORMANCE_COUNTERS
+    if(prefs::singleton()->get_bool("PerfCounters", "on", false))
+      d_write_times.resize(64);
+#endif /* GR_PERFORMANCE_COUNTERS */
+
     s_buffer_count++;
   }
 
@@ -114,7 +121,7 @@ namespace gr {
     int orig_nitems = nitems;
 
     // Any buffersize we come up with must be a multiple of min_nitems.
-    int granularity = gr::vmcircbuf_sysconfig::granularity();
+    int granularity = gr::vmcircbuf_sysconfig::granularity_for_size(nitems * sizeof_item);
     int min_nitems =  minimum_buffer_items(sizeof_item, granularity);
 
     // Round-up nitems to a multiple of min_nitems.
@@ -133,8 +140,14 @@ namespace gr {
                 << "   On this platform, our allocation granularity is " << granularity << " bytes.\n";
     }
 
+    // Ask for the memory near the CPU our writer is bound to, if any.
+    int cpu = -1;
+    block_sptr writer = d_link.lock();
+    if(writer && !writer->processor_affinity().empty())
+      cpu = writer->processor_affinity()[0];
+
     d_bufsize = nitems;
-    d_vmcircbuf = gr::vmcircbuf_sysconfig::make(d_bufsize * d_sizeof_item);
+    d_vmcircbuf = gr::vmcircbuf_sysconfig::make_for_cpu(d_bufsize * d_sizeof_item, cpu);
     if(d_vmcircbuf == 0){
       std::cerr << "gr::buffer::allocate_buffer: failed to allocate buffer of size "
                 << d_bufsize * d_sizeof_item / 1024 << " KB\n";
@@ -161,7 +174,9 @@ namespace gr {
         min_items_read = std::min(min_items_read, d_readers[i]->nitems_read());
       }
 
+      // Only the tag store needs the mutex; the indices don't.
       if(min_items_read != d_last_min_items_read) {
+        gr::thread::scoped_lock guard(*mutex());
         prune_tags(d_last_min_items_read);
         d_last_min_items_read = min_items_read;
       }
@@ -181,16 +196,59 @@ namespace gr {
   void
   buffer::update_write_pointer(int nitems)
   {
-    gr::thread::scoped_lock guard(*mutex());
-    d_write_index = index_add(d_write_index, nitems);
-    d_abs_write_offset += nitems;
+    // Note the time first so that it is there by the time a reader
+    // can see the items.
+    if(!d_write_times.empty()) {
+      write_time_t &w = d_write_times[d_write_times_head % d_write_times.size()];
+      w.end = d_abs_write_offset + nitems;
+      w.t = gr::high_res_timer_now();
+      gr::thread::atomic_store_release(&d_write_times_head, d_write_times_head + 1);
+    }
+
+    // Only we write these; the release stores make the items we just
+    // wrote visible to any reader that sees the new index.
+    gr::thread::atomic_store_release(&d_abs_write_offset,
+                                     d_abs_write_offset + nitems);
+    gr::thread::atomic_store_release(&d_write_index,
+                                     index_add(d_write_index, nitems));
+  }
+
+  void
+  buffer::set_nitems_written(uint64_t nitems)
+  {
+    gr::thread::atomic_store_release(&d_abs_write_offset, nitems);
+  }
+
+  bool
+  buffer::write_time(uint64_t abs_offset, high_res_timer_type &t) const
+  {
+    size_t n = d_write_times.size();
+    if(n == 0)
+      return false;
+
+    // Walk back from the newest entry to the oldest one that ends
+    // after abs_offset; that produce call made the item.
+    size_t head = gr::thread::atomic_load_acquire(&d_write_times_head);
+    size_t oldest = head > n ? head - n : 0;
+    size_t i = head;
+    while(i > oldest && d_write_times[(i - 1) % n].end > abs_offset)
+      i--;
+    if(i == head)			// not produced yet
+      return false;
+    if(i == oldest && oldest > 0)	// made before our oldest entry
+      return false;
+    t = d_write_times[i % n].t;
+
+    // Entry i and the one before it must not have been reused while
+    // we looked; the writer may be filling entry head2 - n.
+    size_t head2 = gr::thread::atomic_load_acquire(&d_write_times_head);
+    return i + n >= head2 + 2;
   }
 
   void
   buffer::set_done(bool done)
   {
-    gr::thread::scoped_lock guard(*mutex());
-    d_done = done;
+    gr::thread::atomic_store_release(&d_done, done);
   }
 
   buffer_reader_sptr
@@ -224,16 +282,32 @@ namespace gr {
   buffer::add_item_tag(const tag_t &tag)
   {
     gr::thread::scoped_lock guard(*mutex());
-    d_item_tags.push_back(tag);
+    // Tags almost always arrive in order, so hint at the end; that
+    // makes the insert amortized constant time.
+    d_item_tags.insert(d_item_tags.end(), std::make_pair(tag.offset, tag));
+  }
+
+  void
+  buffer::add_item_tags(std::vector<tag_t>::const_iterator begin,
+                        std::vector<tag_t>::const_iterator end)
+  {
+    if(begin == end)
+      return;
+
+    gr::thread::scoped_lock guard(*mutex());
+    for(; begin != end; begin++)
+      d_item_tags.insert(d_item_tags.end(), std::make_pair(begin->offset, *begin));
   }
 
   void
   buffer::remove_item_tag(const tag_t &tag, long id)
   {
     gr::thread::scoped_lock guard(*mutex());
-    for(std::deque<tag_t>::iterator it = d_item_tags.begin(); it != d_item_tags.end(); ++it) {
-      if(*it == tag) {
-	(*it).marked_deleted.push_back(id);
+    std::pair<tag_map_t::iterator, tag_map_t::iterator> range =
+      d_item_tags.equal_range(tag.offset);
+    for(tag_map_t::iterator it = range.first; it != range.second; ++it) {
+      if(it->second == tag) {
+	it->second.marked_deleted.push_back(id);
       }
     }
   }
@@ -243,31 +317,16 @@ namespace gr {
   {
     /* NOTE: this function _should_ lock the mutex before editing
        d_item_tags. In practice, this function is only called at
-       runtime by min_available_space in block_executor.cc, which
-       locks the mutex itself.
+       runtime by space_available, which locks the mutex itself.
 
        If this function is used elsewhere, remember to lock the
        buffer's mutex al la the scoped_lock line below.
     */
     //gr::thread::scoped_lock guard(*mutex());
-    std::deque<tag_t>::iterator itr = d_item_tags.begin();
-
-    uint64_t item_time;
-
-    // Since tags are not guarenteed to be in any particular order, we
-    // need to erase here instead of pop_front. An erase in the middle
-    // invalidates all iterators; so this resets the iterator to find
-    // more. Mostly, we wil be erasing from the front and
-    // therefore lose little time this way.
-    while(itr != d_item_tags.end()) {
-      item_time = (*itr).offset;
-      if(item_time < max_time) {
-        d_item_tags.erase(itr);
-        itr = d_item_tags.begin();
-      }
-      else
-        itr++;
-    }
+
+    // Tags are sorted by offset, so everything before max_time is at
+    // the front.
+    d_item_tags.erase(d_item_tags.begin(), d_item_tags.lower_bound(max_time));
   }
 
   long
@@ -294,7 +353,8 @@ namespace gr {
   int
   buffer_reader::items_available() const
   {
-    return d_buffer->index_sub(d_buffer->d_write_index, d_read_index);
+    return d_buffer->index_sub(gr::thread::atomic_load_acquire(&d_buffer->d_write_index),
+                               gr::thread::atomic_load_acquire(&d_read_index));
   }
 
   const void *
@@ -305,37 +365,65 @@ namespace gr {
 
   void
   buffer_reader::update_read_pointer(int nitems)
+  {
+    // Only we write these; the release stores tell the writer that
+    // it may reuse the space we've finished reading.
+    gr::thread::atomic_store_release(&d_abs_read_offset,
+                                     d_abs_read_offset + nitems);
+    gr::thread::atomic_store_release(&d_read_index,
+                                     d_buffer->index_add(d_read_index, nitems));
+  }
+
+  void
+  buffer_reader::set_nitems_read(uint64_t nitems)
+  {
+    gr::thread::atomic_store_release(&d_abs_read_offset, nitems);
+  }
+
+  void
+  buffer_reader::get_tags_in_range(std::vector<tag_t> &v,
+                                   uint64_t abs_start,
+                                   uint64_t abs_end,
+				   long id)
   {
     gr::thread::scoped_lock guard(*mutex());
-    d_read_index = d_buffer->index_add (d_read_index, nitems);
-    d_abs_read_offset += nitems;
+
+    v.resize(0);
+    buffer::tag_map_t::iterator itr = d_buffer->get_tags_lower_bound(abs_start);
+    buffer::tag_map_t::iterator end = d_buffer->get_tags_end();
+
+    for(; itr != end && itr->first < abs_end; itr++) {
+      const tag_t &tag = itr->second;
+      if(std::find(tag.marked_deleted.begin(), tag.marked_deleted.end(), id)
+         == tag.marked_deleted.end()) { // If id is not in the vector of marked blocks
+        v.push_back(tag);
+        v.back().marked_deleted.clear();
+      }
+    }
   }
 
   void
   buffer_reader::get_tags_in_range(std::vector<tag_t> &v,
                                    uint64_t abs_start,
                                    uint64_t abs_end,
+                                   const pmt::pmt_t &key,
 				   long id)
   {
     gr::thread::scoped_lock guard(*mutex());
 
     v.resize(0);
-    std::deque<tag_t>::iterator itr = d_buffer->get_tags_begin();
-
-    uint64_t item_time;
-    while(itr != d_buffer->get_tags_end()) {
-      item_time = (*itr).offset;
-
-      if((item_time >= abs_start) && (item_time < abs_end)) {
-	std::vector<long>::iterator id_itr;
-	id_itr = std::find(itr->marked_deleted.begin(), itr->marked_deleted.end(), id);
-	if (id_itr == itr->marked_deleted.end()) { // If id is not in the vector of marked blocks
-	  v.push_back(*itr);
-	  v.back().marked_deleted.clear();
-	}
+    buffer::tag_map_t::iterator itr = d_buffer->get_tags_lower_bound(abs_start);
+    buffer::tag_map_t::iterator end = d_buffer->get_tags_end();
+
+    for(; itr != end && itr->first < abs_end; itr++) {
+      const tag_t &tag = itr->second;
+      if(!pmt::eqv(key, tag.key))
+        continue;
+      if(std::find(tag.marked_deleted.begin(), tag.marked_deleted.end(), id)
+         == tag.marked_deleted.end()) { // If id is not in the vector of marked blocks
+        v.push_back(tag);
+        v.back().marked_deleted.clear();
       }
-      
-      itr++;
     }
   }
 
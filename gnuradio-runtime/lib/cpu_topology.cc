@@ -0,0 +1,180 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "cpu_topology.h"
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdlib.h>
+#include <stdio.h>
+
+namespace gr {
+
+  // First line of a sysfs attribute; empty if it can't be read.
+  static std::string
+  read_line(const std::string &path)
+  {
+    std::ifstream f(path.c_str());
+    std::string line;
+    if(f)
+      std::getline(f, line);
+    return line;
+  }
+
+  static int
+  read_int(const std::string &path, int dflt)
+  {
+    std::string s = read_line(path);
+    if(s.empty())
+      return dflt;
+    return atoi(s.c_str());
+  }
+
+  std::vector<int>
+  cpu_topology::parse_cpu_list(const std::string &s)
+  {
+    std::vector<int> cpus;
+    std::stringstream ss(s);
+    std::string piece;
+    while(std::getline(ss, piece, ',')) {
+      int lo, hi;
+      if(sscanf(piece.c_str(), "%d-%d", &lo, &hi) == 2) {
+        for(int i = lo; i <= hi; i++)
+          cpus.push_back(i);
+      }
+      else if(sscanf(piece.c_str(), "%d", &lo) == 1) {
+        cpus.push_back(lo);
+      }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+  }
+
+  cpu_topology::cpu_topology()
+  {
+    read("/sys/devices/system");
+  }
+
+  cpu_topology::cpu_topology(const std::string &root)
+  {
+    read(root);
+  }
+
+  void
+  cpu_topology::read(const std::string &root)
+  {
+    std::vector<int> online = parse_cpu_list(read_line(root + "/cpu/online"));
+    if(online.empty()) {
+      int n = boost::thread::hardware_concurrency();
+      for(int i = 0; i < std::max(n, 1); i++)
+        online.push_back(i);
+    }
+
+    std::map<int,int> node_of;
+    std::vector<int> nodes = parse_cpu_list(read_line(root + "/node/online"));
+    for(size_t i = 0; i < nodes.size(); i++) {
+      std::stringstream path;
+      path << root << "/node/node" << nodes[i] << "/cpulist";
+      std::vector<int> cpus = parse_cpu_list(read_line(path.str()));
+      for(size_t j = 0; j < cpus.size(); j++)
+        node_of[cpus[j]] = nodes[i];
+    }
+
+    for(size_t i = 0; i < online.size(); i++) {
+      std::stringstream dir;
+      dir << root << "/cpu/cpu" << online[i];
+
+      cpu_info c;
+      c.id = online[i];
+      c.node = node_of.count(c.id) ? node_of[c.id] : 0;
+      c.package = read_int(dir.str() + "/topology/physical_package_id", 0);
+      c.core = read_int(dir.str() + "/topology/core_id", c.id);
+      c.cache_level = 0;
+      c.cache_group = 0;
+
+      // The highest level unified cache is the one shared most widely.
+      for(int k = 0; ; k++) {
+        std::stringstream idx;
+        idx << dir.str() << "/cache/index" << k;
+        int level = read_int(idx.str() + "/level", -1);
+        if(level < 0)
+          break;
+        if(read_line(idx.str() + "/type") == "Instruction" || level < c.cache_level)
+          continue;
+        std::vector<int> shared = parse_cpu_list(read_line(idx.str() + "/shared_cpu_list"));
+        c.cache_level = level;
+        c.cache_group = shared.empty() ? c.id : shared[0];
+      }
+
+      d_cpus.push_back(c);
+    }
+  }
+
+  namespace {
+    struct placement_order {
+      int node, group, thread, package, core, id;
+      bool operator<(const placement_order &o) const {
+        if(node != o.node) return node < o.node;
+        if(group != o.group) return group < o.group;
+        if(thread != o.thread) return thread < o.thread;
+        if(package != o.package) return package < o.package;
+        if(core != o.core) return core < o.core;
+        return id < o.id;
+      }
+    };
+  }
+
+  std::vector<std::vector<int> >
+  cpu_topology::cache_groups() const
+  {
+    // Number the hardware threads of each core 0, 1, ... by cpu id.
+    std::map<std::pair<int,int>, int> nthreads;
+    std::vector<placement_order> order;
+    for(size_t i = 0; i < d_cpus.size(); i++) {
+      const cpu_info &c = d_cpus[i];
+      placement_order o;
+      o.node = c.node;
+      o.group = c.cache_group;
+      o.thread = nthreads[std::make_pair(c.package, c.core)]++;
+      o.package = c.package;
+      o.core = c.core;
+      o.id = c.id;
+      order.push_back(o);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<std::vector<int> > groups;
+    for(size_t i = 0; i < order.size(); i++) {
+      if(i == 0 || order[i].node != order[i-1].node || order[i].group != order[i-1].group)
+        groups.push_back(std::vector<int>());
+      groups.back().push_back(order[i].id);
+    }
+    return groups;
+  }
+
+} /* namespace gr */
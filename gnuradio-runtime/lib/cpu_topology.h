@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDED_GR_RUNTIME_CPU_TOPOLOGY_H
+#define INCLUDED_GR_RUNTIME_CPU_TOPOLOGY_H
+
+#include <gnuradio/api.h>
+#include <string>
+#include <vector>
+
+namespace gr {
+
+  /*!
+   * \brief The processors of this machine, grouped by the last level
+   * cache they share.
+   * \ingroup internal
+   *
+   * \details
+   * On Linux the layout is read from sysfs. Elsewhere, or if sysfs
+   * can't be read, all online processors are put in one group.
+   */
+  class GR_RUNTIME_API cpu_topology
+  {
+  public:
+    struct cpu_info {
+      int id;
+      int node;         //!< NUMA node, 0 if unknown
+      int package;      //!< physical package (socket)
+      int core;         //!< core id within the package
+      int cache_level;  //!< level of the last level cache, 0 if unknown
+      int cache_group;  //!< lowest numbered cpu sharing that cache
+    };
+
+    //! Read the topology of the running system.
+    cpu_topology();
+
+    /*!
+     * \brief Read the topology from a sysfs tree rooted at \p root
+     * (normally "/sys/devices/system").
+     */
+    cpu_topology(const std::string &root);
+
+    //! All online processors, in order of id.
+    const std::vector<cpu_info> &cpus() const { return d_cpus; }
+
+    /*!
+     * \brief Processors sharing a last level cache, one vector per
+     * cache.
+     *
+     * Groups are ordered by NUMA node. Within a group, the first
+     * hardware thread of every core comes before the second thread of
+     * any core, so that handing out processors from the front of a
+     * group uses separate cores before SMT siblings.
+     */
+    std::vector<std::vector<int> > cache_groups() const;
+
+    /*!
+     * \brief Parse a sysfs style cpu list such as "0-3,8,10-11".
+     * Malformed pieces are ignored.
+     */
+    static std::vector<int> parse_cpu_list(const std::string &s);
+
+  private:
+    std::vector<cpu_info> d_cpus;
+
+    void read(const std::string &root);
+  };
+
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_RUNTIME_CPU_TOPOLOGY_H */
@@ -29,8 +29,10 @@
 #include <gnuradio/buffer.h>
 #include <gnuradio/prefs.h>
 #include <volk/volk.h>
+#include <cstring>
 #include <iostream>
 #include <map>
+#include <set>
 #include <boost/format.hpp>
 
 namespace gr {
@@ -42,6 +44,86 @@ namespace gr {
 
   static const unsigned int s_fixed_buffer_size = GR_FIXED_BUFFER_SIZE;
 
+  static bool
+  has_msg_edge(const msg_edge_vector_t &edges, const msg_edge &e)
+  {
+    for(size_t i = 0; i < edges.size(); i++)
+      if(edges[i].src() == e.src() && edges[i].dst() == e.dst())
+        return true;
+    return false;
+  }
+
+  /*
+   * Copy the items the readers of \p from haven't consumed yet, and
+   * their tags, into the empty buffer \p to, and give every reader a
+   * reader of \p to positioned on the same item. The history a
+   * reader keeps is part of what it hasn't consumed, so it carries
+   * over too. \p to continues the item numbering of \p from, so
+   * nitems_read/nitems_written and the tag offsets go on as if
+   * nothing happened. Returns false, changing nothing, if the items
+   * don't fit.
+   */
+  static bool
+  move_unread_items(buffer_sptr from, buffer_sptr to)
+  {
+    std::vector<buffer_reader *> readers;
+    std::vector<block_sptr> blocks;
+    std::vector<int> ports;
+    int n = 0;
+    buffer_reader *oldest = 0;
+
+    for(size_t j = 0; j < from->nreaders(); j++) {
+      buffer_reader *r = from->reader(j);
+      block_sptr b = r->link();
+      if(!b || !b->detail())
+        continue;
+      for(int k = 0; k < b->detail()->ninputs(); k++) {
+        if(b->detail()->input(k).get() == r) {
+          readers.push_back(r);
+          blocks.push_back(b);
+          ports.push_back(k);
+          if(r->items_available() > n) {
+            n = r->items_available();
+            oldest = r;
+          }
+        }
+      }
+    }
+
+    if(n >= to->space_available())
+      return false;
+
+    // The first item we keep. It is negative while the history of a
+    // reader that has just started still holds the zeros it began
+    // with; the count wraps and writing the n items brings it back.
+    uint64_t end = from->nitems_written();
+    int64_t start = (int64_t)end - n;
+    to->set_nitems_written(end - n);
+
+    if(n > 0) {
+      size_t item_size = from->get_sizeof_item();
+      memcpy(to->write_pointer(), oldest->read_pointer(), n * item_size);
+
+      std::vector<tag_t> tags;
+      {
+        gr::thread::scoped_lock guard(*from->mutex());
+        buffer::tag_map_t::iterator t = from->get_tags_lower_bound(std::max(start, (int64_t)0));
+        for(; t != from->get_tags_end(); t++)
+          tags.push_back(t->second);
+      }
+      to->add_item_tags(tags.begin(), tags.end());
+      to->update_write_pointer(n);
+    }
+
+    // Replacing a reader drops it from the old buffer.
+    for(size_t j = 0; j < readers.size(); j++) {
+      buffer_reader_sptr r = buffer_add_reader(to, readers[j]->items_available(), blocks[j]);
+      r->set_nitems_read(readers[j]->nitems_read());
+      blocks[j]->detail()->set_input(ports[j], r);
+    }
+    return true;
+  }
+
   flat_flowgraph_sptr
   make_flat_flowgraph()
   {
@@ -49,7 +131,20 @@ namespace gr {
   }
 
   flat_flowgraph::flat_flowgraph()
+    : d_max_byte_rate(0)
   {
+    prefs *p = prefs::singleton();
+    std::string sizing = p->get_string("DEFAULT", "buffer_sizing", "fixed");
+    if(sizing != "fixed" && sizing != "rate") {
+      std::cerr << "flat_flowgraph: unknown buffer_sizing \"" << sizing
+                << "\"; using \"fixed\"" << std::endl;
+    }
+    d_rate_sizing = (sizing == "rate");
+    d_resize_buffers = d_rate_sizing && p->get_bool("DEFAULT", "buffer_resize", false);
+    d_buffer_size_min = p->get_long("DEFAULT", "buffer_size_min", 4096);
+    d_buffer_size_max = p->get_long("DEFAULT", "buffer_size_max", 8*s_fixed_buffer_size);
+    d_fusion = p->get_bool("DEFAULT", "block_fusion", false);
+    d_fusion_tile_size = p->get_long("DEFAULT", "fusion_tile_size", 16384);
   }
 
   flat_flowgraph::~flat_flowgraph()
@@ -61,6 +156,9 @@ namespace gr {
   {
     basic_block_vector_t blocks = calc_used_blocks();
 
+    if(d_rate_sizing)
+      calc_item_rates();
+
     // Assign block details to blocks
     for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++)
       cast_to_block_sptr(*p)->set_detail(allocate_block_detail(*p));
@@ -106,8 +204,11 @@ namespace gr {
         std::cout << "Allocated buffer for output " << block << ":" << i << std::endl;
       detail->set_output(i, buffer);
 
-      // Update the block's max_output_buffer based on what was actually allocated.
-      grblock->set_max_output_buffer(i, buffer->bufsize());
+      // Update the block's max_output_buffer based on what was actually
+      // allocated. With rate based sizing we leave it alone, since it
+      // still limits later resizing.
+      if(!d_rate_sizing)
+        grblock->set_max_output_buffer(i, buffer->bufsize());
     }
 
     return detail;
@@ -124,16 +225,16 @@ namespace gr {
     // *2 because we're now only filling them 1/2 way in order to
     // increase the available parallelism when using the TPB scheduler.
     // (We're double buffering, where we used to single buffer)
-    int nitems = s_fixed_buffer_size * 2 / item_size;
+    int nitems;
+    if(d_rate_sizing)
+      nitems = rate_buffer_nitems(block, item_size);
+    else
+      nitems = s_fixed_buffer_size * 2 / item_size;
 
     // Make sure there are at least twice the output_multiple no. of items
     if(nitems < 2*grblock->output_multiple())	// Note: this means output_multiple()
       nitems = 2*grblock->output_multiple();	// can't be changed by block dynamically
 
-    // If any downstream blocks are decimators and/or have a large output_multiple,
-    // ensure we have a buffer at least twice their decimation factor*output_multiple
-    basic_block_vector_t blocks = calc_downstream_blocks(block, port);
-
     // limit buffer size if indicated
     if(grblock->max_output_buffer(port) > 0) {
       //std::cout << "constraining output items to " << block->max_output_buffer(port) << "\n";
@@ -149,6 +250,29 @@ namespace gr {
         throw std::runtime_error("problems allocating a buffer with the given min output buffer constraint!");
     }
 
+    nitems = std::max(nitems, downstream_buffer_nitems(block, port));
+
+    //  std::cout << "make_buffer(" << nitems << ", " << item_size << ", " << grblock << "\n";
+    // We're going to let this fail once and retry. If that fails,
+    // throw and exit.
+    buffer_sptr b;
+    try {
+      b = make_buffer(nitems, item_size, grblock);
+    }
+    catch(std::bad_alloc&) {
+      b = make_buffer(nitems, item_size, grblock);
+    }
+    return b;
+  }
+
+  int
+  flat_flowgraph::downstream_buffer_nitems(basic_block_sptr block, int port)
+  {
+    // If any downstream blocks are decimators and/or have a large output_multiple,
+    // ensure we have a buffer at least twice their decimation factor*output_multiple
+    basic_block_vector_t blocks = calc_downstream_blocks(block, port);
+
+    int nitems = 0;
     for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++) {
       block_sptr dgrblock = cast_to_block_sptr(*p);
       if(!dgrblock)
@@ -159,18 +283,140 @@ namespace gr {
       int history       = dgrblock->history();
       nitems = std::max(nitems, static_cast<int>(2*(decimation*multiple+history)));
     }
+    return nitems;
+  }
 
-    //  std::cout << "make_buffer(" << nitems << ", " << item_size << ", " << grblock << "\n";
-    // We're going to let this fail once and retry. If that fails,
-    // throw and exit.
-    buffer_sptr b;
-    try {
-      b = make_buffer(nitems, item_size, grblock);
+  /*
+   * Walk the graph from the sources down, multiplying by each block's
+   * relative rate, to find how many items each block produces per
+   * source item. Where several edges meet we take the fastest. We
+   * don't know the sources' real rates, so they all count as 1.
+   */
+  void
+  flat_flowgraph::calc_item_rates()
+  {
+    basic_block_vector_t blocks = calc_used_blocks();
+    blocks = topological_sort(blocks);
+
+    d_item_rates.clear();
+    d_max_byte_rate = 0;
+
+    for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++) {
+      block_sptr grblock = cast_to_block_sptr(*p);
+      if(!grblock)
+        throw std::runtime_error("calc_item_rates found non-gr::block");
+
+      double in_rate = 0;
+      edge_vector_t in_edges = calc_upstream_edges(*p);
+      if(in_edges.empty())
+        in_rate = 1.0;
+      for(edge_viter_t e = in_edges.begin(); e != in_edges.end(); e++)
+        in_rate = std::max(in_rate, d_item_rates[e->src().block()]);
+
+      double out_rate = in_rate * grblock->relative_rate();
+      d_item_rates[*p] = out_rate;
+
+      std::vector<int> ports = calc_used_ports(*p, false);
+      for(size_t i = 0; i < ports.size(); i++) {
+        size_t item_size = (*p)->output_signature()->sizeof_stream_item(ports[i]);
+        d_max_byte_rate = std::max(d_max_byte_rate, out_rate * item_size);
+      }
     }
-    catch(std::bad_alloc&) {
-      b = make_buffer(nitems, item_size, grblock);
+  }
+
+  /*
+   * The fastest edge gets the fixed size buffer; the others get a
+   * share in proportion to their byte rate, but no less than
+   * buffer_size_min bytes.
+   */
+  int
+  flat_flowgraph::rate_buffer_nitems(basic_block_sptr block, int item_size)
+  {
+    double nbytes = s_fixed_buffer_size * 2;
+
+    std::map<basic_block_sptr, double>::iterator r = d_item_rates.find(block);
+    if(r != d_item_rates.end() && d_max_byte_rate > 0)
+      nbytes *= r->second * item_size / d_max_byte_rate;
+
+    nbytes = std::max(nbytes, static_cast<double>(d_buffer_size_min));
+    nbytes = std::min(nbytes, static_cast<double>(d_buffer_size_max));
+    return std::max(1, static_cast<int>(nbytes / item_size));
+  }
+
+  /*
+   * A buffer that has mostly been close to full holds up its writer;
+   * double it. One that has mostly been close to empty is bigger than
+   * its reader needs; halve it. We need the performance counters to
+   * tell, so blocks that have none are left alone. The items still
+   * in a buffer move to its replacement; a buffer whose items would
+   * not fit in the smaller one is kept.
+   */
+  void
+  flat_flowgraph::resize_buffers(flat_flowgraph_sptr old_ffg,
+                                 const std::set<basic_block_sptr> &changed)
+  {
+    for(basic_block_viter_t p = d_blocks.begin(); p != d_blocks.end(); p++) {
+      if(!old_ffg->has_block_p(*p) || !changed.count(*p))
+        continue;
+
+      block_sptr grblock = cast_to_block_sptr(*p);
+      block_detail_sptr detail = grblock->detail();
+      if(!detail || detail->pc_counter() == 0)
+        continue;
+
+      bool resized = false;
+      for(int i = 0; i < detail->noutputs(); i++) {
+        buffer_sptr old_buffer = detail->output(i);
+        if(!old_buffer)
+          continue;
+
+        // Readers that are still running hold on to the old buffer.
+        basic_block_vector_t readers = calc_downstream_blocks(*p, i);
+        bool stopped = true;
+        for(size_t j = 0; j < readers.size(); j++)
+          stopped = stopped && changed.count(readers[j]);
+        if(!stopped)
+          continue;
+
+        int item_size = old_buffer->get_sizeof_item();
+        float full = detail->pc_output_buffers_full_avg(i);
+        long nitems = old_buffer->bufsize();
+        if(full > 0.75)
+          nitems *= 2;
+        else if(full < 0.25)
+          nitems /= 2;
+        else
+          continue;
+
+        nitems = std::max(nitems, d_buffer_size_min / item_size);
+        nitems = std::min(nitems, d_buffer_size_max / item_size);
+        if(grblock->max_output_buffer(i) > 0)
+          nitems = std::min(nitems, grblock->max_output_buffer(i));
+        if(grblock->min_output_buffer(i) > 0)
+          nitems = std::max(nitems, grblock->min_output_buffer(i));
+        nitems = std::max(nitems, 2L*grblock->output_multiple());
+        nitems = std::max(nitems, (long)downstream_buffer_nitems(*p, i));
+        if(nitems == old_buffer->bufsize())
+          continue;
+
+        buffer_sptr buffer = make_buffer(nitems, item_size, grblock);
+        if(buffer->bufsize() == old_buffer->bufsize())
+          continue;
+        if(!move_unread_items(old_buffer, buffer))
+          continue;
+
+        if(FLAT_FLOWGRAPH_DEBUG)
+          std::cout << "merge: resizing output " << (*p) << ":" << i << " from "
+                    << old_buffer->bufsize() << " to " << buffer->bufsize()
+                    << " items" << std::endl;
+        detail->set_output(i, buffer);
+        resized = true;
+      }
+
+      // The averages describe the buffers we just replaced.
+      if(resized)
+        detail->reset_perf_counters();
     }
-    return b;
   }
 
   void
@@ -206,6 +452,27 @@ namespace gr {
   void
   flat_flowgraph::merge_connections(flat_flowgraph_sptr old_ffg)
   {
+    // Everything is stopped.
+    basic_block_vector_t all = d_blocks;
+    all.insert(all.end(), old_ffg->d_blocks.begin(), old_ffg->d_blocks.end());
+    merge_connections(old_ffg, all);
+  }
+
+  /*
+   * Blocks outside of changed are left alone below: their edges are
+   * the same in both flowgraphs, so their readers all match their
+   * upstream buffers already, and resize_buffers won't touch a buffer
+   * any of them uses.
+   */
+  void
+  flat_flowgraph::merge_connections(flat_flowgraph_sptr old_ffg,
+                                    const basic_block_vector_t &changed)
+  {
+    std::set<basic_block_sptr> stopped(changed.begin(), changed.end());
+
+    if(d_rate_sizing)
+      calc_item_rates();
+
     // Allocate block details if needed.  Only new blocks that aren't pruned out
     // by flattening will need one; existing blocks still in the new flowgraph will
     // already have one.
@@ -222,19 +489,17 @@ namespace gr {
           std::cout << "merge: reusing original detail for block " << (*p) << std::endl;
     }
 
+    // Readers of any buffer we replace get new ones below.
+    if(d_resize_buffers)
+      resize_buffers(old_ffg, stopped);
+
     // Calculate the old edges that will be going away, and clear the
     // buffer readers on the RHS.
     for(edge_viter_t old_edge = old_ffg->d_edges.begin(); old_edge != old_ffg->d_edges.end(); old_edge++) {
       if(FLAT_FLOWGRAPH_DEBUG)
         std::cout << "merge: testing old edge " << (*old_edge) << "...";
 
-      edge_viter_t new_edge;
-      for(new_edge = d_edges.begin(); new_edge != d_edges.end(); new_edge++)
-        if(new_edge->src() == old_edge->src() &&
-           new_edge->dst() == old_edge->dst())
-          break;
-
-      if(new_edge == d_edges.end()) { // not found in new edge list
+      if(!has_edge_p(*old_edge)) { // not found in new edge list
         if(FLAT_FLOWGRAPH_DEBUG)
           std::cout << "not in new edge list" << std::endl;
         // zero the buffer reader on RHS of old edge
@@ -304,6 +569,163 @@ namespace gr {
       // changed numbers of inputs and outputs vs. in the old
       // flowgraph.
     }
+
+    // Drop the message subscriptions going away and make the new
+    // ones; both ends of those are in changed.
+    for(msg_edge_viter_t e = old_ffg->d_msg_edges.begin(); e != old_ffg->d_msg_edges.end(); e++) {
+      if(!has_msg_edge(d_msg_edges, *e))
+        e->src().block()->message_port_unsub(e->src().port(), pmt::cons(e->dst().block()->alias_pmt(), e->dst().port()));
+    }
+    for(msg_edge_viter_t e = d_msg_edges.begin(); e != d_msg_edges.end(); e++) {
+      if(stopped.count(e->src().block()))
+        e->src().block()->message_port_sub(e->src().port(), pmt::cons(e->dst().block()->alias_pmt(), e->dst().port()));
+    }
+  }
+
+  void
+  flat_flowgraph::calc_changed_blocks(flat_flowgraph_sptr old_ffg,
+                                      basic_block_vector_t &stopping,
+                                      basic_block_vector_t &starting)
+  {
+    std::set<basic_block_sptr> changed;
+
+    for(basic_block_viter_t p = old_ffg->d_blocks.begin(); p != old_ffg->d_blocks.end(); p++)
+      if(!has_block_p(*p))
+        changed.insert(*p);
+    for(basic_block_viter_t p = d_blocks.begin(); p != d_blocks.end(); p++)
+      if(!old_ffg->has_block_p(*p))
+        changed.insert(*p);
+
+    // Edges in one flowgraph but not the other
+    for(edge_viter_t e = old_ffg->d_edges.begin(); e != old_ffg->d_edges.end(); e++) {
+      if(!has_edge_p(*e)) {
+        changed.insert(e->src().block());
+        changed.insert(e->dst().block());
+      }
+    }
+    for(edge_viter_t e = d_edges.begin(); e != d_edges.end(); e++) {
+      if(!old_ffg->has_edge_p(*e)) {
+        changed.insert(e->src().block());
+        changed.insert(e->dst().block());
+      }
+    }
+
+    // Message connections too; merge_connections redoes their
+    // subscriptions.
+    for(msg_edge_viter_t e = old_ffg->d_msg_edges.begin(); e != old_ffg->d_msg_edges.end(); e++) {
+      if(!has_msg_edge(d_msg_edges, *e)) {
+        changed.insert(e->src().block());
+        changed.insert(e->dst().block());
+      }
+    }
+    for(msg_edge_viter_t e = d_msg_edges.begin(); e != d_msg_edges.end(); e++) {
+      if(!has_msg_edge(old_ffg->d_msg_edges, *e)) {
+        changed.insert(e->src().block());
+        changed.insert(e->dst().block());
+      }
+    }
+
+    stopping.clear();
+    starting.clear();
+    for(std::set<basic_block_sptr>::iterator p = changed.begin(); p != changed.end(); p++) {
+      if(FLAT_FLOWGRAPH_DEBUG)
+        std::cout << "changed: " << (*p) << std::endl;
+      if(old_ffg->has_block_p(*p))
+        stopping.push_back(*p);
+      if(has_block_p(*p))
+        starting.push_back(*p);
+    }
+  }
+
+  /*
+   * Can block be a member of a fused chain? It has to say so itself,
+   * have no history or message ports, and have exactly one input
+   * edge and nothing but output port 0 in use.
+   */
+  bool
+  flat_flowgraph::fusable_p(basic_block_sptr block)
+  {
+    sync_block *s = dynamic_cast<sync_block *>(block.get());
+    if(s == 0 || !s->fusable() || s->history() != 1 || s->output_multiple_set())
+      return false;
+
+    if(pmt::length(s->message_ports_in()) != 0
+       || pmt::length(s->message_ports_out()) != 0)
+      return false;
+
+    edge_index_t::const_iterator in = d_in_edges.find(block);
+    if(in == d_in_edges.end() || in->second.size() != 1)
+      return false;
+
+    edge_index_t::const_iterator out = d_out_edges.find(block);
+    if(out == d_out_edges.end())
+      return false;
+    for(size_t i = 0; i < out->second.size(); i++)
+      if(out->second[i].src().port() != 0)
+        return false;
+
+    return true;
+  }
+
+  void
+  flat_flowgraph::fuse_sync_blocks(flat_flowgraph_sptr old_ffg)
+  {
+    if(!d_fusion)
+      return;
+
+    basic_block_vector_t blocks = topological_sort(d_blocks);
+    std::set<basic_block_sptr> taken;
+
+    for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++) {
+      if(taken.count(*p) || !fusable_p(*p))
+        continue;
+
+      // In topological order, the first member we meet heads its
+      // chain; follow single edges downstream as far as they go.
+      basic_block_vector_t chain(1, *p);
+      edge_vector_t inner;
+      while(1) {
+        const edge_vector_t &out = d_out_edges[chain.back()];
+        if(out.size() != 1 || !fusable_p(out[0].dst().block()))
+          break;
+        inner.push_back(out[0]);
+        chain.push_back(out[0].dst().block());
+      }
+      if(chain.size() < 2)
+        continue;
+
+      block_vector_t members = make_block_vector(chain);
+      fused_block::sptr f;
+      if(old_ffg) {
+        for(size_t i = 0; i < old_ffg->d_fused.size() && !f; i++)
+          if(old_ffg->d_fused[i]->members() == members)
+            f = old_ffg->d_fused[i];
+      }
+      if(!f)
+        f = fused_block::make(members, d_fusion_tile_size);
+      d_fused.push_back(f);
+
+      if(FLAT_FLOWGRAPH_DEBUG)
+        std::cout << "fusing " << chain.size() << " blocks from "
+                  << chain.front() << " into " << f << std::endl;
+
+      // Rewire the chain's outside edges to the fused block.
+      edge in = d_in_edges[chain.front()][0];
+      edge_vector_t outs = d_out_edges[chain.back()];
+      for(size_t i = 0; i < inner.size(); i++)
+        disconnect(inner[i].src(), inner[i].dst());
+      disconnect(in.src(), in.dst());
+      connect(in.src(), endpoint(f, 0));
+      for(size_t i = 0; i < outs.size(); i++) {
+        disconnect(outs[i].src(), outs[i].dst());
+        connect(endpoint(f, 0), outs[i].dst());
+      }
+
+      taken.insert(chain.begin(), chain.end());
+    }
+
+    if(!d_fused.empty())
+      validate();
   }
 
   void
@@ -26,6 +26,9 @@
 #include <gnuradio/api.h>
 #include <gnuradio/flowgraph.h>
 #include <gnuradio/block.h>
+#include "fused_block.h"
+#include <map>
+#include <set>
 
 namespace gr {
 
@@ -52,6 +55,35 @@ namespace gr {
     // Merge applicable connections from existing flat flowgraph
     void merge_connections(flat_flowgraph_sptr sfg);
 
+    /*!
+     * Merge connections from \a sfg while the blocks that are not in
+     * \a changed (the stopping and starting blocks of
+     * calc_changed_blocks) keep running: only the details and buffers
+     * of blocks in \a changed are touched.
+     */
+    void merge_connections(flat_flowgraph_sptr sfg,
+                           const basic_block_vector_t &changed);
+
+    /*!
+     * The blocks that change when \a sfg is turned into this
+     * flowgraph: those added or removed, and both ends of every edge
+     * added or removed. \a stopping gets the ones in \a sfg, \a
+     * starting the ones in this flowgraph. Everything else keeps its
+     * buffers and readers across merge_connections.
+     */
+    void calc_changed_blocks(flat_flowgraph_sptr sfg,
+                             basic_block_vector_t &stopping,
+                             basic_block_vector_t &starting);
+
+    /*!
+     * Replace every chain of two or more fusable sync blocks (see
+     * sync_block::fusable) by a fused_block running the whole chain,
+     * then validate again. Fused blocks of \a sfg whose chain is
+     * unchanged are reused, so that a restart leaves them running.
+     * Does nothing unless the [DEFAULT] block_fusion preference is on.
+     */
+    void fuse_sync_blocks(flat_flowgraph_sptr sfg=flat_flowgraph_sptr());
+
     // Return a string list of edges
     std::string edge_list();
 
@@ -77,10 +109,41 @@ namespace gr {
   private:
     flat_flowgraph();
 
+    // Buffer sizing policy, from the [DEFAULT] buffer_* prefs
+    bool d_rate_sizing;
+    bool d_resize_buffers;
+    long d_buffer_size_min;
+    long d_buffer_size_max;
+
+    // Output item rate of each block relative to the sources, and the
+    // highest byte rate of any edge; used by rate based sizing.
+    std::map<basic_block_sptr, double> d_item_rates;
+    double d_max_byte_rate;
+
+    // Block fusion, from the [DEFAULT] block_fusion prefs
+    bool d_fusion;
+    long d_fusion_tile_size;
+    std::vector<fused_block::sptr> d_fused;
+
+    bool fusable_p(basic_block_sptr block);
+
     block_detail_sptr allocate_block_detail(basic_block_sptr block);
     buffer_sptr allocate_buffer(basic_block_sptr block, int port);
     void connect_block_inputs(basic_block_sptr block);
 
+    void calc_item_rates();
+    int rate_buffer_nitems(basic_block_sptr block, int item_size);
+    int downstream_buffer_nitems(basic_block_sptr block, int port);
+
+    /* Replace the output buffers of blocks carried over from the old
+     * flowgraph whose occupancy shows they are too big or too small.
+     * Called from merge_connections when buffer_resize is on; only
+     * buffers whose writer and readers are all in \p changed are
+     * replaced.
+     */
+    void resize_buffers(flat_flowgraph_sptr old_ffg,
+                        const std::set<basic_block_sptr> &changed);
+
     /* When reusing a flowgraph's blocks, this call makes sure all of
      * the buffer's are aligned at the machine's alignment boundary
      * and tells the blocks that they are aligned.
@@ -25,6 +25,7 @@
 #endif
 
 #include <gnuradio/flowgraph.h>
+#include <algorithm>
 #include <stdexcept>
 #include <sstream>
 #include <iterator>
@@ -63,6 +64,32 @@ namespace gr {
     return result;
   }
 
+  static const edge_vector_t s_no_edges;
+
+  // The edges of block in index; none if it has none.
+  static const edge_vector_t &
+  indexed_edges(const std::map<basic_block_sptr, edge_vector_t> &index,
+                const basic_block_sptr &block)
+  {
+    std::map<basic_block_sptr, edge_vector_t>::const_iterator i = index.find(block);
+    return i == index.end() ? s_no_edges : i->second;
+  }
+
+  static void
+  unindex_edge(std::map<basic_block_sptr, edge_vector_t> &index,
+               const basic_block_sptr &block, const edge &e)
+  {
+    edge_vector_t &edges = index[block];
+    for(edge_viter_t p = edges.begin(); p != edges.end(); p++) {
+      if(p->src() == e.src() && p->dst() == e.dst()) {
+        edges.erase(p);
+        break;
+      }
+    }
+    if(edges.empty())
+      index.erase(block);
+  }
+
   void
   flowgraph::connect(const endpoint &src, const endpoint &dst)
   {
@@ -72,7 +99,10 @@ namespace gr {
     check_type_match(src, dst);
 
     // All ist klar, Herr Kommisar
-    d_edges.push_back(edge(src,dst));
+    edge e(src, dst);
+    d_edges.push_back(e);
+    d_in_edges[dst.block()].push_back(e);
+    d_out_edges[src.block()].push_back(e);
   }
 
   void
@@ -80,6 +110,8 @@ namespace gr {
   {
     for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++) {
       if(src == p->src() && dst == p->dst()) {
+        unindex_edge(d_in_edges, dst.block(), *p);
+        unindex_edge(d_out_edges, src.block(), *p);
         d_edges.erase(p);
         return;
       }
@@ -126,6 +158,8 @@ namespace gr {
     // Boost shared pointers will deallocate as needed
     d_blocks.clear();
     d_edges.clear();
+    d_in_edges.clear();
+    d_out_edges.clear();
   }
 
   void
@@ -163,7 +197,8 @@ namespace gr {
   flowgraph::check_dst_not_used(const endpoint &dst)
   {
     // A destination is in use if it is already on the edge list
-    for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++)
+    const edge_vector_t &edges = indexed_edges(d_in_edges, dst.block());
+    for(edge_vector_t::const_iterator p = edges.begin(); p != edges.end(); p++)
       if(p->dst() == dst) {
         std::stringstream msg;
         msg << "destination already in use by edge " << (*p);
@@ -226,20 +261,7 @@ namespace gr {
   edge_vector_t
   flowgraph::calc_connections(basic_block_sptr block, bool check_inputs)
   {
-    edge_vector_t result;
-
-    for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++) {
-      if(check_inputs) {
-        if(p->dst().block() == block)
-          result.push_back(*p);
-      }
-      else {
-        if(p->src().block() == block)
-          result.push_back(*p);
-      }
-    }
-
-    return result; // assumes no duplicates
+    return indexed_edges(check_inputs ? d_in_edges : d_out_edges, block);
   }
 
   void
@@ -290,8 +312,9 @@ namespace gr {
   {
     basic_block_vector_t tmp;
 
-    for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++)
-      if(p->src() == endpoint(block, port))
+    const edge_vector_t &edges = indexed_edges(d_out_edges, block);
+    for(edge_vector_t::const_iterator p = edges.begin(); p != edges.end(); p++)
+      if(p->src().port() == port)
         tmp.push_back(p->dst().block());
 
     return unique_vector<basic_block_sptr>(tmp);
@@ -302,9 +325,9 @@ namespace gr {
   {
     basic_block_vector_t tmp;
 
-    for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++)
-      if(p->src().block() == block)
-        tmp.push_back(p->dst().block());
+    const edge_vector_t &edges = indexed_edges(d_out_edges, block);
+    for(edge_vector_t::const_iterator p = edges.begin(); p != edges.end(); p++)
+      tmp.push_back(p->dst().block());
 
     return unique_vector<basic_block_sptr>(tmp);
   }
@@ -312,21 +335,20 @@ namespace gr {
   edge_vector_t
   flowgraph::calc_upstream_edges(basic_block_sptr block)
   {
-    edge_vector_t result;
-
-    for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++)
-      if(p->dst().block() == block)
-        result.push_back(*p);
-
-    return result; // Assume no duplicates
+    return indexed_edges(d_in_edges, block);
   }
 
   bool
   flowgraph::has_block_p(basic_block_sptr block)
   {
-    basic_block_viter_t result;
-    result = std::find(d_blocks.begin(), d_blocks.end(), block);
-    return (result != d_blocks.end());
+    return std::binary_search(d_blocks.begin(), d_blocks.end(), block);
+  }
+
+  bool
+  flowgraph::has_edge_p(const edge &e)
+  {
+    // An input port has one edge at most
+    return calc_upstream_edge(e.dst().block(), e.dst().port()).src() == e.src();
   }
 
   edge
@@ -334,8 +356,9 @@ namespace gr {
   {
     edge result;
 
-    for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++) {
-      if(p->dst() == endpoint(block, port)) {
+    const edge_vector_t &edges = indexed_edges(d_in_edges, block);
+    for(edge_vector_t::const_iterator p = edges.begin(); p != edges.end(); p++) {
+      if(p->dst().port() == port) {
         result = (*p);
         break;
       }
@@ -349,15 +372,21 @@ namespace gr {
   {
     std::vector<basic_block_vector_t> result;
     basic_block_vector_t blocks = calc_used_blocks();
-    basic_block_vector_t graph;
 
-    while(blocks.size() > 0) {
-      graph = calc_reachable_blocks(blocks[0], blocks);
-      assert(graph.size());
-      result.push_back(topological_sort(graph));
+    // Mark all blocks as unvisited
+    for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++)
+      (*p)->set_color(basic_block::WHITE);
 
-      for(basic_block_viter_t p = graph.begin(); p != graph.end(); p++)
-        blocks.erase(find(blocks.begin(), blocks.end(), *p));
+    // Each unvisited block starts a new piece. topological_sort
+    // leaves the blocks of the piece BLACK.
+    for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++) {
+      if((*p)->color() != basic_block::WHITE)
+        continue;
+
+      basic_block_vector_t graph;
+      reachable_dfs_visit(*p, graph);
+      std::sort(graph.begin(), graph.end());
+      result.push_back(topological_sort(graph));
     }
 
     return result;
@@ -373,7 +402,8 @@ namespace gr {
       (*p)->set_color(basic_block::WHITE);
 
     // Recursively mark all reachable blocks
-    reachable_dfs_visit(block, blocks);
+    basic_block_vector_t reached;
+    reachable_dfs_visit(block, reached);
 
     // Collect all the blocks that have been visited
     for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++)
@@ -383,19 +413,21 @@ namespace gr {
     return result;
   }
 
-  // Recursively mark all reachable blocks from given block and block list
+  // Mark all WHITE blocks reachable from the given block, and add
+  // them to reached
   void
-  flowgraph::reachable_dfs_visit(basic_block_sptr block, basic_block_vector_t &blocks)
+  flowgraph::reachable_dfs_visit(basic_block_sptr block, basic_block_vector_t &reached)
   {
     // Mark the current one as visited
     block->set_color(basic_block::BLACK);
+    reached.push_back(block);
 
     // Recurse into adjacent vertices
-    basic_block_vector_t adjacent = calc_adjacent_blocks(block, blocks);
+    basic_block_vector_t adjacent = calc_adjacent_blocks(block, reached);
 
     for(basic_block_viter_t p = adjacent.begin(); p != adjacent.end(); p++)
       if((*p)->color() == basic_block::WHITE)
-        reachable_dfs_visit(*p, blocks);
+        reachable_dfs_visit(*p, reached);
   }
 
   // Return a list of block adjacent to a given block along any edge
@@ -405,12 +437,12 @@ namespace gr {
     basic_block_vector_t tmp;
 
     // Find any blocks that are inputs or outputs
-    for(edge_viter_t p = d_edges.begin(); p != d_edges.end(); p++) {
-      if(p->src().block() == block)
-        tmp.push_back(p->dst().block());
-      if(p->dst().block() == block)
-        tmp.push_back(p->src().block());
-    }
+    const edge_vector_t &out = indexed_edges(d_out_edges, block);
+    for(edge_vector_t::const_iterator p = out.begin(); p != out.end(); p++)
+      tmp.push_back(p->dst().block());
+    const edge_vector_t &in = indexed_edges(d_in_edges, block);
+    for(edge_vector_t::const_iterator p = in.begin(); p != in.end(); p++)
+      tmp.push_back(p->src().block());
 
     return unique_vector<basic_block_sptr>(tmp);
   }
@@ -0,0 +1,133 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "fused_block.h"
+#include <gnuradio/io_signature.h>
+#include <volk/volk.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace gr {
+
+  fused_block::sptr
+  fused_block::make(const block_vector_t &members, int tile_bytes)
+  {
+    return gnuradio::get_initial_sptr
+      (new fused_block(members, tile_bytes));
+  }
+
+  fused_block::fused_block(const block_vector_t &members, int tile_bytes)
+    : sync_block("fused_block",
+                 io_signature::make(1, 1, members.front()->input_signature()->sizeof_stream_item(0)),
+                 io_signature::make(1, 1, members.back()->output_signature()->sizeof_stream_item(0))),
+      d_members(members), d_in(1), d_out(1)
+  {
+    size_t maxsize = input_signature()->sizeof_stream_item(0);
+    int multiple = 1;
+    bool tags = true;
+
+    for(size_t i = 0; i < d_members.size(); i++) {
+      sync_block *s = dynamic_cast<sync_block *>(d_members[i].get());
+      if(s == 0)
+        throw std::invalid_argument("fused_block: " + d_members[i]->name() + " is not a sync_block");
+
+      d_sync.push_back(s);
+      d_itemsize.push_back(s->output_signature()->sizeof_stream_item(0));
+      maxsize = std::max(maxsize, d_itemsize.back());
+      multiple = std::max(multiple, s->output_multiple());
+      if(s->tag_propagation_policy() == TPP_DONT)
+        tags = false;
+    }
+
+    // Keep every tile, in every member's item size, on the
+    // alignment boundary.
+    d_alignment = volk_get_alignment();
+    d_tile = (int)(tile_bytes / maxsize / d_alignment * d_alignment);
+    d_tile = std::max(d_tile, (int)d_alignment);
+
+    for(int i = 0; i < 2; i++) {
+      d_tile_mem[i].resize(d_tile * maxsize + d_alignment);
+      size_t p = (size_t)&d_tile_mem[i][0];
+      d_tiles[i] = &d_tile_mem[i][(d_alignment - p % d_alignment) % d_alignment];
+    }
+
+    set_alignment(multiple);
+    if(!tags)
+      set_tag_propagation_policy(TPP_DONT);
+  }
+
+  bool
+  fused_block::start()
+  {
+    bool ok = true;
+    for(size_t i = 0; i < d_members.size(); i++)
+      ok = d_members[i]->start() && ok;
+    return ok;
+  }
+
+  bool
+  fused_block::stop()
+  {
+    bool ok = true;
+    for(size_t i = 0; i < d_members.size(); i++)
+      ok = d_members[i]->stop() && ok;
+    return ok;
+  }
+
+  int
+  fused_block::work(int noutput_items,
+                    gr_vector_const_void_star &input_items,
+                    gr_vector_void_star &output_items)
+  {
+    const char *in = (const char *)input_items[0];
+    char *out = (char *)output_items[0];
+    size_t insize = input_signature()->sizeof_stream_item(0);
+    size_t last = d_sync.size() - 1;
+
+    for(int done = 0; done < noutput_items; done += d_tile) {
+      int nitems = std::min(d_tile, noutput_items - done);
+
+      d_in[0] = in + done * insize;
+      for(size_t i = 0; i <= last; i++) {
+        if(i == last)
+          d_out[0] = out + done * d_itemsize[i];
+        else
+          d_out[0] = d_tiles[i & 1];
+
+        // The executor would have told the block; we have to.
+        d_sync[i]->set_is_unaligned((size_t)d_in[0] % d_alignment != 0
+                                    || (size_t)d_out[0] % d_alignment != 0);
+
+        if(d_sync[i]->work(nitems, d_in, d_out) != nitems)
+          throw std::runtime_error("fused_block: " + d_sync[i]->name()
+                                   + " returned less than noutput_items");
+        d_in[0] = d_out[0];
+      }
+    }
+
+    return noutput_items;
+  }
+
+} /* namespace gr */
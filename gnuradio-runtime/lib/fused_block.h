@@ -0,0 +1,83 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDED_GR_RUNTIME_FUSED_BLOCK_H
+#define INCLUDED_GR_RUNTIME_FUSED_BLOCK_H
+
+#include <gnuradio/api.h>
+#include <gnuradio/sync_block.h>
+#include <vector>
+
+namespace gr {
+
+  /*!
+   * \brief Runs a chain of fusable sync blocks as one block.
+   * \ingroup internal
+   *
+   * \details
+   * Made by flat_flowgraph::fuse_sync_blocks in place of a chain of
+   * blocks that each have one input and one output and answer true
+   * to sync_block::fusable(). work() takes the items in tiles of a
+   * few kilobytes and pushes each tile through the whole chain,
+   * calling every member's work() directly, so the data between two
+   * members never leaves the cache and no buffers or scheduler
+   * hand-offs are needed in between.
+   *
+   * The members have no block_detail while fused.
+   */
+  class GR_RUNTIME_API fused_block : public sync_block
+  {
+  public:
+    typedef boost::shared_ptr<fused_block> sptr;
+
+    /*!
+     * \param members     the chain, upstream first
+     * \param tile_bytes  largest tile between two members, in bytes
+     */
+    static sptr make(const block_vector_t &members, int tile_bytes);
+
+    //! The blocks this one runs.
+    const block_vector_t &members() const { return d_members; }
+
+    bool start();
+    bool stop();
+
+    int work(int noutput_items,
+             gr_vector_const_void_star &input_items,
+             gr_vector_void_star &output_items);
+
+  private:
+    block_vector_t             d_members;
+    std::vector<sync_block *>  d_sync;      // d_members, as sync blocks
+    std::vector<size_t>        d_itemsize;  // output item size of each member
+    int                        d_tile;      // items per tile
+    std::vector<char>          d_tile_mem[2];
+    void                      *d_tiles[2];  // aligned into d_tile_mem
+    size_t                     d_alignment;
+    gr_vector_const_void_star  d_in;
+    gr_vector_void_star        d_out;
+
+    fused_block(const block_vector_t &members, int tile_bytes);
+  };
+
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_RUNTIME_FUSED_BLOCK_H */
@@ -38,7 +38,8 @@ namespace gr {
   hier_block2_detail::hier_block2_detail(hier_block2 *owner)
     : d_owner(owner),
       d_parent_detail(0),
-      d_fg(make_flowgraph())
+      d_fg(make_flowgraph()),
+      d_flat_valid(false)
   {
     int min_inputs = owner->input_signature()->min_streams();
     int max_inputs = owner->input_signature()->max_streams();
@@ -63,11 +64,28 @@ namespace gr {
     d_owner = 0; // Don't use delete, we didn't allocate
   }
 
+  /*
+   * Our flattened edges resolve through the ports of the
+   * hierarchical blocks inside us, so a change anywhere below also
+   * spoils the parents' results.
+   */
+  void
+  hier_block2_detail::invalidate_flat()
+  {
+    for(hier_block2_detail *d = this; d != 0; d = d->d_parent_detail) {
+      d->d_flat_valid = false;
+      d->d_flat_edges.clear();		// don't keep blocks alive
+      d->d_flat_children.clear();
+    }
+  }
+
   void
   hier_block2_detail::connect(basic_block_sptr block)
   {
     std::stringstream msg;
 
+    invalidate_flat();
+
     // Check if duplicate
     if(std::find(d_blocks.begin(), d_blocks.end(), block) != d_blocks.end()) {
       msg << "Block " << block << " already connected.";
@@ -98,6 +116,8 @@ namespace gr {
   {
     std::stringstream msg;
 
+    invalidate_flat();
+
     if(HIER_BLOCK2_DETAIL_DEBUG)
       std::cout << "connecting: " << endpoint(src, src_port)
                 << " -> " << endpoint(dst, dst_port) << std::endl;
@@ -154,7 +174,9 @@ namespace gr {
   {
     if(HIER_BLOCK2_DETAIL_DEBUG)
       std::cout << "connecting message port..." << std::endl;
-    
+
+    invalidate_flat();
+
     // register the subscription
     // this is done later...
     //  src->message_port_sub(srcport, pmt::cons(dst->alias_pmt(), dstport));
@@ -210,6 +232,8 @@ namespace gr {
   void
   hier_block2_detail::disconnect(basic_block_sptr block)
   {
+    invalidate_flat();
+
     // Check on singleton list
     for(basic_block_viter_t p = d_blocks.begin(); p != d_blocks.end(); p++) {
       if(*p == block) {
@@ -261,6 +285,8 @@ namespace gr {
     if(src.get() == dst.get())
       throw std::invalid_argument("disconnect: source and destination blocks cannot be the same");
 
+    invalidate_flat();
+
     hier_block2_sptr src_block(cast_to_hier_block2_sptr(src));
     hier_block2_sptr dst_block(cast_to_hier_block2_sptr(dst));
 
@@ -434,6 +460,7 @@ namespace gr {
   void
   hier_block2_detail::disconnect_all()
   {
+    invalidate_flat();
     d_fg->clear();
     d_blocks.clear();
 
@@ -479,9 +506,9 @@ namespace gr {
       std::cout << " ** Flattening " << d_owner->name() << std::endl;
 
     // Add my edges to the flow graph, resolving references to actual endpoints
-    edge_vector_t edges = d_fg->edges();
+    const edge_vector_t &edges = d_fg->edges();
     msg_edge_vector_t msg_edges = d_fg->msg_edges();
-    edge_viter_t p;
+    edge_vector_t::const_iterator p;
     msg_edge_viter_t q,u;
 
     // Only run setup_rpc if ControlPort config param is enabled.
@@ -489,44 +516,33 @@ namespace gr {
 
     // For every block (gr::block and gr::hier_block2), set up the RPC
     // interface.
-    for(p = edges.begin(); p != edges.end(); p++) {
+    for(p = edges.begin(); ctrlport_on && p != edges.end(); p++) {
       basic_block_sptr b;
       b = p->src().block();
 
-      if(ctrlport_on) {
-        if(!b->is_rpc_set()) {
-          b->setup_rpc();
-          b->rpc_set();
-        }
+      if(!b->is_rpc_set()) {
+        b->setup_rpc();
+        b->rpc_set();
       }
 
       b = p->dst().block();
-      if(ctrlport_on) {
-        if(!b->is_rpc_set()) {
-          b->setup_rpc();
-          b->rpc_set();
-        }
+      if(!b->is_rpc_set()) {
+        b->setup_rpc();
+        b->rpc_set();
       }
     }
 
+    // Resolve our edges unless nothing changed since the last time.
+    if(!d_flat_valid)
+      flatten_cache();
+
     if(HIER_BLOCK2_DETAIL_DEBUG)
       std::cout << "Flattening stream connections: " << std::endl;
 
-    for(p = edges.begin(); p != edges.end(); p++) {
+    for(edge_viter_t e = d_flat_edges.begin(); e != d_flat_edges.end(); e++) {
       if(HIER_BLOCK2_DETAIL_DEBUG)
-        std::cout << "Flattening edge " << (*p) << std::endl;
-
-      endpoint_vector_t src_endps = resolve_endpoint(p->src(), false);
-      endpoint_vector_t dst_endps = resolve_endpoint(p->dst(), true);
-
-      endpoint_viter_t s, d;
-      for(s = src_endps.begin(); s != src_endps.end(); s++) {
-        for(d = dst_endps.begin(); d != dst_endps.end(); d++) {
-          if(HIER_BLOCK2_DETAIL_DEBUG)
-            std::cout << (*s) << "->" << (*d) << std::endl;
-          sfg->connect(*s, *d);
-        }
-      }
+        std::cout << (*e) << std::endl;
+      sfg->connect(e->src(), e->dst());
     }
 
     // loop through flattening hierarchical connections
@@ -584,6 +600,41 @@ namespace gr {
     }
     */
     
+    // Recurse hierarchical children
+    for(size_t i = 0; i < d_flat_children.size(); i++) {
+      if(HIER_BLOCK2_DETAIL_DEBUG)
+        std::cout << "flatten_aux: recursing into hierarchical block "
+                  << d_flat_children[i] << std::endl;
+      d_flat_children[i]->d_detail->flatten_aux(sfg);
+    }
+  }
+
+  /*
+   * Resolve our stream edges down to leaf blocks and find the
+   * hierarchical blocks inside us, for flatten_aux.
+   */
+  void
+  hier_block2_detail::flatten_cache() const
+  {
+    edge_vector_t flat_edges;
+    edge_vector_t edges = d_fg->edges();
+    for(edge_viter_t p = edges.begin(); p != edges.end(); p++) {
+      if(HIER_BLOCK2_DETAIL_DEBUG)
+        std::cout << "Flattening edge " << (*p) << std::endl;
+
+      endpoint_vector_t src_endps = resolve_endpoint(p->src(), false);
+      endpoint_vector_t dst_endps = resolve_endpoint(p->dst(), true);
+
+      endpoint_viter_t s, d;
+      for(s = src_endps.begin(); s != src_endps.end(); s++) {
+        for(d = dst_endps.begin(); d != dst_endps.end(); d++) {
+          if(HIER_BLOCK2_DETAIL_DEBUG)
+            std::cout << (*s) << "->" << (*d) << std::endl;
+          flat_edges.push_back(edge(*s, *d));
+        }
+      }
+    }
+
     // Construct unique list of blocks used either in edges, inputs,
     // outputs, or by themselves.  I still hate STL.
     basic_block_vector_t blocks; // unique list of used blocks
@@ -621,16 +672,16 @@ namespace gr {
     std::insert_iterator<basic_block_vector_t> inserter(blocks, blocks.begin());
     unique_copy(tmp.begin(), tmp.end(), inserter);
 
-    // Recurse hierarchical children
+    std::vector<hier_block2_sptr> children;
     for(basic_block_viter_t p = blocks.begin(); p != blocks.end(); p++) {
       hier_block2_sptr hier_block2(cast_to_hier_block2_sptr(*p));
-      if(hier_block2 && (hier_block2.get() != d_owner)) {
-        if(HIER_BLOCK2_DETAIL_DEBUG)
-          std::cout << "flatten_aux: recursing into hierarchical block "
-                    << hier_block2 << std::endl;
-        hier_block2->d_detail->flatten_aux(sfg);
-      }
+      if(hier_block2 && (hier_block2.get() != d_owner))
+        children.push_back(hier_block2);
     }
+
+    d_flat_edges.swap(flat_edges);
+    d_flat_children.swap(children);
+    d_flat_valid = true;
   }
 
   void
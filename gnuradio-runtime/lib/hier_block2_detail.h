@@ -67,6 +67,17 @@ namespace gr {
     endpoint_vector_t d_outputs;             // Single internal endpoint per external output
     basic_block_vector_t d_blocks;
 
+    // What flatten_aux() worked out last time: our stream edges with
+    // hierarchical endpoints resolved, and the hierarchical blocks
+    // to recurse into. Good until this block or one inside it is
+    // rewired.
+    mutable bool d_flat_valid;
+    mutable edge_vector_t d_flat_edges;
+    mutable std::vector<hier_block2_sptr> d_flat_children;
+
+    void invalidate_flat();
+    void flatten_cache() const;
+
     void connect_input(int my_port, int port, basic_block_sptr block);
     void connect_output(int my_port, int port, basic_block_sptr block);
     void disconnect_input(int my_port, int port, basic_block_sptr block);
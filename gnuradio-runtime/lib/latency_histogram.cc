@@ -0,0 +1,90 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gnuradio/latency_histogram.h>
+#include <algorithm>
+#include <cmath>
+
+namespace gr {
+
+  latency_histogram::latency_histogram()
+    : d_counts(NBUCKETS, 0), d_count(0), d_max(0)
+  {
+  }
+
+  void
+  latency_histogram::reset()
+  {
+    std::fill(d_counts.begin(), d_counts.end(), 0);
+    d_count = 0;
+    d_max = 0;
+  }
+
+  high_res_timer_type
+  latency_histogram::bucket_low(int b)
+  {
+    int group = b >> SUB_BITS;
+    high_res_timer_type sub = b & ((1 << SUB_BITS) - 1);
+    if(group == 0)
+      return sub;
+    return ((1 << SUB_BITS) + sub) << (group - 1);
+  }
+
+  double
+  latency_histogram::percentile(double p) const
+  {
+    unsigned long n = d_count;
+    if(n == 0)
+      return 0;
+
+    unsigned long target = (unsigned long)ceil(std::min(std::max(p, 0.0), 1.0) * n);
+    target = std::max(target, 1UL);
+
+    unsigned long seen = 0;
+    for(int b = 0; b < NBUCKETS; b++) {
+      seen += d_counts[b];
+      if(seen >= target) {
+        // Report the middle of the bucket, but never more than the
+        // largest value actually seen.
+        int group = b >> SUB_BITS;
+        high_res_timer_type width = group == 0 ? 1 : (high_res_timer_type)1 << (group - 1);
+        double v = bucket_low(b) + (width - 1) / 2.0;
+        return std::min(v, (double)d_max);
+      }
+    }
+    return d_max;
+  }
+
+  std::vector<float>
+  latency_histogram::percentiles() const
+  {
+    std::vector<float> r(3);
+    r[0] = percentile(0.5);
+    r[1] = percentile(0.99);
+    r[2] = percentile(0.999);
+    return r;
+  }
+
+} /* namespace gr */
@@ -0,0 +1,302 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gnuradio/msg_port_queue.h>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace gr {
+
+  /*
+   * The queue is D. Vyukov's bounded MPMC queue: every cell carries a
+   * sequence number that says whose turn it is. A producer may fill
+   * cell i of lap n when its seq == n*size + i, and then sets it to
+   * n*size + i + 1; the consumer empties it and sets it to (n+1)*size
+   * + i, handing it to the producer of the next lap. Claiming a cell
+   * is a single CAS on the enqueue (dequeue) position.
+   *
+   * We only ever have one consumer, the thread running the block, but
+   * a producer using the DROP_OLDEST policy dequeues as well, so we
+   * need the multi-consumer version.
+   *
+   * Under UNBOUNDED, a message that doesn't fit goes to d_overflow,
+   * and so does every message after it until the consumer has taken
+   * them all; the consumer only looks there once the ring is empty.
+   */
+
+  static size_t
+  round_up_pow2(size_t n)
+  {
+    size_t r = 2;
+    while(r < n)
+      r <<= 1;
+    return r;
+  }
+
+  msg_port_queue::msg_port_queue(size_t capacity, policy_t policy, long *pending,
+                                 const std::string &name)
+    : d_cells(round_up_pow2(capacity)),
+      d_mask(d_cells.size() - 1),
+      d_policy(policy),
+      d_pending(pending),
+      d_enqueue_pos(0),
+      d_dequeue_pos(0),
+      d_ndropped(0),
+      d_nrejected(0),
+      d_name(name),
+      d_nwaiting_consumers(0),
+      d_nwaiting_producers(0),
+      d_noverflow(0)
+  {
+    for(size_t i = 0; i < d_cells.size(); i++)
+      d_cells[i].seq = i;
+  }
+
+  msg_port_queue::~msg_port_queue()
+  {
+    // Keep the owner's count right if we are destroyed non-empty.
+    pmt::pmt_t m;
+    while(try_pop(m))
+      ;
+    gr::thread::scoped_lock guard(d_mutex);
+    while(pop_overflow(m))
+      ;
+  }
+
+  msg_port_queue::policy_t
+  msg_port_queue::policy_from_string(const std::string &name)
+  {
+    if(name == "unbounded")
+      return UNBOUNDED;
+    if(name == "block")
+      return BLOCK;
+    if(name == "drop_oldest")
+      return DROP_OLDEST;
+    if(name == "drop_newest")
+      return DROP_NEWEST;
+    if(name == "reject")
+      return REJECT;
+    throw std::invalid_argument("msg_port_queue: unknown policy \"" + name + "\"");
+  }
+
+  bool
+  msg_port_queue::try_push(const pmt::pmt_t &msg)
+  {
+    size_t pos = gr::thread::atomic_load_acquire(&d_enqueue_pos);
+    cell *c;
+    while(1) {
+      c = &d_cells[pos & d_mask];
+      size_t seq = gr::thread::atomic_load_acquire(&c->seq);
+      long diff = (long)(seq - pos);
+      if(diff == 0) {
+        if(gr::thread::atomic_compare_exchange(&d_enqueue_pos, pos, pos + 1))
+          break;
+        pos = gr::thread::atomic_load_acquire(&d_enqueue_pos);
+      }
+      else if(diff < 0) {
+        return false;                   // full
+      }
+      else {
+        pos = gr::thread::atomic_load_acquire(&d_enqueue_pos);
+      }
+    }
+
+    // Count the message before it becomes visible so the owner's
+    // count is never below the real number of messages.
+    if(d_pending)
+      gr::thread::atomic_fetch_add(d_pending, 1L);
+
+    c->msg = msg;
+    gr::thread::atomic_store_release(&c->seq, pos + 1);
+    return true;
+  }
+
+  bool
+  msg_port_queue::try_pop(pmt::pmt_t &msg)
+  {
+    size_t pos = gr::thread::atomic_load_acquire(&d_dequeue_pos);
+    cell *c;
+    while(1) {
+      c = &d_cells[pos & d_mask];
+      size_t seq = gr::thread::atomic_load_acquire(&c->seq);
+      long diff = (long)(seq - (pos + 1));
+      if(diff == 0) {
+        if(gr::thread::atomic_compare_exchange(&d_dequeue_pos, pos, pos + 1))
+          break;
+        pos = gr::thread::atomic_load_acquire(&d_dequeue_pos);
+      }
+      else if(diff < 0) {
+        return false;                   // empty
+      }
+      else {
+        pos = gr::thread::atomic_load_acquire(&d_dequeue_pos);
+      }
+    }
+
+    msg = c->msg;
+    c->msg = pmt::pmt_t();              // don't hold on to the reference
+    gr::thread::atomic_store_release(&c->seq, pos + d_mask + 1);
+
+    if(d_pending)
+      gr::thread::atomic_fetch_add(d_pending, -1L);
+    return true;
+  }
+
+  // Caller holds d_mutex.
+  bool
+  msg_port_queue::pop_overflow(pmt::pmt_t &msg)
+  {
+    if(d_overflow.empty())
+      return false;
+
+    msg = d_overflow.front();
+    d_overflow.pop_front();
+    gr::thread::atomic_fetch_add(&d_noverflow, -1L);
+    if(d_pending)
+      gr::thread::atomic_fetch_add(d_pending, -1L);
+    return true;
+  }
+
+  /*
+   * Losing messages is easy to miss, so say so the first time.
+   */
+  void
+  msg_port_queue::count_discard(long *counter)
+  {
+    if(gr::thread::atomic_fetch_add(counter, 1L) == 0)
+      std::cerr << "msg_port_queue: warning: " << (d_name.empty() ? "queue" : d_name)
+                << " is full, " << (counter == &d_nrejected ? "refusing" : "dropping")
+                << " messages" << std::endl;
+  }
+
+  /*
+   * Wake threads sleeping on cond, if there are any. The fetch_add
+   * is a full barrier: either the sleeper sees the cell we just
+   * changed, or we see that it is sleeping.
+   */
+  void
+  msg_port_queue::wake(long *nwaiting, gr::thread::condition_variable &cond)
+  {
+    if(gr::thread::atomic_fetch_add(nwaiting, 0L) > 0) {
+      gr::thread::scoped_lock guard(d_mutex);
+      cond.notify_all();
+    }
+  }
+
+  bool
+  msg_port_queue::insert_tail(const pmt::pmt_t &msg)
+  {
+    if(d_policy == UNBOUNDED) {
+      if(gr::thread::atomic_load_acquire(&d_noverflow) > 0 || !try_push(msg)) {
+        gr::thread::scoped_lock guard(d_mutex);
+        if(d_pending)
+          gr::thread::atomic_fetch_add(d_pending, 1L);
+        d_overflow.push_back(msg);
+        gr::thread::atomic_fetch_add(&d_noverflow, 1L);
+      }
+    }
+    else if(!try_push(msg)) {
+      switch(d_policy) {
+      case BLOCK:
+        {
+          gr::thread::scoped_lock guard(d_mutex);
+          gr::thread::atomic_fetch_add(&d_nwaiting_producers, 1L);
+          while(!try_push(msg))
+            d_not_full.wait(guard);
+          gr::thread::atomic_fetch_add(&d_nwaiting_producers, -1L);
+        }
+        break;
+
+      case DROP_OLDEST:
+        {
+          pmt::pmt_t old;
+          do {
+            if(try_pop(old))
+              count_discard(&d_ndropped);
+          } while(!try_push(msg));
+        }
+        break;
+
+      case DROP_NEWEST:
+        count_discard(&d_ndropped);
+        return true;
+
+      case REJECT:
+        count_discard(&d_nrejected);
+        return false;
+
+      case UNBOUNDED:
+        break;
+      }
+    }
+
+    wake(&d_nwaiting_consumers, d_not_empty);
+    return true;
+  }
+
+  pmt::pmt_t
+  msg_port_queue::delete_head_nowait()
+  {
+    pmt::pmt_t m;
+    if(try_pop(m)) {
+      if(d_policy == BLOCK)
+        wake(&d_nwaiting_producers, d_not_full);
+    }
+    else if(gr::thread::atomic_load_acquire(&d_noverflow) > 0) {
+      gr::thread::scoped_lock guard(d_mutex);
+      pop_overflow(m);
+    }
+    return m;
+  }
+
+  pmt::pmt_t
+  msg_port_queue::delete_head_blocking()
+  {
+    pmt::pmt_t m;
+    if(!try_pop(m)) {
+      gr::thread::scoped_lock guard(d_mutex);
+      gr::thread::atomic_fetch_add(&d_nwaiting_consumers, 1L);
+      while(!try_pop(m) && !pop_overflow(m))
+        d_not_empty.wait(guard);
+      gr::thread::atomic_fetch_add(&d_nwaiting_consumers, -1L);
+    }
+    if(d_policy == BLOCK)
+      wake(&d_nwaiting_producers, d_not_full);
+    return m;
+  }
+
+  size_t
+  msg_port_queue::nmsgs() const
+  {
+    size_t deq = gr::thread::atomic_load_acquire(&d_dequeue_pos);
+    size_t enq = gr::thread::atomic_load_acquire(&d_enqueue_pos);
+    size_t n = static_cast<size_t>(gr::thread::atomic_load_acquire(&d_noverflow));
+    if(enq <= deq)
+      return n;
+    return n + std::min(enq - deq, d_mask + 1);
+  }
+
+} /* namespace gr */
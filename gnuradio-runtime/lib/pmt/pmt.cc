@@ -29,31 +29,77 @@
 #include "pmt_int.h"
 #include <gnuradio/messages/msg_accepter.h>
 #include <pmt/pmt_pool.h>
+#include <gnuradio/thread/atomic.h>
+#include <boost/thread/mutex.hpp>
 #include <stdio.h>
 #include <string.h>
+#include <new>
 
 namespace pmt {
 
-static const int CACHE_LINE_SIZE = 64;		// good guess
-
 # if (PMT_LOCAL_ALLOCATOR)
 
-static pmt_pool global_pmt_pool(sizeof(pmt_pair), CACHE_LINE_SIZE);
+/*
+ * Small PMT objects (integers, uint64s, pairs, uniform vector headers,
+ * ...) come from one of two size-class pools; anything bigger goes to
+ * the global heap. The pools are never destroyed, since PMTs with
+ * static storage duration may be released after they would have been.
+ */
+static const size_t SMALL_OBJECT_SIZE = 32;
+static const size_t LARGE_OBJECT_SIZE = 64;
+
+static pmt_pool &
+small_object_pool()
+{
+  static pmt_pool *pool = new pmt_pool(SMALL_OBJECT_SIZE, 16);
+  return *pool;
+}
+
+static pmt_pool &
+large_object_pool()
+{
+  static pmt_pool *pool = new pmt_pool(LARGE_OBJECT_SIZE, 16);
+  return *pool;
+}
 
 void *
 pmt_base::operator new(size_t size)
 {
-  void *p = global_pmt_pool.malloc();
-
-  // fprintf(stderr, "pmt_base::new p = %p\n", p);
-  assert((reinterpret_cast<intptr_t>(p) & (CACHE_LINE_SIZE - 1)) == 0);
-  return p;
+  if (size <= SMALL_OBJECT_SIZE)
+    return small_object_pool().malloc();
+  if (size <= LARGE_OBJECT_SIZE)
+    return large_object_pool().malloc();
+  return ::operator new(size);
 }
 
 void
 pmt_base::operator delete(void *p, size_t size)
 {
-  global_pmt_pool.free(p);
+  if (size <= SMALL_OBJECT_SIZE)
+    small_object_pool().free(p);
+  else if (size <= LARGE_OBJECT_SIZE)
+    large_object_pool().free(p);
+  else
+    ::operator delete(p);
+}
+
+void
+object_pool_counts(size_t &nhits, size_t &nmisses)
+{
+  size_t h, m;
+  small_object_pool().counts(nhits, nmisses);
+  large_object_pool().counts(h, m);
+  nhits += h;
+  nmisses += m;
+}
+
+#else
+
+void
+object_pool_counts(size_t &nhits, size_t &nmisses)
+{
+  nhits = 0;
+  nmisses = 0;
 }
 
 #endif
@@ -142,6 +188,12 @@ _tuple(pmt_t x)
   return dynamic_cast<pmt_tuple*>(x.get());
 }
 
+static pmt_dict *
+_dict(pmt_t x)
+{
+  return dynamic_cast<pmt_dict*>(x.get());
+}
+
 static pmt_uniform_vector *
 _uniform_vector(pmt_t x)
 {
@@ -207,8 +259,46 @@ to_bool(pmt_t val)
 //                             Symbols
 ////////////////////////////////////////////////////////////////////////////
 
+/*
+ * Symbols are interned in a chained hash table that is shared by all
+ * threads. Lookups of existing symbols take no locks: the table and
+ * its chains are only ever extended by publishing fully built nodes
+ * with a release store, and nodes are never modified or freed once
+ * published. Adding a new symbol (which happens once per name) is
+ * serialized by a mutex.
+ *
+ * When the table gets too full, a bigger one is built beside it and
+ * published in its place. The old table is kept around, since
+ * readers may still be walking it; it still holds every symbol it
+ * ever had, so at worst a reader on it misses a brand new symbol and
+ * falls back to the locked path.
+ */
+
 static const unsigned int SYMBOL_HASH_TABLE_SIZE = 701;
-static std::vector<pmt_t> s_symbol_hash_table(SYMBOL_HASH_TABLE_SIZE);
+
+namespace {
+  struct symbol_node {
+    unsigned int  hash;
+    pmt_t         sym;
+    symbol_node  *next;
+  };
+
+  struct symbol_table {
+    unsigned int  nbuckets;
+    symbol_node **buckets;
+    symbol_table *prev;         // retired table, kept alive for readers
+  };
+}
+
+static symbol_table *s_symbol_table = 0;
+static unsigned int  s_nsymbols = 0;    // protected by symbol_table_mutex()
+
+static boost::mutex &
+symbol_table_mutex()
+{
+  static boost::mutex mutex;
+  return mutex;
+}
 
 pmt_symbol::pmt_symbol(const std::string &name) : d_name(name){}
 
@@ -236,22 +326,85 @@ is_symbol(const pmt_t& obj)
   return obj->is_symbol();
 }
 
+static symbol_node *
+symbol_lookup(symbol_table *t, unsigned int hash, const std::string &name)
+{
+  symbol_node *n = gr::thread::atomic_load_acquire(&t->buckets[hash % t->nbuckets]);
+  for (; n; n = n->next){
+    if (n->hash == hash && name == _symbol(n->sym)->name())
+      return n;
+  }
+  return 0;
+}
+
+static void
+symbol_insert(symbol_table *t, symbol_node *n)
+{
+  symbol_node **head = &t->buckets[n->hash % t->nbuckets];
+  n->next = *head;
+  gr::thread::atomic_store_release(head, n);
+}
+
+/*
+ * Replace the current table with one about twice as big.
+ * Called with symbol_table_mutex() held.
+ */
+static symbol_table *
+symbol_table_grow(symbol_table *old)
+{
+  symbol_table *t = new symbol_table;
+  t->nbuckets = old ? 2 * old->nbuckets + 1 : SYMBOL_HASH_TABLE_SIZE;
+  t->buckets = new symbol_node*[t->nbuckets]();
+  t->prev = old;
+
+  if (old){
+    for (unsigned int i = 0; i < old->nbuckets; i++){
+      for (symbol_node *o = old->buckets[i]; o; o = o->next){
+        symbol_node *n = new symbol_node;
+        n->hash = o->hash;
+        n->sym = o->sym;
+        symbol_insert(t, n);
+      }
+    }
+  }
+
+  gr::thread::atomic_store_release(&s_symbol_table, t);
+  return t;
+}
+
 pmt_t
 string_to_symbol(const std::string &name)
 {
-  unsigned hash = hash_string(name) % SYMBOL_HASH_TABLE_SIZE;
+  unsigned int hash = hash_string(name);
 
   // Does a symbol with this name already exist?
-  for (pmt_t sym = s_symbol_hash_table[hash]; sym; sym = _symbol(sym)->next()){
-    if (name == _symbol(sym)->name())
-      return sym;		// Yes.  Return it
+  symbol_table *t = gr::thread::atomic_load_acquire(&s_symbol_table);
+  if (t){
+    symbol_node *n = symbol_lookup(t, hash, name);
+    if (n)
+      return n->sym;		// Yes.  Return it
+  }
+
+  // Nope.  Check again under the lock, since somebody else may have
+  // just added it, and make a new one if not.
+  boost::mutex::scoped_lock guard(symbol_table_mutex());
+
+  t = s_symbol_table;
+  if (t){
+    symbol_node *n = symbol_lookup(t, hash, name);
+    if (n)
+      return n->sym;
   }
 
-  // Nope.  Make a new one.
-  pmt_t sym = pmt_t(new pmt_symbol(name));
-  _symbol(sym)->set_next(s_symbol_hash_table[hash]);
-  s_symbol_hash_table[hash] = sym;
-  return sym;
+  if (t == 0 || s_nsymbols >= t->nbuckets)
+    t = symbol_table_grow(t);
+
+  symbol_node *n = new symbol_node;
+  n->hash = hash;
+  n->sym = pmt_t(new pmt_symbol(name));
+  symbol_insert(t, n);
+  s_nsymbols++;
+  return n->sym;
 }
 
 // alias...
@@ -776,57 +929,286 @@ uniform_vector_writable_elements(pmt_t vector, size_t &len)
   return _uniform_vector(vector)->uniform_writable_elements(len);
 }
 
+pmt_t
+uniform_vector_slice(pmt_t vector, size_t start, size_t k)
+{
+  if (!vector->is_uniform_vector())
+    throw wrong_type("pmt_uniform_vector_slice", vector);
+  return _uniform_vector(vector)->slice(start, k);
+}
+
+////////////////////////////////////////////////////////////////////////////
+//                            Memory blocks
+////////////////////////////////////////////////////////////////////////////
+
+void intrusive_ptr_add_ref(memory_block* p) { ++(p->count_); }
+
+void
+intrusive_ptr_release(memory_block* p)
+{
+  if (--(p->count_) == 0){
+    p->~memory_block();
+    delete [] (char *) p;
+  }
+}
+
+memory_block_t
+make_memory_block(size_t nbytes, size_t alignment)
+{
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    throw out_of_range("pmt_make_memory_block alignment", from_long(alignment));
+
+  // One allocation holds the header followed by the aligned data
+  char *raw = new char[sizeof(memory_block) + alignment - 1 + nbytes];
+  uintptr_t data = (uintptr_t)(raw + sizeof(memory_block));
+  data = (data + alignment - 1) & ~(uintptr_t)(alignment - 1);
+  return memory_block_t(new (raw) memory_block((void *) data, nbytes));
+}
+
+void *
+memory_block_data(memory_block_t mem)
+{
+  return mem->d_data;
+}
+
+size_t
+memory_block_size(memory_block_t mem)
+{
+  return mem->d_size;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 //                            Dictionaries
 ////////////////////////////////////////////////////////////////////////////
 
 /*
- * This is an a-list implementation.
+ * Dictionaries are persistent: dict_add and dict_delete return a new
+ * dictionary and leave their argument alone. Dictionaries built by
+ * older code (and by deserialize) are a-lists, which are still
+ * accepted everywhere; dict_items turns a pmt_dict into the a-list it
+ * is equivalent to, most recently added key first.
  *
- * When we need better performance for large dictionaries, consider implementing
- * persistent Red-Black trees as described in "Purely Functional Data Structures",
- * Chris Okasaki, 1998, section 3.3.
+ * A pmt_dict is a (table, version) pair. The table is a hash table
+ * keyed by eqv that keeps the history of every key, plus a log of the
+ * changes in the order they were made. A version sees the changes
+ * made up to and including it. Adding to the newest version of a
+ * table just appends to it, so the usual d = dict_add(d, k, v)
+ * pattern is O(1). Adding to an older version (somebody else already
+ * extended it), or to a table that has piled up too much history,
+ * first copies what that version sees into a new table.
  */
 
+namespace {
+  struct dict_change {
+    size_t  version;
+    bool    present;            // false if the key was deleted
+    pmt_t   value;
+  };
+
+  struct dict_slot {
+    pmt_t                     key;
+    size_t                    hash;
+    std::vector<dict_change>  history;  // oldest first
+  };
+
+  struct dict_log_entry {
+    size_t  slot;
+    size_t  change;             // index into the slot's history
+  };
+}
+
+class pmt_dict_data {
+public:
+  boost::mutex                  d_mutex;
+  std::vector<dict_slot>        d_slots;
+  std::vector<long>             d_index;  // open addressing, -1 is empty
+  std::vector<dict_log_entry>   d_log;    // d_log[i] made version i+1
+  size_t                        d_latest;
+
+  pmt_dict_data() : d_index(16, -1), d_latest(0) {}
+};
+
+pmt_dict::pmt_dict(boost::shared_ptr<pmt_dict_data> data, size_t version, size_t size)
+  : d_data(data), d_version(version), d_size(size) {}
+
+static size_t
+dict_hash(const pmt_t &key)
+{
+  // Must agree with eqv
+  if (key->is_integer())
+    return (size_t) _integer(key)->value();
+  if (key->is_uint64())
+    return (size_t) _uint64(key)->value();
+  if (key->is_real() || key->is_complex()){
+    std::complex<double> c = key->is_real()
+      ? std::complex<double>(_real(key)->value(), 0)
+      : _complex(key)->value();
+    double parts[2] = { c.real() + 0.0, c.imag() + 0.0 };   // -0.0 == 0.0
+    size_t h = 0;
+    const unsigned char *p = (const unsigned char *) parts;
+    for (size_t i = 0; i < sizeof(parts); i++)
+      h = h * 31 + p[i];
+    return h;
+  }
+  return (size_t) key.get() >> 4;
+}
+
+static long
+dict_find_slot(pmt_dict_data *t, const pmt_t &key, size_t hash)
+{
+  size_t mask = t->d_index.size() - 1;
+  for (size_t i = hash & mask; t->d_index[i] >= 0; i = (i + 1) & mask){
+    dict_slot &s = t->d_slots[t->d_index[i]];
+    if (s.hash == hash && eqv(s.key, key))
+      return t->d_index[i];
+  }
+  return -1;
+}
+
+static size_t
+dict_new_slot(pmt_dict_data *t, const pmt_t &key, size_t hash)
+{
+  t->d_slots.push_back(dict_slot());
+  t->d_slots.back().key = key;
+  t->d_slots.back().hash = hash;
+  size_t n = t->d_slots.size() - 1;
+
+  // Keep the index at most half full
+  if (2 * t->d_slots.size() > t->d_index.size()){
+    t->d_index.assign(2 * t->d_index.size(), -1);
+    for (size_t k = 0; k < n; k++){
+      size_t mask = t->d_index.size() - 1;
+      size_t i = t->d_slots[k].hash & mask;
+      while (t->d_index[i] >= 0)
+        i = (i + 1) & mask;
+      t->d_index[i] = k;
+    }
+  }
+
+  size_t mask = t->d_index.size() - 1;
+  size_t i = hash & mask;
+  while (t->d_index[i] >= 0)
+    i = (i + 1) & mask;
+  t->d_index[i] = n;
+  return n;
+}
+
+// The change to slot s that is visible in version v, if any.
+static const dict_change *
+dict_visible(pmt_dict_data *t, size_t s, size_t v)
+{
+  const std::vector<dict_change> &h = t->d_slots[s].history;
+  for (size_t i = h.size(); i > 0; i--){
+    if (h[i-1].version <= v)
+      return &h[i-1];
+  }
+  return 0;
+}
+
+static const dict_change *
+dict_lookup(pmt_dict *d, const pmt_t &key)
+{
+  pmt_dict_data *t = d->d_data.get();
+  long s = dict_find_slot(t, key, dict_hash(key));
+  if (s < 0)
+    return 0;
+  const dict_change *c = dict_visible(t, s, d->d_version);
+  return (c && c->present) ? c : 0;
+}
+
+static pmt_t
+dict_from_alist(pmt_t alist)
+{
+  // Add from the back so that the front of the a-list ends up newest.
+  pmt_t dict = make_dict();
+  for (pmt_t p = reverse(alist); is_pair(p); p = cdr(p))
+    dict = dict_add(dict, caar(p), cdar(p));
+  return dict;
+}
+
+/*
+ * Return a dictionary like \p dict but with \p key set to \p value,
+ * or removed if \p present is false.
+ */
+static pmt_t
+dict_change_key(const pmt_t &dict, const pmt_t &key, bool present, const pmt_t &value)
+{
+  if (!dict->is_dict()){
+    if (!is_dict(dict))
+      throw wrong_type("pmt_dict_add", dict);
+    return dict_change_key(dict_from_alist(dict), key, present, value);
+  }
+
+  pmt_dict *d = _dict(dict);
+  pmt_dict_data *t = d->d_data.get();
+  {
+    boost::mutex::scoped_lock guard(t->d_mutex);
+
+    if (d->d_version == t->d_latest && t->d_log.size() <= 2 * d->d_size + 16){
+      size_t hash = dict_hash(key);
+      long s = dict_find_slot(t, key, hash);
+      const dict_change *c = s < 0 ? 0 : dict_visible(t, s, d->d_version);
+      bool had = c && c->present;
+      if (!present && !had)
+        return dict;
+      if (s < 0)
+        s = dict_new_slot(t, key, hash);
+
+      dict_change change;
+      change.version = ++t->d_latest;
+      change.present = present;
+      change.value = value;
+      t->d_slots[s].history.push_back(change);
+
+      dict_log_entry e;
+      e.slot = s;
+      e.change = t->d_slots[s].history.size() - 1;
+      t->d_log.push_back(e);
+
+      size_t size = d->d_size + (present ? 1 : 0) - (had ? 1 : 0);
+      return pmt_t(new pmt_dict(d->d_data, t->d_latest, size));
+    }
+  }
+
+  // Start over with a fresh table holding just what this version sees.
+  return dict_change_key(dict_from_alist(dict_items(dict)), key, present, value);
+}
+
 bool
 is_dict(const pmt_t &obj)
 {
-  return is_null(obj) || is_pair(obj);
+  return obj->is_dict() || is_null(obj) || is_pair(obj);
 }
 
 pmt_t
 make_dict()
 {
-  return PMT_NIL;
+  boost::shared_ptr<pmt_dict_data> data(new pmt_dict_data());
+  return pmt_t(new pmt_dict(data, 0, 0));
 }
 
 pmt_t
 dict_add(const pmt_t &dict, const pmt_t &key, const pmt_t &value)
 {
-  if (is_null(dict))
-    return acons(key, value, PMT_NIL);
-
-  if (dict_has_key(dict, key))
-    return acons(key, value, dict_delete(dict, key));
-
-  return acons(key, value, dict);
+  return dict_change_key(dict, key, true, value);
 }
 
 pmt_t
 dict_delete(const pmt_t &dict, const pmt_t &key)
 {
-  if (is_null(dict))
-    return dict;
-
-  if (eqv(caar(dict), key))
-    return cdr(dict);
-
-  return cons(car(dict), dict_delete(cdr(dict), key));
+  return dict_change_key(dict, key, false, PMT_NIL);
 }
 
 pmt_t
 dict_ref(const pmt_t &dict, const pmt_t &key, const pmt_t &not_found)
 {
+  if (dict->is_dict()){
+    pmt_dict *d = _dict(dict);
+    boost::mutex::scoped_lock guard(d->d_data->d_mutex);
+    const dict_change *c = dict_lookup(d, key);
+    return c ? c->value : not_found;
+  }
+
   pmt_t	p = assv(key, dict);	// look for (key . value) pair
   if (is_pair(p))
     return cdr(p);
@@ -837,6 +1219,12 @@ dict_ref(const pmt_t &dict, const pmt_t &key, const pmt_t &not_found)
 bool
 dict_has_key(const pmt_t &dict, const pmt_t &key)
 {
+  if (dict->is_dict()){
+    pmt_dict *d = _dict(dict);
+    boost::mutex::scoped_lock guard(d->d_data->d_mutex);
+    return dict_lookup(d, key) != 0;
+  }
+
   return is_pair(assv(key, dict));
 }
 
@@ -846,7 +1234,32 @@ dict_items(pmt_t dict)
   if (!is_dict(dict))
     throw wrong_type("pmt_dict_values", dict);
 
-  return dict;		// equivalent to dict in the a-list case
+  if (!dict->is_dict())
+    return dict;		// already an a-list
+
+  // Walk the log back from our version; the first change we see to
+  // each key is the one this version sees.
+  pmt_dict *d = _dict(dict);
+  pmt_dict_data *t = d->d_data.get();
+  boost::mutex::scoped_lock guard(t->d_mutex);
+
+  std::vector<bool> seen(t->d_slots.size(), false);
+  std::vector<pmt_t> items;
+  items.reserve(d->d_size);
+  for (size_t v = d->d_version; v > 0; v--){
+    const dict_log_entry &e = t->d_log[v-1];
+    if (seen[e.slot])
+      continue;
+    seen[e.slot] = true;
+    const dict_change &c = t->d_slots[e.slot].history[e.change];
+    if (c.present)
+      items.push_back(cons(t->d_slots[e.slot].key, c.value));
+  }
+
+  pmt_t alist = PMT_NIL;
+  for (size_t i = items.size(); i > 0; i--)
+    alist = cons(items[i-1], alist);
+  return alist;
 }
 
 pmt_t
@@ -855,7 +1268,7 @@ dict_keys(pmt_t dict)
   if (!is_dict(dict))
     throw wrong_type("pmt_dict_keys", dict);
 
-  return map(car, dict);
+  return map(car, dict_items(dict));
 }
 
 pmt_t
@@ -864,7 +1277,7 @@ dict_values(pmt_t dict)
   if (!is_dict(dict))
     throw wrong_type("pmt_dict_keys", dict);
 
-  return map(cdr, dict);
+  return map(cdr, dict_items(dict));
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -1070,6 +1483,10 @@ equal(const pmt_t& x, const pmt_t& y)
     return true;
   }
 
+  // A dictionary is equal to the a-list it is equivalent to
+  if ((x->is_dict() || y->is_dict()) && is_dict(x) && is_dict(y))
+    return equal(dict_items(x), dict_items(y));
+
   // FIXME add other cases here...
 
   return false;
@@ -1104,7 +1521,8 @@ length(const pmt_t& x)
     throw wrong_type("pmt_length", x);
   }
 
-  // FIXME dictionary length (number of entries)
+  if (x->is_dict())
+    return _dict(x)->d_size;
 
   throw wrong_type("pmt_length", x);
 }
@@ -25,6 +25,7 @@
 #include <pmt/pmt.h>
 #include <boost/utility.hpp>
 #include <boost/detail/atomic_count.hpp>
+#include <boost/shared_ptr.hpp>
 
 /*
  * EVERYTHING IN THIS FILE IS PRIVATE TO THE IMPLEMENTATION!
@@ -32,7 +33,7 @@
  * See pmt.h for the public interface
  */
 
-#define PMT_LOCAL_ALLOCATOR 0		// define to 0 or 1
+#define PMT_LOCAL_ALLOCATOR 1		// define to 0 or 1
 namespace pmt {
 
 class PMT_API pmt_base : boost::noncopyable {
@@ -93,17 +94,13 @@ public:
 class pmt_symbol : public pmt_base
 {
   std::string	d_name;
-  pmt_t		d_next;
 
 public:
   pmt_symbol(const std::string &name);
   //~pmt_symbol(){}
 
   bool is_symbol() const { return true; }
-  const std::string name() { return d_name; }
-
-  pmt_t next() { return d_next; }		// symbol table link
-  void set_next(pmt_t next) { d_next = next; }
+  const std::string &name() const { return d_name; }
 };
 
 class pmt_integer : public pmt_base
@@ -217,6 +214,25 @@ public:
   void _set(size_t k, pmt_t v) { d_v[k] = v; }
 };
 
+class pmt_dict_data;
+
+/*
+ * A dictionary is a version of a hash table that may be shared with
+ * other versions (see pmt.cc). The object itself is immutable.
+ */
+class pmt_dict : public pmt_base
+{
+public:
+  boost::shared_ptr<pmt_dict_data> d_data;
+  size_t			   d_version;
+  size_t			   d_size;	// number of entries
+
+  pmt_dict(boost::shared_ptr<pmt_dict_data> data, size_t version, size_t size);
+  //~pmt_dict(){}
+
+  bool is_dict() const { return true; }
+};
+
 class pmt_any : public pmt_base
 {
   boost::any	d_any;
@@ -231,6 +247,24 @@ public:
 };
 
 
+/*
+ * Header of a memory block; the (aligned) data follows it in the
+ * same allocation.
+ */
+class memory_block : boost::noncopyable
+{
+  mutable boost::detail::atomic_count count_;
+
+public:
+  void		*d_data;
+  size_t	 d_size;
+
+  memory_block(void *data, size_t size) : count_(0), d_data(data), d_size(size) {}
+
+  friend void intrusive_ptr_add_ref(memory_block* p);
+  friend void intrusive_ptr_release(memory_block* p);
+};
+
 class pmt_uniform_vector : public pmt_base
 {
 public:
@@ -238,6 +272,7 @@ public:
   virtual const void *uniform_elements(size_t &len) = 0;
   virtual void *uniform_writable_elements(size_t &len) = 0;
   virtual size_t length() const = 0;
+  virtual pmt_t slice(size_t start, size_t k) = 0;
 };
 
 #include "pmt_unv_int.h"
@@ -35,63 +35,235 @@ ROUNDUP(size_t x, size_t stride)
   return ((((x) + (stride) - 1)/(stride)) * (stride));
 }
 
+// Items moved between a thread's cache and the shared free list at a
+// time, and the most a cache holds before giving some back.
+static const size_t MAGAZINE_BATCH = 32;
+static const size_t MAGAZINE_MAX = 2 * MAGAZINE_BATCH;
+
+/*
+ * Guards the d_pool of every cache, so that a thread exiting and its
+ * pool being destroyed don't race. Never destroyed itself: threads
+ * may exit after static destructors have run.
+ */
+static boost::mutex &
+detach_mutex()
+{
+  static boost::mutex *m = new boost::mutex;
+  return *m;
+}
+
+static unsigned long
+next_generation()
+{
+  static unsigned long generation = 0;
+  boost::unique_lock<boost::mutex> guard(detach_mutex());
+  return ++generation;
+}
+
 pmt_pool::pmt_pool(size_t itemsize, size_t alignment,
 		   size_t allocation_size, size_t max_items)
   : d_itemsize(ROUNDUP(itemsize, alignment)),
     d_alignment(alignment),
     d_allocation_size(std::max(allocation_size, 16 * itemsize)),
     d_max_items(max_items), d_n_items(0),
-    d_freelist(0)
+    d_freelist(0), d_hits(0), d_misses(0),
+    d_generation(next_generation()),
+    d_cache(&pmt_pool::cleanup)
 {
 }
 
 pmt_pool::~pmt_pool()
 {
+  // This thread's cache goes now. Other threads' caches are deleted
+  // when those threads exit; cut them loose from the pool first.
+  magazine *mine = d_cache.release();
+  {
+    scoped_lock guard(detach_mutex());
+    for (size_t i = 0; i < d_magazines.size(); i++){
+      if (d_magazines[i] != mine)
+	d_magazines[i]->d_pool = 0;
+    }
+  }
+  delete mine;
+
   for (unsigned int i = 0; i < d_allocations.size(); i++){
     delete [] d_allocations[i];
   }
 }
 
-void *
-pmt_pool::malloc()
+/*
+ * Take up to n items off the free list, allocating a new chunk if it
+ * is empty. Called with d_mutex held.
+ */
+pmt_pool::item *
+pmt_pool::grab(size_t n, size_t &ngot)
+{
+  if (!d_freelist){
+    // allocate a new chunk
+    char *alloc = new char[d_allocation_size + d_alignment - 1];
+    d_allocations.push_back(alloc);
+
+    // get the alignment we require
+    char *start = (char *)(((uintptr_t)alloc + d_alignment-1) & -d_alignment);
+    char *end = alloc + d_allocation_size + d_alignment - 1;
+    size_t nnew = (end - start) / d_itemsize;
+
+    // link the new items onto the free list.
+    item *p = (item *) start;
+    for (size_t i = 0; i < nnew; i++){
+      p->d_next = d_freelist;
+      d_freelist = p;
+      p = (item *)((char *) p + d_itemsize);
+    }
+  }
+
+  item *head = d_freelist;
+  item *tail = head;
+  ngot = 1;
+  while (ngot < n && tail->d_next){
+    tail = tail->d_next;
+    ngot++;
+  }
+  d_freelist = tail->d_next;
+  tail->d_next = 0;
+  d_n_items += ngot;
+  return head;
+}
+
+/*
+ * Put the list head..tail of n items back on the free list.
+ */
+void
+pmt_pool::release(item *head, item *tail, size_t n, size_t hits)
 {
   scoped_lock guard(d_mutex);
-  item *p;
+  tail->d_next = d_freelist;
+  d_freelist = head;
+  d_n_items -= n;
+  d_hits += hits;
+  if (d_max_items != 0)
+    d_cond.notify_one();
+}
 
-  if (d_max_items != 0){
-    while (d_n_items >= d_max_items)
-      d_cond.wait(guard);
+pmt_pool::magazine *
+pmt_pool::cache()
+{
+  magazine *m = d_cache.get();
+  if (m && m->d_generation != d_generation){
+    // Left over from a pool that used to live at this address. Its
+    // destructor cut the cache loose, so cleanup just deletes it.
+    d_cache.reset();
+    m = 0;
   }
+  if (!m){
+    m = new magazine;
+    m->d_pool = this;
+    m->d_generation = d_generation;
+    m->d_items = 0;
+    m->d_n_items = 0;
+    m->d_hits = 0;
+    d_cache.reset(m);
 
-  if (d_freelist){	// got something?
-    p = d_freelist;
-    d_freelist = p->d_next;
-    d_n_items++;
-    return p;
+    scoped_lock guard(d_mutex);
+    d_magazines.push_back(m);
+  }
+  return m;
+}
+
+void
+pmt_pool::refill(magazine *m)
+{
+  scoped_lock guard(d_mutex);
+  size_t ngot;
+  m->d_items = grab(MAGAZINE_BATCH, ngot);
+  m->d_n_items = ngot;
+  d_misses++;
+  d_hits += m->d_hits;
+  m->d_hits = 0;
+}
+
+/*
+ * Keep the first (most recently freed) \p keep items in m's cache
+ * and give the rest back to the pool.
+ */
+void
+pmt_pool::flush(magazine *m, size_t keep)
+{
+  if (m->d_n_items <= keep){
+    if (m->d_hits){
+      scoped_lock guard(d_mutex);
+      d_hits += m->d_hits;
+      m->d_hits = 0;
+    }
+    return;
   }
 
-  // allocate a new chunk
-  char *alloc = new char[d_allocation_size + d_alignment - 1];
-  d_allocations.push_back(alloc);
-
-  // get the alignment we require
-  char *start = (char *)(((uintptr_t)alloc + d_alignment-1) & -d_alignment);
-  char *end = alloc + d_allocation_size + d_alignment - 1;
-  size_t n = (end - start) / d_itemsize;
-
-  // link the new items onto the free list.
-  p = (item *) start;
-  for (size_t i = 0; i < n; i++){
-    p->d_next = d_freelist;
-    d_freelist = p;
-    p = (item *)((char *) p + d_itemsize);
+  item *head;
+  if (keep == 0){
+    head = m->d_items;
+    m->d_items = 0;
+  }
+  else {
+    item *last = m->d_items;
+    for (size_t i = 1; i < keep; i++)
+      last = last->d_next;
+    head = last->d_next;
+    last->d_next = 0;
   }
 
-  // now return the first one
-  p = d_freelist;
-  d_freelist = p->d_next;
-  d_n_items++;
-  return p;
+  item *tail = head;
+  while (tail->d_next)
+    tail = tail->d_next;
+
+  size_t n = m->d_n_items - keep;
+  m->d_n_items = keep;
+  release(head, tail, n, m->d_hits);
+  m->d_hits = 0;
+}
+
+/*
+ * Called by boost when a thread exits.
+ */
+void
+pmt_pool::cleanup(magazine *m)
+{
+  scoped_lock guard(detach_mutex());
+  pmt_pool *pool = m->d_pool;
+  if (pool){
+    pool->flush(m, 0);
+
+    scoped_lock pool_guard(pool->d_mutex);
+    pool->d_magazines.erase(std::find(pool->d_magazines.begin(),
+				      pool->d_magazines.end(), m));
+  }
+  delete m;
+}
+
+void *
+pmt_pool::malloc()
+{
+  if (d_max_items == 0){
+    magazine *m = cache();
+
+    if (m->d_n_items == 0)
+      refill(m);
+    else
+      m->d_hits++;
+
+    item *p = m->d_items;
+    m->d_items = p->d_next;
+    m->d_n_items--;
+    return p;
+  }
+
+  scoped_lock guard(d_mutex);
+
+  while (d_n_items >= d_max_items)
+    d_cond.wait(guard);
+
+  size_t ngot;
+  d_misses++;
+  return grab(1, ngot);
 }
 
 void
@@ -100,14 +272,27 @@ pmt_pool::free(void *foo)
   if (!foo)
     return;
 
-  scoped_lock guard(d_mutex);
-
   item *p = (item *) foo;
-  p->d_next = d_freelist;
-  d_freelist = p;
-  d_n_items--;
-  if (d_max_items != 0)
-    d_cond.notify_one();
+
+  if (d_max_items != 0){
+    release(p, p, 1, 0);
+    return;
+  }
+
+  magazine *m = cache();
+  p->d_next = m->d_items;
+  m->d_items = p;
+  m->d_n_items++;
+  if (m->d_n_items > MAGAZINE_MAX)
+    flush(m, MAGAZINE_BATCH);
+}
+
+void
+pmt_pool::counts(size_t &nhits, size_t &nmisses) const
+{
+  scoped_lock guard(d_mutex);
+  nhits = d_hits;
+  nmisses = d_misses;
 }
 
 } /* namespace pmt */
@@ -499,8 +499,9 @@ serialize(pmt_t obj, std::streambuf &sb)
     }
   }
 
+  // Dictionaries go out as the a-list they are equivalent to
   if (is_dict(obj))
-    throw notimplemented("pmt::serialize (dict)", obj);
+    return serialize(dict_items(obj), sb);
 
   if (is_tuple(obj)){
     size_t tuple_len = pmt::length(obj);
@@ -23,9 +23,13 @@
 #include <qa_pmt_prims.h>
 #include <cppunit/TestAssert.h>
 #include <gnuradio/messages/msg_passing.h>
+#include <pmt/pmt_pool.h>
 #include <boost/format.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 #include <cstdio>
 #include <cstring>
+#include <new>
 #include <sstream>
 
 void
@@ -73,6 +77,38 @@ qa_pmt_prims::test_symbols()
     CPPUNIT_ASSERT(v1[i] == v2[i]);
 }
 
+static void
+intern_symbols(std::vector<pmt::pmt_t> *v, int stride)
+{
+  // Every thread walks the same names in a different order
+  int N = v->size();
+  for (int i = 0; i < N; i++){
+    int k = (i * stride) % N;
+    std::string buf = str(boost::format("threaded-%d") % k);
+    (*v)[k] = pmt::mp(buf.c_str());
+  }
+}
+
+void
+qa_pmt_prims::test_symbols_threaded()
+{
+  static const int N = 4093;    // prime, so each stride visits every name
+  static const int NTHREADS = 4;
+  std::vector<std::vector<pmt::pmt_t> > v(NTHREADS, std::vector<pmt::pmt_t>(N));
+
+  boost::thread_group threads;
+  for (int t = 0; t < NTHREADS; t++)
+    threads.create_thread(boost::bind(intern_symbols, &v[t], 2 * t + 1));
+  threads.join_all();
+
+  // everybody must have gotten the same symbol for each name
+  for (int i = 0; i < N; i++){
+    CPPUNIT_ASSERT(pmt::is_symbol(v[0][i]));
+    for (int t = 1; t < NTHREADS; t++)
+      CPPUNIT_ASSERT(v[0][i] == v[t][i]);
+  }
+}
+
 void
 qa_pmt_prims::test_booleans()
 {
@@ -400,6 +436,37 @@ qa_pmt_prims::test_dict()
   //std::cout << "pmt::dict_values: " << pmt::dict_values(dict) << std::endl;
   CPPUNIT_ASSERT(pmt::equal(keys, pmt::dict_keys(dict)));
   CPPUNIT_ASSERT(pmt::equal(vals, pmt::dict_values(dict)));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, pmt::length(dict));
+
+  // older versions are not affected by later changes, including
+  // changes made from a version that has already been extended
+  pmt::pmt_t d1 = pmt::dict_add(dict, k3, v3);
+  pmt::pmt_t d2 = pmt::dict_add(dict, k3, v0);
+  pmt::pmt_t d3 = pmt::dict_delete(d1, k2);
+  CPPUNIT_ASSERT(!pmt::dict_has_key(dict, k3));
+  CPPUNIT_ASSERT(pmt::eqv(pmt::dict_ref(d1, k3, not_found), v3));
+  CPPUNIT_ASSERT(pmt::eqv(pmt::dict_ref(d2, k3, not_found), v0));
+  CPPUNIT_ASSERT(pmt::dict_has_key(d1, k2));
+  CPPUNIT_ASSERT(!pmt::dict_has_key(d3, k2));
+  CPPUNIT_ASSERT_EQUAL((size_t)3, pmt::length(d3));
+  CPPUNIT_ASSERT(pmt::equal(pmt::list3(k3, k1, k0), pmt::dict_keys(d3)));
+
+  // same behavior and serialization as the equivalent a-list
+  pmt::pmt_t alist = pmt::acons(k3, v3, pmt::acons(k1, v3, pmt::acons(k0, v0, pmt::PMT_NIL)));
+  CPPUNIT_ASSERT(pmt::equal(alist, d3));
+  CPPUNIT_ASSERT(pmt::equal(d3, alist));
+  CPPUNIT_ASSERT_EQUAL(pmt::serialize_str(alist), pmt::serialize_str(d3));
+  pmt::pmt_t d4 = pmt::dict_add(pmt::deserialize_str(pmt::serialize_str(d3)), k2, v2);
+  CPPUNIT_ASSERT(pmt::equal(pmt::list4(k2, k3, k1, k0), pmt::dict_keys(d4)));
+  CPPUNIT_ASSERT(pmt::equal(pmt::dict_keys(d3), pmt::dict_keys(pmt::dict_delete(d4, k2))));
+
+  // lots of updates to a few keys
+  pmt::pmt_t d5 = pmt::make_dict();
+  for (long i = 0; i < 1000; i++)
+    d5 = pmt::dict_add(d5, pmt::from_long(i % 7), pmt::from_long(i));
+  CPPUNIT_ASSERT_EQUAL((size_t)7, pmt::length(d5));
+  CPPUNIT_ASSERT_EQUAL(999L, pmt::to_long(pmt::dict_ref(d5, pmt::from_long(5), not_found)));
+  CPPUNIT_ASSERT_EQUAL(994L, pmt::to_long(pmt::dict_ref(d5, pmt::from_long(0), not_found)));
 }
 
 void
@@ -601,3 +668,157 @@ qa_pmt_prims::test_sugar()
   CPPUNIT_ASSERT_EQUAL(sizeof(buf), nbytes);
   CPPUNIT_ASSERT(memcmp(buf, data, nbytes) == 0);
 }
+
+static void
+pool_churn(pmt::pmt_pool *pool)
+{
+  static const int N = 1000;
+  std::vector<void *> v(N);
+
+  for (int k = 0; k < 10; k++){
+    for (int i = 0; i < N; i++){
+      v[i] = pool->malloc();
+      memset(v[i], k, 24);
+    }
+    for (int i = 0; i < N; i++)
+      pool->free(v[i]);
+  }
+}
+
+void
+qa_pmt_prims::test_pool()
+{
+  pmt::pmt_pool pool(24);
+  size_t nhits, nmisses;
+
+  boost::thread_group threads;
+  for (int t = 0; t < 4; t++)
+    threads.create_thread(boost::bind(pool_churn, &pool));
+  threads.join_all();
+
+  // the threads are gone, so their caches have been folded back in
+  pool.counts(nhits, nmisses);
+  CPPUNIT_ASSERT_EQUAL((size_t)(4 * 10 * 1000), nhits + nmisses);
+  CPPUNIT_ASSERT(nhits > nmisses);
+
+  // items are handed out only once
+  void *a = pool.malloc();
+  void *b = pool.malloc();
+  CPPUNIT_ASSERT(a != b);
+  pool.free(a);
+  pool.free(b);
+}
+
+static void
+pool_take(pmt::pmt_pool *pool, std::vector<void *> *v)
+{
+  for (size_t i = 0; i < v->size(); i++)
+    (*v)[i] = pool->malloc();
+}
+
+static void
+pool_outlive(pmt::pmt_pool *pool, boost::barrier *b)
+{
+  pool->free(pool->malloc());
+  b->wait();	// the pool goes away
+  b->wait();
+}
+
+static void
+pool_reuse(pmt::pmt_pool *pool, boost::barrier *b)
+{
+  pool->free(pool->malloc());
+  b->wait();	// a new pool takes the old one's place
+  b->wait();
+  pool->free(pool->malloc());
+}
+
+void
+qa_pmt_prims::test_pool_lifetime()
+{
+  size_t nhits, nmisses;
+
+  // A thread that exits with an empty cache still has its hits counted
+  {
+    pmt::pmt_pool pool(24);
+    std::vector<void *> v(32);
+    boost::thread t(boost::bind(pool_take, &pool, &v));
+    t.join();
+    for (size_t i = 0; i < v.size(); i++)
+      pool.free(v[i]);
+
+    pool.counts(nhits, nmisses);
+    CPPUNIT_ASSERT_EQUAL((size_t)32, nhits + nmisses);
+  }
+
+  // A thread may exit after the pool its cache belongs to is gone
+  {
+    pmt::pmt_pool *pool = new pmt::pmt_pool(24);
+    boost::barrier b(2);
+    boost::thread t(boost::bind(pool_outlive, pool, &b));
+    b.wait();
+    delete pool;
+    b.wait();
+    t.join();
+  }
+
+  // A pool made at the address of one that is gone doesn't inherit
+  // the cache a thread kept for the old one
+  {
+    void *mem = ::operator new(sizeof(pmt::pmt_pool));
+    pmt::pmt_pool *pool = new(mem) pmt::pmt_pool(24);
+    boost::barrier b(2);
+    boost::thread t(boost::bind(pool_reuse, pool, &b));
+    b.wait();
+    pool->~pmt_pool();
+    pool = new(mem) pmt::pmt_pool(24);
+    b.wait();
+    t.join();
+
+    pool->counts(nhits, nmisses);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, nmisses);
+    pool->~pmt_pool();
+    ::operator delete(mem);
+  }
+}
+
+void
+qa_pmt_prims::test_memory_block()
+{
+  pmt::memory_block_t mem = pmt::make_memory_block(1000, 64);
+  CPPUNIT_ASSERT_EQUAL((size_t)1000, pmt::memory_block_size(mem));
+  CPPUNIT_ASSERT_EQUAL((uintptr_t)0, (uintptr_t)pmt::memory_block_data(mem) & 63);
+
+  float *f = (float *) pmt::memory_block_data(mem);
+  for (int i = 0; i < 250; i++)
+    f[i] = i;
+
+  // views see the block's memory, starting at a byte offset
+  pmt::pmt_t v = pmt::make_f32vector_view(mem, 40, 100);
+  CPPUNIT_ASSERT(pmt::is_f32vector(v));
+  CPPUNIT_ASSERT_EQUAL((size_t)100, pmt::length(v));
+  CPPUNIT_ASSERT_EQUAL(10.0f, pmt::f32vector_ref(v, 0));
+  size_t len;
+  CPPUNIT_ASSERT(pmt::f32vector_elements(v, len) == f + 10);
+  CPPUNIT_ASSERT_THROW(pmt::make_f32vector_view(mem, 40, 241), pmt::out_of_range);
+  CPPUNIT_ASSERT_THROW(pmt::make_f32vector_view(mem, 42, 10), pmt::out_of_range);
+  CPPUNIT_ASSERT(pmt::is_u8vector(pmt::make_u8vector_view(mem, 42, 10)));
+
+  // slices share memory too
+  pmt::pmt_t s = pmt::uniform_vector_slice(v, 50, 50);
+  CPPUNIT_ASSERT(pmt::is_f32vector(s));
+  CPPUNIT_ASSERT_EQUAL(60.0f, pmt::f32vector_ref(s, 0));
+  pmt::f32vector_set(v, 50, -1.0f);
+  CPPUNIT_ASSERT_EQUAL(-1.0f, pmt::f32vector_ref(s, 0));
+  CPPUNIT_ASSERT_THROW(pmt::uniform_vector_slice(v, 50, 51), pmt::out_of_range);
+
+  pmt::pmt_t u = pmt::init_u8vector(4, (const uint8_t *) "abcd");
+  pmt::pmt_t us = pmt::uniform_vector_slice(u, 1, 2);
+  CPPUNIT_ASSERT(pmt::is_u8vector(us));
+  CPPUNIT_ASSERT_EQUAL((uint8_t) 'b', pmt::u8vector_ref(us, 0));
+
+  // the memory stays around while any view does
+  mem.reset();
+  v.reset();
+  CPPUNIT_ASSERT_EQUAL(109.0f, pmt::f32vector_ref(s, 49));
+}
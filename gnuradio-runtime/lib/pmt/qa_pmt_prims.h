@@ -31,6 +31,7 @@ class __GR_ATTR_EXPORT qa_pmt_prims : public CppUnit::TestCase
 {
   CPPUNIT_TEST_SUITE(qa_pmt_prims);
   CPPUNIT_TEST(test_symbols);
+  CPPUNIT_TEST(test_symbols_threaded);
   CPPUNIT_TEST(test_booleans);
   CPPUNIT_TEST(test_integers);
   CPPUNIT_TEST(test_uint64s);
@@ -49,10 +50,14 @@ class __GR_ATTR_EXPORT qa_pmt_prims : public CppUnit::TestCase
   CPPUNIT_TEST(test_serialize);
   CPPUNIT_TEST(test_sets);
   CPPUNIT_TEST(test_sugar);
+  CPPUNIT_TEST(test_pool);
+  CPPUNIT_TEST(test_pool_lifetime);
+  CPPUNIT_TEST(test_memory_block);
   CPPUNIT_TEST_SUITE_END();
 
  private:
   void test_symbols();
+  void test_symbols_threaded();
   void test_booleans();
   void test_integers();
   void test_uint64s();
@@ -71,6 +76,9 @@ class __GR_ATTR_EXPORT qa_pmt_prims : public CppUnit::TestCase
   void test_serialize();
   void test_sets();
   void test_sugar();
+  void test_pool();
+  void test_pool_lifetime();
+  void test_memory_block();
 };
 
 #endif /* INCLUDED_QA_PMT_PRIMS_H */
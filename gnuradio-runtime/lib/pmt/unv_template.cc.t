@@ -12,19 +12,26 @@ _@TAG@vector(pmt_t x)
 
 
 pmt_@TAG@vector::pmt_@TAG@vector(size_t k, @TYPE@ fill)
-  : d_v(k)
+  : d_mem(make_memory_block(k * sizeof(@TYPE@), 16)),
+    d_v((@TYPE@ *) memory_block_data(d_mem)), d_len(k)
 {
   for (size_t i = 0; i < k; i++)
     d_v[i] = fill;
 }
 
 pmt_@TAG@vector::pmt_@TAG@vector(size_t k, const @TYPE@ *data)
-  : d_v(k)
+  : d_mem(make_memory_block(k * sizeof(@TYPE@), 16)),
+    d_v((@TYPE@ *) memory_block_data(d_mem)), d_len(k)
 {
   for (size_t i = 0; i < k; i++)
     d_v[i] = data[i];
 }
 
+pmt_@TAG@vector::pmt_@TAG@vector(memory_block_t mem, @TYPE@ *data, size_t k)
+  : d_mem(mem), d_v(data), d_len(k)
+{
+}
+
 @TYPE@
 pmt_@TAG@vector::ref(size_t k) const
 {
@@ -45,28 +52,36 @@ const @TYPE@ *
 pmt_@TAG@vector::elements(size_t &len)
 {
   len = length();
-  return &d_v[0];
+  return d_v;
 }
 
 @TYPE@ *
 pmt_@TAG@vector::writable_elements(size_t &len)
 {
   len = length();
-  return &d_v[0];
+  return d_v;
 }
 
 const void*
 pmt_@TAG@vector::uniform_elements(size_t &len)
 {
   len = length() * sizeof(@TYPE@);
-  return &d_v[0];
+  return d_v;
 }
 
 void*
 pmt_@TAG@vector::uniform_writable_elements(size_t &len)
 {
   len = length() * sizeof(@TYPE@);
-  return &d_v[0];
+  return d_v;
+}
+
+pmt_t
+pmt_@TAG@vector::slice(size_t start, size_t k)
+{
+  if (start > length() || k > length() - start)
+    throw out_of_range("pmt_uniform_vector_slice", from_long(start + k));
+  return pmt_t(new pmt_@TAG@vector(d_mem, d_v + start, k));
 }
 
 bool
@@ -87,6 +102,18 @@ init_@TAG@vector(size_t k, const @TYPE@ *data)
   return pmt_t(new pmt_@TAG@vector(k, data));
 }
 
+pmt_t
+make_@TAG@vector_view(memory_block_t mem, size_t offset, size_t k)
+{
+  size_t size = memory_block_size(mem);
+  if (offset % sizeof(@TYPE@) != 0)
+    throw out_of_range("pmt_make_@TAG@vector_view", from_long(offset));
+  if (offset > size || k > (size - offset) / sizeof(@TYPE@))
+    throw out_of_range("pmt_make_@TAG@vector_view", from_long(offset + k * sizeof(@TYPE@)));
+  @TYPE@ *data = (@TYPE@ *)((char *) memory_block_data(mem) + offset);
+  return pmt_t(new pmt_@TAG@vector(mem, data, k));
+}
+
 pmt_t
 init_@TAG@vector(size_t k, const std::vector< @TYPE@ > &data)
 {
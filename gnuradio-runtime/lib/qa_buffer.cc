@@ -267,6 +267,145 @@ t3_body()
 }
 
 
+// ----------------------------------------------------------------------------
+// test the tag store: out of order adds, range and key queries,
+// removal and pruning
+//
+
+static gr::tag_t
+make_tag(uint64_t offset, const char *key, long value)
+{
+  gr::tag_t t;
+  t.offset = offset;
+  t.key = pmt::string_to_symbol(key);
+  t.value = pmt::from_long(value);
+  t.srcid = pmt::PMT_F;
+  return t;
+}
+
+static void
+t6_body()
+{
+  int nitems = 4000 / sizeof(int);
+  std::vector<gr::tag_t> v;
+
+  gr::buffer_sptr buf(gr::make_buffer(nitems, sizeof(int), gr::block_sptr()));
+  gr::buffer_reader_sptr r1(gr::buffer_add_reader(buf, 0, gr::block_sptr()));
+
+  gr::tag_t t1 = make_tag(20, "a", 1);
+
+  buf->add_item_tag(make_tag(10, "a", 0));
+  buf->add_item_tag(t1);
+  buf->add_item_tag(make_tag(5,  "b", 2));
+  buf->add_item_tag(make_tag(20, "b", 3));
+  buf->add_item_tag(make_tag(30, "a", 4));
+
+  // sorted by offset, insertion order kept for equal offsets
+  r1->get_tags_in_range(v, 0, 100, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)5, v.size());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)5,  v[0].offset);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)10, v[1].offset);
+  CPPUNIT_ASSERT_EQUAL(1L, pmt::to_long(v[2].value));
+  CPPUNIT_ASSERT_EQUAL(3L, pmt::to_long(v[3].value));
+  CPPUNIT_ASSERT_EQUAL((uint64_t)30, v[4].offset);
+
+  // [start, end)
+  r1->get_tags_in_range(v, 10, 30, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, v.size());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)10, v[0].offset);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)20, v[2].offset);
+
+  r1->get_tags_in_range(v, 6, 100, pmt::string_to_symbol("a"), 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, v.size());
+  CPPUNIT_ASSERT_EQUAL(0L, pmt::to_long(v[0].value));
+  CPPUNIT_ASSERT_EQUAL(4L, pmt::to_long(v[2].value));
+
+  // removed tags are hidden from the remover only
+  buf->remove_item_tag(t1, 7);
+  r1->get_tags_in_range(v, 20, 21, 7);
+  CPPUNIT_ASSERT_EQUAL((size_t)1, v.size());
+  CPPUNIT_ASSERT_EQUAL(3L, pmt::to_long(v[0].value));
+  r1->get_tags_in_range(v, 20, 21, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, v.size());
+
+  buf->prune_tags(20);
+  r1->get_tags_in_range(v, 0, 100, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, v.size());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)20, v[0].offset);
+
+  // bulk add
+  std::vector<gr::tag_t> bulk;
+  bulk.push_back(make_tag(25, "c", 5));
+  bulk.push_back(make_tag(40, "c", 6));
+  buf->add_item_tags(bulk.begin(), bulk.end());
+  r1->get_tags_in_range(v, 0, 100, pmt::string_to_symbol("c"), 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)2, v.size());
+  r1->get_tags_in_range(v, 21, 100, 0);
+  CPPUNIT_ASSERT_EQUAL((size_t)3, v.size());
+  CPPUNIT_ASSERT_EQUAL((uint64_t)25, v[0].offset);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)30, v[1].offset);
+  CPPUNIT_ASSERT_EQUAL((uint64_t)40, v[2].offset);
+}
+
+
+// ----------------------------------------------------------------------------
+// test the produce times the buffer keeps for the latency counters
+//
+
+static void
+t7_body()
+{
+  int nitems = 4000 / sizeof(int);
+  gr::high_res_timer_type t, t1, t2;
+
+  // The times are only kept with the counters on, and the buffer
+  // decides when it is made.
+  setenv("GR_CONF_PERFCOUNTERS_ON", "True", 1);
+  gr::buffer_sptr buf(gr::make_buffer(nitems, sizeof(int), gr::block_sptr()));
+  unsetenv("GR_CONF_PERFCOUNTERS_ON");
+
+  CPPUNIT_ASSERT(!buf->write_time(0, t));
+
+#ifdef GR_PERFORMANCE_COUNTERS
+  buf->update_write_pointer(10);
+  CPPUNIT_ASSERT(buf->write_time(0, t1));
+  CPPUNIT_ASSERT(buf->write_time(9, t));
+  CPPUNIT_ASSERT_EQUAL(t1, t);
+  CPPUNIT_ASSERT(!buf->write_time(10, t));
+
+  gr::high_res_timer_type now = gr::high_res_timer_now();
+  while(gr::high_res_timer_now() == now)
+    ;
+
+  // items of a later write have a later time
+  buf->update_write_pointer(5);
+  CPPUNIT_ASSERT(buf->write_time(10, t2));
+  CPPUNIT_ASSERT(t2 > t1);
+  CPPUNIT_ASSERT(buf->write_time(14, t));
+  CPPUNIT_ASSERT_EQUAL(t2, t);
+  CPPUNIT_ASSERT(buf->write_time(9, t));
+  CPPUNIT_ASSERT_EQUAL(t1, t);
+
+  // only the most recent writes are remembered, and their times
+  // never go backwards
+  for(int i = 0; i < 200; i++)
+    buf->update_write_pointer(1);
+  CPPUNIT_ASSERT(!buf->write_time(0, t));
+  CPPUNIT_ASSERT(!buf->write_time(14, t));
+  CPPUNIT_ASSERT(buf->write_time(214, t));
+  CPPUNIT_ASSERT(t >= t2);
+  for(uint64_t i = 214; i > 214 - 60; i--) {
+    CPPUNIT_ASSERT(buf->write_time(i - 1, t1));
+    CPPUNIT_ASSERT(t1 <= t);
+    t = t1;
+  }
+#else
+  buf->update_write_pointer(10);
+  CPPUNIT_ASSERT(!buf->write_time(0, t));
+#endif /* GR_PERFORMANCE_COUNTERS */
+}
+
+
 // ----------------------------------------------------------------------------
 
 void
@@ -302,3 +441,15 @@ void
 qa_buffer::t5()
 {
 }
+
+void
+qa_buffer::t6()
+{
+  leak_check(t6_body);
+}
+
+void
+qa_buffer::t7()
+{
+  leak_check(t7_body);
+}
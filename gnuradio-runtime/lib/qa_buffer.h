@@ -35,6 +35,8 @@ class qa_buffer : public CppUnit::TestCase
   CPPUNIT_TEST(t3);
   CPPUNIT_TEST(t4);
   CPPUNIT_TEST(t5);
+  CPPUNIT_TEST(t6);
+  CPPUNIT_TEST(t7);
   CPPUNIT_TEST_SUITE_END();
 
  private:
@@ -44,6 +46,8 @@ class qa_buffer : public CppUnit::TestCase
   void t3();
   void t4();
   void t5();
+  void t6();
+  void t7();
 };
 
 #endif /* INCLUDED_QA_GR_BUFFER_H */
@@ -0,0 +1,175 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <qa_buffer_resize.h>
+#include <gnuradio/top_block.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+#include <gnuradio/io_signature.h>
+#include <cppunit/TestAssert.h>
+#include <boost/thread/thread.hpp>
+#include <stdlib.h>
+
+// Items are their own number, and every 97th carries a tag whose
+// value is its offset.
+
+static const long ITEM_MOD = 1 << 20;
+
+class numbered_source : public gr::sync_block
+{
+public:
+  numbered_source()
+    : gr::sync_block("numbered_source",
+                     gr::io_signature::make(0, 0, 0),
+                     gr::io_signature::make(1, 1, sizeof(float)))
+  {}
+
+  int work(int noutput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items)
+  {
+    float *out = (float *)output_items[0];
+    uint64_t n = nitems_written(0);
+    for(int i = 0; i < noutput_items; i++) {
+      out[i] = (float)((n + i) % ITEM_MOD);
+      if((n + i) % 97 == 0)
+        add_item_tag(0, n + i, pmt::intern("n"), pmt::from_uint64(n + i));
+    }
+    return noutput_items;
+  }
+};
+
+// Checks that its items and tags still agree with its item count,
+// with the given history, at a limited pace so the buffers fill up.
+class numbered_sink : public gr::sync_block
+{
+public:
+  long d_nbad;
+  long d_ntags;
+
+  numbered_sink(int history)
+    : gr::sync_block("numbered_sink",
+                     gr::io_signature::make(1, 1, sizeof(float)),
+                     gr::io_signature::make(0, 0, 0)),
+      d_nbad(0), d_ntags(0)
+  {
+    set_history(history);
+  }
+
+  int work(int noutput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items)
+  {
+    const float *in = (const float *)input_items[0] + history() - 1;
+    uint64_t n = nitems_read(0);
+    noutput_items = std::min(noutput_items, 64);
+
+    for(int i = 0; i < noutput_items; i++)
+      if(in[i] != (float)((n + i) % ITEM_MOD))
+        d_nbad++;
+
+    std::vector<gr::tag_t> tags;
+    get_tags_in_range(tags, 0, n, n + noutput_items);
+    for(size_t i = 0; i < tags.size(); i++) {
+      d_ntags++;
+      if(pmt::to_uint64(tags[i].value) != tags[i].offset ||
+         in[tags[i].offset - n] != (float)(tags[i].offset % ITEM_MOD))
+        d_nbad++;
+    }
+
+    boost::this_thread::sleep(boost::posix_time::microseconds(50));
+    return noutput_items;
+  }
+};
+
+// A copy in between, so the tags are also propagated across a
+// resized buffer.
+class copy_ff : public gr::sync_block
+{
+public:
+  copy_ff()
+    : gr::sync_block("copy_ff",
+                     gr::io_signature::make(1, 1, sizeof(float)),
+                     gr::io_signature::make(1, 1, sizeof(float)))
+  {}
+
+  int work(int noutput_items,
+           gr_vector_const_void_star &input_items,
+           gr_vector_void_star &output_items)
+  {
+    memcpy(output_items[0], input_items[0], noutput_items * sizeof(float));
+    return noutput_items;
+  }
+};
+
+// Buffers resized on unlock() keep the numbering of the items and
+// the offsets of the tags in them.
+void
+qa_buffer_resize::t0()
+{
+#ifdef GR_PERFORMANCE_COUNTERS
+  setenv("GR_CONF_DEFAULT_BUFFER_SIZING", "rate", 1);
+  setenv("GR_CONF_DEFAULT_BUFFER_RESIZE", "True", 1);
+  setenv("GR_CONF_DEFAULT_INCREMENTAL_RECONFIG", "False", 1);
+  setenv("GR_CONF_PERFCOUNTERS_ON", "True", 1);
+
+  gr::top_block_sptr tb = gr::make_top_block("buffer_resize");
+  boost::shared_ptr<numbered_source> src(new numbered_source());
+  boost::shared_ptr<copy_ff> copy(new copy_ff());
+  boost::shared_ptr<numbered_sink> snk1(new numbered_sink(1));
+  boost::shared_ptr<numbered_sink> snk2(new numbered_sink(5));
+  tb->connect(src, 0, copy, 0);
+  tb->connect(copy, 0, snk1, 0);
+  tb->connect(src, 0, snk2, 0);
+
+  tb->start();
+  int size0 = src->detail()->output(0)->bufsize();
+  int size1 = copy->detail()->output(0)->bufsize();
+  bool resized = false;
+  for(int i = 0; i < 5 && !resized; i++) {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    tb->lock();
+    tb->unlock();
+    resized = src->detail()->output(0)->bufsize() != size0 ||
+      copy->detail()->output(0)->bufsize() != size1;
+  }
+  boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+  tb->stop();
+  tb->wait();
+
+  unsetenv("GR_CONF_DEFAULT_BUFFER_SIZING");
+  unsetenv("GR_CONF_DEFAULT_BUFFER_RESIZE");
+  unsetenv("GR_CONF_DEFAULT_INCREMENTAL_RECONFIG");
+  unsetenv("GR_CONF_PERFCOUNTERS_ON");
+
+  CPPUNIT_ASSERT(resized);
+  CPPUNIT_ASSERT(snk1->d_ntags > 0);
+  CPPUNIT_ASSERT(snk2->d_ntags > 0);
+  CPPUNIT_ASSERT_EQUAL(0L, snk1->d_nbad);
+  CPPUNIT_ASSERT_EQUAL(0L, snk2->d_nbad);
+#endif /* GR_PERFORMANCE_COUNTERS */
+}
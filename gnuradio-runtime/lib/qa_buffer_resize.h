@@ -0,0 +1,39 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef INCLUDED_QA_GR_BUFFER_RESIZE_H
+#define INCLUDED_QA_GR_BUFFER_RESIZE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCase.h>
+
+class qa_buffer_resize : public CppUnit::TestCase
+{
+  CPPUNIT_TEST_SUITE(qa_buffer_resize);
+  CPPUNIT_TEST(t0);
+  CPPUNIT_TEST_SUITE_END();
+
+ private:
+  void t0();
+};
+
+#endif /* INCLUDED_QA_GR_BUFFER_RESIZE_H */
@@ -0,0 +1,107 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <qa_cpu_topology.h>
+#include "cpu_topology.h"
+#include <cppunit/TestAssert.h>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/format.hpp>
+
+namespace fs = boost::filesystem;
+
+static void
+write_file(const fs::path &p, const std::string &contents)
+{
+  fs::create_directories(p.parent_path());
+  fs::ofstream f(p);
+  f << contents << std::endl;
+}
+
+static std::vector<int>
+ints(int n, const int *v)
+{
+  return std::vector<int>(v, v + n);
+}
+
+void
+qa_cpu_topology::t0()
+{
+  static const int a[] = { 0, 1, 2, 3, 8, 10, 11 };
+  CPPUNIT_ASSERT(ints(7, a) == gr::cpu_topology::parse_cpu_list("0-3,8,10-11"));
+
+  static const int b[] = { 1, 2, 5 };
+  CPPUNIT_ASSERT(ints(3, b) == gr::cpu_topology::parse_cpu_list("5,1-2,2"));
+
+  CPPUNIT_ASSERT(gr::cpu_topology::parse_cpu_list("").empty());
+}
+
+// Two sockets, each with two cores of two threads, an L3 and a NUMA
+// node of its own. Threads 0-3 are the first of each core, 4-7 the
+// second, as Linux usually numbers them.
+void
+qa_cpu_topology::t1()
+{
+  fs::path root = fs::temp_directory_path() / fs::unique_path("qa_cpu_topology-%%%%-%%%%");
+
+  write_file(root / "cpu/online", "0-7");
+  write_file(root / "node/online", "0-1");
+  write_file(root / "node/node0/cpulist", "0-1,4-5");
+  write_file(root / "node/node1/cpulist", "2-3,6-7");
+
+  for(int n = 0; n < 8; n++) {
+    fs::path cpu = root / str(boost::format("cpu/cpu%d") % n);
+    int package = (n % 4) / 2;
+    write_file(cpu / "topology/physical_package_id", str(boost::format("%d") % package));
+    write_file(cpu / "topology/core_id", str(boost::format("%d") % (n % 2)));
+
+    write_file(cpu / "cache/index0/level", "1");
+    write_file(cpu / "cache/index0/type", "Data");
+    write_file(cpu / "cache/index0/shared_cpu_list", str(boost::format("%d,%d") % (n % 4) % (n % 4 + 4)));
+    write_file(cpu / "cache/index1/level", "1");
+    write_file(cpu / "cache/index1/type", "Instruction");
+    write_file(cpu / "cache/index1/shared_cpu_list", str(boost::format("%d,%d") % (n % 4) % (n % 4 + 4)));
+    write_file(cpu / "cache/index2/level", "3");
+    write_file(cpu / "cache/index2/type", "Unified");
+    write_file(cpu / "cache/index2/shared_cpu_list", package ? "2-3,6-7" : "0-1,4-5");
+  }
+
+  gr::cpu_topology topo(root.string());
+  fs::remove_all(root);
+
+  CPPUNIT_ASSERT_EQUAL((size_t)8, topo.cpus().size());
+  CPPUNIT_ASSERT_EQUAL(1, topo.cpus()[6].node);
+  CPPUNIT_ASSERT_EQUAL(3, topo.cpus()[6].cache_level);
+  CPPUNIT_ASSERT_EQUAL(2, topo.cpus()[6].cache_group);
+
+  std::vector<std::vector<int> > groups = topo.cache_groups();
+  CPPUNIT_ASSERT_EQUAL((size_t)2, groups.size());
+
+  static const int g0[] = { 0, 1, 4, 5 };
+  static const int g1[] = { 2, 3, 6, 7 };
+  CPPUNIT_ASSERT(ints(4, g0) == groups[0]);
+  CPPUNIT_ASSERT(ints(4, g1) == groups[1]);
+}
@@ -0,0 +1,88 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <qa_latency_histogram.h>
+#include <gnuradio/latency_histogram.h>
+#include <cppunit/TestAssert.h>
+
+typedef gr::latency_histogram hist;
+
+// Every value lands in a bucket whose low edge is within the
+// advertised relative error below it.
+void
+qa_latency_histogram::t0()
+{
+  for(gr::high_res_timer_type v = 0; v < 32; v++)
+    CPPUNIT_ASSERT_EQUAL(v, hist::bucket_low(hist::bucket(v)));
+
+  int last = -1;
+  for(gr::high_res_timer_type v = 1; v < ((gr::high_res_timer_type)1 << hist::MAX_BITS); v = v * 3 / 2 + 1) {
+    int b = hist::bucket(v);
+    CPPUNIT_ASSERT(b >= last && b < hist::NBUCKETS);
+    gr::high_res_timer_type low = hist::bucket_low(b);
+    CPPUNIT_ASSERT(low <= v);
+    CPPUNIT_ASSERT(v - low <= v >> hist::SUB_BITS);
+    last = b;
+  }
+
+  CPPUNIT_ASSERT_EQUAL((int)hist::NBUCKETS - 1, hist::bucket((gr::high_res_timer_type)1 << 50));
+  CPPUNIT_ASSERT_EQUAL(0, hist::bucket(-5));
+}
+
+// Percentiles of a known distribution
+void
+qa_latency_histogram::t1()
+{
+  hist h;
+  CPPUNIT_ASSERT_EQUAL(0.0, h.percentile(0.5));
+
+  for(int i = 1; i <= 100000; i++)
+    h.add(i);
+  CPPUNIT_ASSERT_EQUAL(100000UL, h.count());
+  CPPUNIT_ASSERT_EQUAL((gr::high_res_timer_type)100000, h.max());
+
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(50000, h.percentile(0.5), 50000 * 0.04);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(99000, h.percentile(0.99), 99000 * 0.04);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(99900, h.percentile(0.999), 99900 * 0.04);
+  CPPUNIT_ASSERT(h.percentile(1.0) <= 100000);
+
+  std::vector<float> p = h.percentiles();
+  CPPUNIT_ASSERT_EQUAL((size_t)3, p.size());
+  CPPUNIT_ASSERT(p[0] < p[1] && p[1] <= p[2]);
+
+  // one outlier shows in p99.9 of 1000 values only if it's in the top 0.1%
+  hist t;
+  for(int i = 0; i < 998; i++)
+    t.add(100);
+  t.add(1000000);
+  t.add(1000000);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(100, t.percentile(0.99), 4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1000000, t.percentile(0.999), 1000000 * 0.04);
+
+  t.reset();
+  CPPUNIT_ASSERT_EQUAL(0UL, t.count());
+  CPPUNIT_ASSERT_EQUAL(0.0, t.percentile(0.99));
+}
@@ -0,0 +1,177 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <qa_msg_port_queue.h>
+#include <gnuradio/msg_port_queue.h>
+#include <cppunit/TestAssert.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+// FIFO order, capacity rounding and the owner's pending count
+void
+qa_msg_port_queue::t0()
+{
+  long pending = 0;
+  gr::msg_port_queue q(5, gr::msg_port_queue::REJECT, &pending);
+
+  CPPUNIT_ASSERT_EQUAL((size_t)8, q.capacity());
+  CPPUNIT_ASSERT(q.empty_p());
+  CPPUNIT_ASSERT(!q.delete_head_nowait());
+
+  for(long i = 0; i < 8; i++)
+    CPPUNIT_ASSERT(q.insert_tail(pmt::from_long(i)));
+  CPPUNIT_ASSERT_EQUAL((size_t)8, q.nmsgs());
+  CPPUNIT_ASSERT_EQUAL(8L, pending);
+
+  // full: refused and counted
+  CPPUNIT_ASSERT(!q.insert_tail(pmt::from_long(8)));
+  CPPUNIT_ASSERT_EQUAL(1L, q.nrejected());
+  CPPUNIT_ASSERT_EQUAL(0L, q.ndropped());
+
+  for(long i = 0; i < 8; i++)
+    CPPUNIT_ASSERT_EQUAL(i, pmt::to_long(q.delete_head_nowait()));
+  CPPUNIT_ASSERT(q.empty_p());
+  CPPUNIT_ASSERT_EQUAL(0L, pending);
+
+  // wrap around the ring a few times
+  for(long i = 0; i < 100; i++) {
+    q.insert_tail(pmt::from_long(i));
+    q.insert_tail(pmt::from_long(-i));
+    CPPUNIT_ASSERT_EQUAL(i, pmt::to_long(q.delete_head_blocking()));
+    CPPUNIT_ASSERT_EQUAL(-i, pmt::to_long(q.delete_head_nowait()));
+  }
+  CPPUNIT_ASSERT_EQUAL(0L, pending);
+}
+
+// overflow policies
+void
+qa_msg_port_queue::t1()
+{
+  gr::msg_port_queue oldest(4, gr::msg_port_queue::DROP_OLDEST);
+  gr::msg_port_queue newest(4, gr::msg_port_queue::DROP_NEWEST);
+
+  for(long i = 0; i < 10; i++) {
+    CPPUNIT_ASSERT(oldest.insert_tail(pmt::from_long(i)));
+    CPPUNIT_ASSERT(newest.insert_tail(pmt::from_long(i)));
+  }
+  CPPUNIT_ASSERT_EQUAL(6L, oldest.ndropped());
+  CPPUNIT_ASSERT_EQUAL(6L, newest.ndropped());
+  CPPUNIT_ASSERT_EQUAL(0L, newest.nrejected());
+
+  for(long i = 0; i < 4; i++) {
+    CPPUNIT_ASSERT_EQUAL(6 + i, pmt::to_long(oldest.delete_head_nowait()));
+    CPPUNIT_ASSERT_EQUAL(i, pmt::to_long(newest.delete_head_nowait()));
+  }
+  CPPUNIT_ASSERT(oldest.empty_p());
+  CPPUNIT_ASSERT(newest.empty_p());
+
+  CPPUNIT_ASSERT_EQUAL(gr::msg_port_queue::BLOCK,
+                       gr::msg_port_queue::policy_from_string("block"));
+  CPPUNIT_ASSERT_EQUAL(gr::msg_port_queue::REJECT,
+                       gr::msg_port_queue::policy_from_string("reject"));
+  CPPUNIT_ASSERT_THROW(gr::msg_port_queue::policy_from_string("bogus"),
+                       std::invalid_argument);
+}
+
+static void
+t2_producer(gr::msg_port_queue *q, long id, long n)
+{
+  for(long i = 0; i < n; i++)
+    q->insert_tail(pmt::cons(pmt::from_long(id), pmt::from_long(i)));
+}
+
+// several senders blocking on a small queue; nothing lost, each
+// sender's messages arrive in order
+void
+qa_msg_port_queue::t2()
+{
+  const long NPRODUCERS = 4;
+  const long NMSGS = 20000;
+  long pending = 0;
+  gr::msg_port_queue q(16, gr::msg_port_queue::BLOCK, &pending);
+
+  boost::thread_group producers;
+  for(long p = 0; p < NPRODUCERS; p++)
+    producers.create_thread(boost::bind(t2_producer, &q, p, NMSGS));
+
+  std::vector<long> next(NPRODUCERS, 0);
+  for(long n = 0; n < NPRODUCERS * NMSGS; n++) {
+    pmt::pmt_t m = q.delete_head_blocking();
+    long id = pmt::to_long(pmt::car(m));
+    CPPUNIT_ASSERT_EQUAL(next[id], pmt::to_long(pmt::cdr(m)));
+    next[id]++;
+  }
+  producers.join_all();
+
+  CPPUNIT_ASSERT(q.empty_p());
+  CPPUNIT_ASSERT_EQUAL(0L, pending);
+  CPPUNIT_ASSERT_EQUAL(0L, q.ndropped());
+}
+
+// an unbounded queue keeps what doesn't fit in the ring, in order,
+// also with several senders
+void
+qa_msg_port_queue::t3()
+{
+  long pending = 0;
+  gr::msg_port_queue q(4, gr::msg_port_queue::UNBOUNDED, &pending);
+
+  for(long i = 0; i < 10; i++)
+    CPPUNIT_ASSERT(q.insert_tail(pmt::from_long(i)));
+  CPPUNIT_ASSERT_EQUAL((size_t)10, q.nmsgs());
+  CPPUNIT_ASSERT_EQUAL(10L, pending);
+
+  // taking some out doesn't let later messages overtake the overflow
+  for(long i = 0; i < 6; i++)
+    CPPUNIT_ASSERT_EQUAL(i, pmt::to_long(q.delete_head_nowait()));
+  for(long i = 10; i < 12; i++)
+    q.insert_tail(pmt::from_long(i));
+  for(long i = 6; i < 12; i++)
+    CPPUNIT_ASSERT_EQUAL(i, pmt::to_long(q.delete_head_blocking()));
+  CPPUNIT_ASSERT(q.empty_p());
+  CPPUNIT_ASSERT_EQUAL(0L, pending);
+  CPPUNIT_ASSERT_EQUAL(0L, q.ndropped());
+
+  const long NPRODUCERS = 4;
+  const long NMSGS = 20000;
+  boost::thread_group producers;
+  for(long p = 0; p < NPRODUCERS; p++)
+    producers.create_thread(boost::bind(t2_producer, &q, p, NMSGS));
+
+  std::vector<long> next(NPRODUCERS, 0);
+  for(long n = 0; n < NPRODUCERS * NMSGS; n++) {
+    pmt::pmt_t m = q.delete_head_blocking();
+    long id = pmt::to_long(pmt::car(m));
+    CPPUNIT_ASSERT_EQUAL(next[id], pmt::to_long(pmt::cdr(m)));
+    next[id]++;
+  }
+  producers.join_all();
+
+  CPPUNIT_ASSERT(q.empty_p());
+  CPPUNIT_ASSERT_EQUAL(0L, pending);
+  CPPUNIT_ASSERT_EQUAL(gr::msg_port_queue::UNBOUNDED,
+                       gr::msg_port_queue::policy_from_string("unbounded"));
+}
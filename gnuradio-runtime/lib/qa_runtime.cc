@@ -31,13 +31,18 @@
 
 #include <qa_runtime.h>
 #include <qa_buffer.h>
+#include <qa_buffer_resize.h>
 #include <qa_io_signature.h>
 #include <qa_circular_file.h>
+#include <qa_cpu_topology.h>
 #include <qa_fxpt.h>
 #include <qa_fxpt_nco.h>
 #include <qa_fxpt_vco.h>
+#include <qa_latency_histogram.h>
 #include <qa_logger.h>
 #include <qa_math.h>
+#include <qa_msg_port_queue.h>
+#include <qa_tracer.h>
 #include <qa_vmcircbuf.h>
 #include <qa_sincos.h>
 
@@ -47,13 +52,18 @@ qa_runtime::suite()
   CppUnit::TestSuite *s = new CppUnit::TestSuite("runtime");
 
   s->addTest(qa_buffer::suite());
+  s->addTest(qa_buffer_resize::suite());
   s->addTest(qa_io_signature::suite());
   s->addTest(qa_circular_file::suite());
+  s->addTest(qa_cpu_topology::suite());
   s->addTest(qa_fxpt::suite());
   s->addTest(qa_fxpt_nco::suite());
   s->addTest(qa_fxpt_vco::suite());
+  s->addTest(qa_latency_histogram::suite());
   s->addTest(qa_logger::suite());
   s->addTest(qa_math::suite());
+  s->addTest(qa_msg_port_queue::suite());
+  s->addTest(qa_tracer::suite());
   s->addTest(qa_vmcircbuf::suite());
   s->addTest(qa_sincos::suite());
 
@@ -0,0 +1,104 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <qa_tracer.h>
+#include <gnuradio/tracer.h>
+#include <cppunit/TestAssert.h>
+#include <boost/thread/thread.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+static std::string
+dump()
+{
+  fs::path p = fs::temp_directory_path() / fs::unique_path("qa_tracer-%%%%-%%%%.json");
+  gr::tracer::dump_chrome_json(p.string());
+  std::ifstream f(p.string().c_str());
+  std::stringstream s;
+  s << f.rdbuf();
+  fs::remove(p);
+  return s.str();
+}
+
+static void
+fake_block(long id)
+{
+  for(int i = 0; i < 10; i++) {
+    gr::tracer::trace(gr::tracer::WORK_BEGIN, id, 100 + i);
+    gr::tracer::trace(gr::tracer::WORK_END, id, 100 + i);
+    gr::tracer::trace(gr::tracer::BLKD_IN, id);
+    gr::tracer::trace(gr::tracer::BLKD_IN, id);
+  }
+  gr::tracer::trace(gr::tracer::DONE, id);
+}
+
+// Events from two threads end up on two named tracks.
+void
+qa_tracer::t0()
+{
+  gr::tracer::register_block(1000001, "qa_tracer_src");
+  gr::tracer::register_block(1000002, "qa_tracer_snk");
+  gr::tracer::enable(true);
+  gr::tracer::clear();
+
+  boost::thread a(fake_block, 1000001);
+  boost::thread b(fake_block, 1000002);
+  a.join();
+  b.join();
+
+  gr::tracer::enable(false);
+  gr::tracer::trace(gr::tracer::WORK_BEGIN, 1000001, 12345);	// not recorded
+
+  std::string json = dump();
+  CPPUNIT_ASSERT(json.find("\"name\":\"qa_tracer_src\"") != std::string::npos);
+  CPPUNIT_ASSERT(json.find("\"name\":\"qa_tracer_snk\"") != std::string::npos);
+  CPPUNIT_ASSERT(json.find("\"noutput_items\":109") != std::string::npos);
+  CPPUNIT_ASSERT(json.find("\"noutput_items\":12345") == std::string::npos);
+  CPPUNIT_ASSERT(json.find("blocked input") != std::string::npos);
+  CPPUNIT_ASSERT(json.find("qa_tracer_snk done") != std::string::npos);
+  CPPUNIT_ASSERT_EQUAL(json.size() - 3, json.rfind("]}"));
+}
+
+// clear() drops what was recorded before it, on live threads too.
+void
+qa_tracer::t1()
+{
+  gr::tracer::register_block(1000003, "qa_tracer_blk");
+  gr::tracer::enable(true);
+  gr::tracer::trace(gr::tracer::WORK_BEGIN, 1000003, 111);
+  gr::tracer::trace(gr::tracer::WORK_END, 1000003, 111);
+  gr::tracer::clear();
+  gr::tracer::trace(gr::tracer::WORK_BEGIN, 1000003, 222);
+  gr::tracer::trace(gr::tracer::WORK_END, 1000003, 222);
+  gr::tracer::enable(false);
+
+  std::string json = dump();
+  CPPUNIT_ASSERT(json.find("\"noutput_items\":111") == std::string::npos);
+  CPPUNIT_ASSERT(json.find("\"noutput_items\":222") != std::string::npos);
+}
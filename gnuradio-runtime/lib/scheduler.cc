@@ -24,6 +24,7 @@
 #endif
 
 #include "scheduler.h"
+#include <stdexcept>
 
 namespace gr {
 
@@ -36,4 +37,16 @@ namespace gr {
   {
   }
 
+  bool
+  scheduler::stop_blocks(const block_vector_t &blocks)
+  {
+    return false;
+  }
+
+  void
+  scheduler::start_blocks(const block_vector_t &blocks)
+  {
+    throw std::runtime_error("scheduler: start_blocks not supported");
+  }
+
 } /* namespace gr */
@@ -61,6 +61,24 @@ namespace gr {
      * \brief Block until the graph is done.
      */
     virtual void wait() = 0;
+
+    /*!
+     * \brief Stop running \p blocks and wait until they have
+     * stopped, leaving the rest of the graph running.
+     *
+     * Used by top_block::unlock() to rewire part of a running
+     * graph. Returns false, having done nothing, if the scheduler can
+     * only stop the whole graph; the caller then falls back to
+     * stop(), wait() and a new scheduler.
+     */
+    virtual bool stop_blocks(const block_vector_t &blocks);
+
+    /*!
+     * \brief Start running \p blocks, which have been wired into the
+     * graph since the scheduler was made or have been stopped by
+     * stop_blocks().
+     */
+    virtual void start_blocks(const block_vector_t &blocks);
   };
 
 } /* namespace gr */
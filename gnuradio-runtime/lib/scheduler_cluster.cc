@@ -0,0 +1,404 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "scheduler_cluster.h"
+#include <gnuradio/block_detail.h>
+#include <gnuradio/buffer.h>
+#include <gnuradio/prefs.h>
+#include <gnuradio/tracer.h>
+#include <gnuradio/thread/atomic.h>
+#include <gnuradio/thread/thread_body_wrapper.h>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace gr {
+
+  static void
+  add_unique(std::vector<block_detail *> &v, block_detail *d)
+  {
+    if(std::find(v.begin(), v.end(), d) == v.end())
+      v.push_back(d);
+  }
+
+  /*
+   * Every block run by this scheduler has its ready_callback pointed
+   * at its cluster, so that is all we need to poke; the tpb_detail
+   * flags and condition variables are never waited on.
+   */
+  static void
+  notify_all(const std::vector<block_detail *> &v)
+  {
+    for(size_t i = 0; i < v.size(); i++)
+      v[i]->d_tpb.notify_ready();
+  }
+
+  scheduler_sptr
+  scheduler_cluster::make(flat_flowgraph_sptr ffg, int max_noutput_items)
+  {
+    return scheduler_sptr(new scheduler_cluster(ffg, max_noutput_items));
+  }
+
+  scheduler_cluster::scheduler_cluster(flat_flowgraph_sptr ffg,
+                                       int max_noutput_items)
+    : scheduler(ffg, max_noutput_items)
+  {
+    prefs *p = prefs::singleton();
+    d_max_nmsgs = static_cast<size_t>(p->get_long("DEFAULT", "max_messages", 100));
+
+    // Split the flattened flow graph into discrete partitions, each
+    // of which is topologically sorted.
+
+    std::vector<basic_block_vector_t> graphs = ffg->partition();
+
+    size_t nblocks = 0;
+    for(size_t i = 0; i < graphs.size(); i++)
+      nblocks += graphs[i].size();
+
+    long size = p->get_long("DEFAULT", "cluster_size", 0);
+    if(size <= 0) {
+      long nthreads = boost::thread::hardware_concurrency();
+      if(nthreads <= 0)
+        nthreads = 1;
+      size = std::max(1L, (long)(nblocks + nthreads - 1) / nthreads);
+    }
+
+    // Hand out the blocks: those with a cluster id to the cluster of
+    // that id, the others to runs of at most size blocks.
+
+    std::map<int, cluster *> by_id;
+    std::map<block_detail *, cluster *> owner;
+
+    for(size_t g = 0; g < graphs.size(); g++) {
+      block_vector_t blocks = flat_flowgraph::make_block_vector(graphs[g]);
+      cluster *run = 0;
+      size_t nrun = 0;
+
+      for(size_t i = 0; i < blocks.size(); i++) {
+        cluster *c;
+        int id = blocks[i]->cluster();
+        if(id >= 0) {
+          c = by_id[id];
+          if(c == 0)
+            c = by_id[id] = new_cluster();
+        }
+        else {
+          if(run == 0 || nrun == (size_t)size) {
+            run = new_cluster();
+            nrun = 0;
+          }
+          c = run;
+          nrun++;
+        }
+
+        // Ensure that the done flag is clear on all blocks
+        blocks[i]->detail()->set_done(false);
+        blocks[i]->detail()->threaded = false;
+
+        member m;
+        m.block = blocks[i];
+        m.done = false;
+        c->members.push_back(m);
+        owner[blocks[i]->detail().get()] = c;
+      }
+    }
+
+    // Only edges between clusters need to wake anybody up.
+
+    for(size_t i = 0; i < d_clusters.size(); i++) {
+      cluster *c = d_clusters[i].get();
+      pick_thread_settings(c);
+      for(size_t j = 0; j < c->members.size(); j++) {
+        member &m = c->members[j];
+        block_detail *d = m.block->detail().get();
+
+        for(int k = 0; k < d->ninputs(); k++) {
+          block_detail *up = d->input(k)->buffer()->link()->detail().get();
+          if(owner[up] != c)
+            add_unique(m.upstream, up);
+        }
+        for(int k = 0; k < d->noutputs(); k++) {
+          buffer_sptr buf = d->output(k);
+          for(size_t r = 0; r < buf->nreaders(); r++) {
+            block_detail *down = buf->reader(r)->link()->detail().get();
+            if(owner[down] != c)
+              add_unique(m.downstream, down);
+          }
+        }
+
+        d->d_tpb.set_ready_callback(boost::bind(&scheduler_cluster::wake, this, c));
+      }
+    }
+
+    // Create the executors (which start the blocks) only once every
+    // block can be woken up.
+
+    for(size_t i = 0; i < d_clusters.size(); i++) {
+      cluster *c = d_clusters[i].get();
+      for(size_t j = 0; j < c->members.size(); j++) {
+        member &m = c->members[j];
+
+        // If set, use internal value instead of global value
+        int nmax = max_noutput_items;
+        if(m.block->is_set_max_noutput_items())
+          nmax = m.block->max_noutput_items();
+
+        m.exec = boost::shared_ptr<block_executor>(new block_executor(m.block, nmax));
+      }
+    }
+
+    for(size_t i = 0; i < d_clusters.size(); i++) {
+      std::stringstream name;
+      name << "cluster[" << i << "]";
+
+      d_threads.create_thread(
+        gr::thread::thread_body_wrapper<boost::function0<void> >
+          (boost::bind(&scheduler_cluster::thread_body, this, d_clusters[i].get()),
+           name.str()));
+    }
+  }
+
+  scheduler_cluster::~scheduler_cluster()
+  {
+    stop();
+    wait();
+  }
+
+  scheduler_cluster::cluster *
+  scheduler_cluster::new_cluster()
+  {
+    cluster_sptr c(new cluster);
+    c->priority = -1;
+    c->woken = false;
+    c->stopping = false;
+    d_clusters.push_back(c);
+    return c.get();
+  }
+
+  /*
+   * The cluster's thread runs with the affinity and priority of the
+   * first member that sets them. Members that disagree can't have
+   * theirs, so say so rather than drop them silently.
+   */
+  void
+  scheduler_cluster::pick_thread_settings(cluster *c)
+  {
+    block *afirst = 0, *pfirst = 0;
+
+    for(size_t j = 0; j < c->members.size(); j++) {
+      block *b = c->members[j].block.get();
+
+      std::vector<int> mask = b->processor_affinity();
+      if(!mask.empty()) {
+        if(afirst == 0) {
+          afirst = b;
+          c->affinity = mask;
+        }
+        else if(mask != c->affinity)
+          std::cerr << "scheduler_cluster: warning: " << b->alias()
+                    << " shares a thread with " << afirst->alias()
+                    << ", ignoring its processor affinity" << std::endl;
+      }
+
+      int prio = b->thread_priority();
+      if(prio > 0) {
+        if(pfirst == 0) {
+          pfirst = b;
+          c->priority = prio;
+        }
+        else if(prio != c->priority)
+          std::cerr << "scheduler_cluster: warning: " << b->alias()
+                    << " shares a thread with " << pfirst->alias()
+                    << ", ignoring its thread priority" << std::endl;
+      }
+    }
+  }
+
+  void
+  scheduler_cluster::stop()
+  {
+    for(size_t i = 0; i < d_clusters.size(); i++) {
+      cluster *c = d_clusters[i].get();
+      gr::thread::scoped_lock guard(c->mutex);
+      gr::thread::atomic_store_release(&c->stopping, true);
+      c->cond.notify_one();
+    }
+    d_threads.interrupt_all();
+  }
+
+  void
+  scheduler_cluster::wait()
+  {
+    d_threads.join_all();
+    teardown();
+  }
+
+  /*
+   * Detach from the block details and stop any blocks that did not
+   * finish on their own. Only called once the threads have exited.
+   * Forgets the clusters, so that a second call (from the destructor,
+   * after a new scheduler may have taken over the same details)
+   * leaves the blocks alone.
+   */
+  void
+  scheduler_cluster::teardown()
+  {
+    for(size_t i = 0; i < d_clusters.size(); i++) {
+      cluster *c = d_clusters[i].get();
+      for(size_t j = 0; j < c->members.size(); j++) {
+        member &m = c->members[j];
+        if(m.block->detail())
+          m.block->detail()->d_tpb.set_ready_callback(0);
+        m.exec.reset();                 // stop any drivers, etc.
+      }
+    }
+    d_clusters.clear();
+  }
+
+  /*
+   * Called by blocks in other clusters (through tpb_detail) and by
+   * message posters whenever a block of c may be able to make
+   * progress.
+   */
+  void
+  scheduler_cluster::wake(cluster *c)
+  {
+    gr::thread::scoped_lock guard(c->mutex);
+    gr::thread::atomic_store_release(&c->woken, true);
+    c->cond.notify_one();
+  }
+
+  void
+  scheduler_cluster::thread_body(cluster *c)
+  {
+    size_t nalive = c->members.size();
+
+    gr::thread::gr_thread_t self = gr::thread::get_current_thread_id();
+    if(!c->affinity.empty())
+      gr::thread::thread_bind_to_processor(self, c->affinity);
+    if(c->priority > 0)
+      gr::thread::set_thread_priority(self, c->priority);
+
+    while(nalive > 0) {
+      boost::this_thread::interruption_point();
+
+      // Anything that happens from here on gets another pass.
+      gr::thread::atomic_store_release(&c->woken, false);
+
+      bool progress = false;
+      for(size_t i = 0; i < c->members.size(); i++) {
+        member &m = c->members[i];
+        if(m.done)
+          continue;
+
+        block *b = m.block.get();
+        block_detail *d = b->detail().get();
+        block_executor::state s;
+
+        if(handle_messages(b))
+          progress = true;
+
+        // run one iteration if we are a connected stream block
+        if(d->noutputs() > 0 || d->ninputs() > 0)
+          s = m.exec->run_one_iteration();
+        else
+          s = block_executor::BLKD_IN;
+
+        switch(s) {
+        case block_executor::READY:		// Tell neighbors we made progress.
+          notify_all(m.downstream);
+          notify_all(m.upstream);
+          progress = true;
+          break;
+
+        case block_executor::READY_NO_OUTPUT:	// Notify upstream only
+          notify_all(m.upstream);
+          progress = true;
+          break;
+
+        case block_executor::DONE:		// Game over.
+          notify_all(m.downstream);
+          notify_all(m.upstream);
+          m.done = true;
+          m.exec.reset();			// stop any drivers, etc.
+          nalive--;
+          progress = true;
+          break;
+
+        case block_executor::BLKD_IN:
+        case block_executor::BLKD_OUT:
+          break;
+
+        default:
+          throw std::runtime_error("possible memory corruption in scheduler");
+        }
+      }
+
+      if(!progress) {
+        // Everybody is blocked; wait for another cluster or a
+        // message poster to change that.
+        gr::thread::scoped_lock guard(c->mutex);
+        while(!c->woken && !c->stopping)
+          c->cond.wait(guard);
+      }
+
+      if(gr::thread::atomic_load_acquire(&c->stopping))
+        return;
+    }
+  }
+
+  bool
+  scheduler_cluster::handle_messages(block *b)
+  {
+    pmt::pmt_t msg;
+    bool handled = false;
+
+    if(b->empty_p())
+      return false;
+
+    BOOST_FOREACH(basic_block::msg_queue_map_t::value_type &i, b->msg_queue) {
+      if(b->has_msg_handler(i.first)) {
+        while((msg = b->delete_head_nowait(i.first))) {
+          tracer::trace(tracer::MSG_BEGIN, b->unique_id());
+          b->dispatch_msg(i.first, msg);
+          tracer::trace(tracer::MSG_END, b->unique_id());
+          handled = true;
+        }
+      }
+      else {
+        // If we don't have a handler but are building up messages,
+        // prune the queue from the front to keep memory in check.
+        if(b->nmsgs(i.first) > d_max_nmsgs)
+          msg = b->delete_head_nowait(i.first);
+      }
+    }
+    return handled;
+  }
+
+} /* namespace gr */
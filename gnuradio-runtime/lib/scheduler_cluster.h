@@ -0,0 +1,117 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDED_GR_SCHEDULER_CLUSTER_H
+#define INCLUDED_GR_SCHEDULER_CLUSTER_H
+
+#include <gnuradio/api.h>
+#include <gnuradio/thread/thread_group.h>
+#include <boost/shared_ptr.hpp>
+#include "scheduler.h"
+#include "block_executor.h"
+#include <vector>
+
+namespace gr {
+
+  /*!
+   * \brief Concrete scheduler that runs groups of blocks, each on a
+   * thread of its own, in the style of the single-threaded scheduler.
+   *
+   * Blocks are grouped into clusters. Blocks given the same id with
+   * block::set_cluster() share a cluster; the rest are cut, in
+   * topological order, into runs of the [DEFAULT] cluster_size
+   * preference (0 spreads them evenly over the hardware threads).
+   * Disconnected parts of the graph never share an automatic cluster.
+   *
+   * Each cluster's thread calls its blocks in topological order until
+   * none of them can make progress, then sleeps until a block in
+   * another cluster changes one of its buffers or a message arrives.
+   * Blocks in the same cluster hand over data by direct calls and
+   * never wake each other through the tpb_detail mutexes and
+   * condition variables; only edges between clusters do.
+   *
+   * Blocks do not own a thread, so each cluster's thread takes the
+   * processor affinity and the thread priority of the first of its
+   * blocks (in topological order) that sets one; a block of the same
+   * cluster asking for something else is warned about and ignored.
+   * Only what is set before the flow graph starts is applied.
+   */
+  class GR_RUNTIME_API scheduler_cluster : public scheduler
+  {
+    struct member {
+      block_sptr                        block;
+      boost::shared_ptr<block_executor> exec;
+      bool                              done;
+      std::vector<block_detail *>       upstream;   // in other clusters
+      std::vector<block_detail *>       downstream; // in other clusters
+    };
+
+    struct cluster {
+      std::vector<member>            members;    // topologically sorted
+      std::vector<int>               affinity;   // of the whole thread
+      int                            priority;   // ditto, -1 if unset
+      gr::thread::mutex              mutex;      //< protects the vars below
+      gr::thread::condition_variable cond;
+      bool                           woken;
+      bool                           stopping;
+    };
+    typedef boost::shared_ptr<cluster> cluster_sptr;
+
+    std::vector<cluster_sptr>   d_clusters;
+    gr::thread::thread_group    d_threads;
+    size_t                      d_max_nmsgs;
+
+    cluster *new_cluster();
+    void pick_thread_settings(cluster *c);
+    void wake(cluster *c);
+    void thread_body(cluster *c);
+    bool handle_messages(block *b);
+    void teardown();
+
+  protected:
+    /*!
+     * \brief Construct a scheduler and begin evaluating the graph.
+     *
+     * The scheduler will continue running until all blocks until they
+     * report that they are done or the stop method is called.
+     */
+    scheduler_cluster(flat_flowgraph_sptr ffg, int max_noutput_items);
+
+  public:
+    static scheduler_sptr make(flat_flowgraph_sptr ffg,
+                               int max_noutput_items=100000);
+
+    ~scheduler_cluster();
+
+    /*!
+     * \brief Tell the scheduler to stop executing.
+     */
+    void stop();
+
+    /*!
+     * \brief Block until the graph is done.
+     */
+    void wait();
+  };
+
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_SCHEDULER_CLUSTER_H */
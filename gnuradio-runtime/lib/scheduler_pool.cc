@@ -0,0 +1,362 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "scheduler_pool.h"
+#include <gnuradio/block_detail.h>
+#include <gnuradio/prefs.h>
+#include <gnuradio/tracer.h>
+#include <gnuradio/thread/thread_body_wrapper.h>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <sstream>
+#include <stdexcept>
+
+namespace gr {
+
+  scheduler_sptr
+  scheduler_pool::make(flat_flowgraph_sptr ffg, int max_noutput_items)
+  {
+    return scheduler_sptr(new scheduler_pool(ffg, max_noutput_items));
+  }
+
+  scheduler_pool::scheduler_pool(flat_flowgraph_sptr ffg,
+                                 int max_noutput_items)
+    : scheduler(ffg, max_noutput_items),
+      d_nqueued(0), d_nactive(0), d_next_worker(0), d_stopping(false)
+  {
+    prefs *p = prefs::singleton();
+    d_max_nmsgs = static_cast<size_t>(p->get_long("DEFAULT", "max_messages", 100));
+
+    long nthreads = p->get_long("DEFAULT", "pool_nthreads", 0);
+    if(nthreads <= 0)
+      nthreads = boost::thread::hardware_concurrency();
+    if(nthreads <= 0)
+      nthreads = 1;
+
+    basic_block_vector_t used_blocks = ffg->calc_used_blocks();
+    used_blocks = ffg->topological_sort(used_blocks);
+    block_vector_t blocks = flat_flowgraph::make_block_vector(used_blocks);
+
+    // Ensure that the done flag is clear on all blocks
+
+    for(size_t i = 0; i < blocks.size(); i++) {
+      blocks[i]->detail()->set_done(false);
+    }
+
+    // Create an executor for each block and hook the tpb_detail
+    // notifications so that progress by a neighbor queues it up.
+
+    for(size_t i = 0; i < blocks.size(); i++) {
+      // If set, use internal value instead of global value
+      int nmax = max_noutput_items;
+      if(blocks[i]->is_set_max_noutput_items())
+        nmax = blocks[i]->max_noutput_items();
+
+      task_sptr t(new task);
+      t->block = blocks[i];
+      t->exec = boost::shared_ptr<block_executor>(new block_executor(blocks[i], nmax));
+      t->state = IDLE;
+      blocks[i]->detail()->threaded = false;
+      blocks[i]->detail()->d_tpb.set_ready_callback(
+        boost::bind(&scheduler_pool::notify, this, t.get()));
+      d_tasks.push_back(t);
+    }
+    d_nactive = d_tasks.size();
+
+    for(long i = 0; i < nthreads; i++) {
+      worker_sptr w(new worker);
+      w->index = i;
+      d_workers.push_back(w);
+    }
+
+    // Everybody gets a first shot; sources will get things going.
+
+    for(size_t i = 0; i < d_tasks.size(); i++)
+      notify(d_tasks[i].get());
+
+    for(size_t i = 0; i < d_workers.size(); i++) {
+      std::stringstream name;
+      name << "thread-pool[" << i << "]";
+
+      d_threads.create_thread(
+        gr::thread::thread_body_wrapper<boost::function0<void> >
+          (boost::bind(&scheduler_pool::thread_body, this, i),
+           name.str()));
+    }
+  }
+
+  scheduler_pool::~scheduler_pool()
+  {
+    stop();
+    wait();
+  }
+
+  void
+  scheduler_pool::stop()
+  {
+    {
+      gr::thread::scoped_lock guard(d_mutex);
+      d_stopping = true;
+      d_cond.notify_all();
+    }
+    d_threads.interrupt_all();
+  }
+
+  void
+  scheduler_pool::wait()
+  {
+    d_threads.join_all();
+    teardown();
+  }
+
+  /*
+   * Detach from the block details and stop any blocks that did not
+   * finish on their own. Only called once the workers have exited.
+   * Forgets the tasks, so that a second call (from the destructor,
+   * after a new scheduler may have taken over the same details)
+   * leaves the blocks alone.
+   */
+  void
+  scheduler_pool::teardown()
+  {
+    for(size_t i = 0; i < d_tasks.size(); i++) {
+      task *t = d_tasks[i].get();
+      if(t->block->detail())
+        t->block->detail()->d_tpb.set_ready_callback(0);
+      t->exec.reset();                  // stop any drivers, etc.
+    }
+    d_tasks.clear();
+  }
+
+  /*
+   * Called by neighbors (through tpb_detail) and message posters
+   * whenever t may be able to make progress.
+   */
+  void
+  scheduler_pool::notify(task *t)
+  {
+    {
+      gr::thread::scoped_lock guard(t->mutex);
+      switch(t->state) {
+      case IDLE:
+        t->state = QUEUED;
+        break;
+      case RUNNING:
+        t->state = RUNNING_NOTIFIED;
+        return;
+      default:
+        return;
+      }
+    }
+    push(t, false);
+  }
+
+  /*
+   * Put t on the deque of the calling worker, or on the next worker
+   * in round-robin order when called from outside the pool. Workers
+   * take from the back of their own deque, so \p front defers t
+   * behind everything else already queued there.
+   */
+  void
+  scheduler_pool::push(task *t, bool front)
+  {
+    size_t which;
+    if(d_current_worker.get())
+      which = *d_current_worker;
+    else {
+      gr::thread::scoped_lock guard(d_mutex);
+      which = d_next_worker++ % d_workers.size();
+    }
+
+    worker *w = d_workers[which].get();
+    {
+      gr::thread::scoped_lock guard(w->mutex);
+      if(front)
+        w->queue.push_front(t);
+      else
+        w->queue.push_back(t);
+    }
+
+    gr::thread::scoped_lock guard(d_mutex);
+    d_nqueued++;
+    d_cond.notify_one();
+  }
+
+  /*
+   * Take the newest task from our own deque, or steal the oldest one
+   * from somebody else's. Returns 0 if all deques are empty.
+   */
+  scheduler_pool::task *
+  scheduler_pool::pop(size_t which)
+  {
+    task *t = 0;
+    size_t nworkers = d_workers.size();
+
+    for(size_t i = 0; i < nworkers && t == 0; i++) {
+      worker *w = d_workers[(which + i) % nworkers].get();
+      gr::thread::scoped_lock guard(w->mutex);
+      if(w->queue.empty())
+        continue;
+      if(i == 0) {
+        t = w->queue.back();
+        w->queue.pop_back();
+      }
+      else {
+        t = w->queue.front();
+        w->queue.pop_front();
+      }
+    }
+
+    if(t) {
+      gr::thread::scoped_lock guard(d_mutex);
+      d_nqueued--;
+    }
+    return t;
+  }
+
+  void
+  scheduler_pool::thread_body(size_t which)
+  {
+    d_current_worker.reset(new size_t(which));
+
+    while(1) {
+      boost::this_thread::interruption_point();
+
+      task *t = pop(which);
+      if(t) {
+        run_task(t);
+        continue;
+      }
+
+      gr::thread::scoped_lock guard(d_mutex);
+      while(d_nqueued == 0 && d_nactive > 0 && !d_stopping)
+        d_cond.wait(guard);
+      if(d_nactive == 0 || d_stopping)
+        return;
+    }
+  }
+
+  void
+  scheduler_pool::run_task(task *t)
+  {
+    block *b = t->block.get();
+    block_detail *d = b->detail().get();
+    block_executor::state s;
+
+    {
+      gr::thread::scoped_lock guard(t->mutex);
+      t->state = RUNNING;
+    }
+
+    handle_messages(b);
+
+    // run one iteration if we are a connected stream block
+    if(d->noutputs() > 0 || d->ninputs() > 0)
+      s = t->exec->run_one_iteration();
+    else
+      s = block_executor::BLKD_IN;
+
+    switch(s) {
+    case block_executor::READY:		// Tell neighbors we made progress.
+      d->d_tpb.notify_neighbors(d);
+      break;
+
+    case block_executor::READY_NO_OUTPUT:	// Notify upstream only
+      d->d_tpb.notify_upstream(d);
+      break;
+
+    case block_executor::DONE:		// Game over.
+      d->d_tpb.notify_neighbors(d);
+      finish_task(t);
+      return;
+
+    case block_executor::BLKD_IN:
+    case block_executor::BLKD_OUT:
+      {
+        // Go idle unless somebody poked us while we were running or
+        // messages arrived.
+        gr::thread::scoped_lock guard(t->mutex);
+        if(t->state == RUNNING && b->empty_handled_p()) {
+          t->state = IDLE;
+          return;
+        }
+        t->state = QUEUED;
+      }
+      push(t, true);
+      return;
+
+    default:
+      throw std::runtime_error("possible memory corruption in scheduler");
+    }
+
+    // We made progress, so we may be able to make more. Queue
+    // ourselves behind the neighbors we just woke up.
+    {
+      gr::thread::scoped_lock guard(t->mutex);
+      t->state = QUEUED;
+    }
+    push(t, true);
+  }
+
+  void
+  scheduler_pool::finish_task(task *t)
+  {
+    {
+      gr::thread::scoped_lock guard(t->mutex);
+      t->state = FINISHED;
+    }
+    t->exec.reset();			// stop any drivers, etc.
+
+    gr::thread::scoped_lock guard(d_mutex);
+    if(--d_nactive == 0)
+      d_cond.notify_all();
+  }
+
+  void
+  scheduler_pool::handle_messages(block *b)
+  {
+    pmt::pmt_t msg;
+
+    if(b->empty_p())
+      return;
+
+    BOOST_FOREACH(basic_block::msg_queue_map_t::value_type &i, b->msg_queue) {
+      if(b->has_msg_handler(i.first)) {
+        while((msg = b->delete_head_nowait(i.first))) {
+          tracer::trace(tracer::MSG_BEGIN, b->unique_id());
+          b->dispatch_msg(i.first, msg);
+          tracer::trace(tracer::MSG_END, b->unique_id());
+        }
+      }
+      else {
+        // If we don't have a handler but are building up messages,
+        // prune the queue from the front to keep memory in check.
+        if(b->nmsgs(i.first) > d_max_nmsgs)
+          msg = b->delete_head_nowait(i.first);
+      }
+    }
+  }
+
+} /* namespace gr */
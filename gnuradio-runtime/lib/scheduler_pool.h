@@ -0,0 +1,131 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDED_GR_SCHEDULER_POOL_H
+#define INCLUDED_GR_SCHEDULER_POOL_H
+
+#include <gnuradio/api.h>
+#include <gnuradio/thread/thread_group.h>
+#include <boost/thread/tss.hpp>
+#include <boost/shared_ptr.hpp>
+#include "scheduler.h"
+#include "block_executor.h"
+#include <deque>
+#include <vector>
+
+namespace gr {
+
+  /*!
+   * \brief Concrete scheduler that runs all blocks on a fixed pool
+   * of worker threads.
+   *
+   * Instead of dedicating a kernel thread to each block, blocks that
+   * are ready to run are placed on per-worker deques and executed by
+   * a fixed number of workers (the "pool_nthreads" option in the
+   * [DEFAULT] section of the preferences, or the number of hardware
+   * threads if unset). A worker runs the most recently readied block
+   * from its own deque and steals the oldest entry from another
+   * worker's deque when its own is empty.
+   *
+   * A block becomes ready when one of its neighbors signals progress
+   * through the tpb_detail notify_upstream/notify_downstream events,
+   * or when a message is posted to it.
+   *
+   * Per-block processor affinity and thread priority are not applied
+   * since blocks do not own a thread.
+   */
+  class GR_RUNTIME_API scheduler_pool : public scheduler
+  {
+    enum task_state {
+      IDLE,             // waiting on a notification
+      QUEUED,           // sitting in a worker's deque
+      RUNNING,          // being run by a worker
+      RUNNING_NOTIFIED, // being run, and notified while running
+      FINISHED          // block is done; never run again
+    };
+
+    struct task {
+      block_sptr                        block;
+      boost::shared_ptr<block_executor> exec;
+      gr::thread::mutex                 mutex;  //< protects state
+      task_state                        state;
+    };
+    typedef boost::shared_ptr<task> task_sptr;
+
+    struct worker {
+      gr::thread::mutex   mutex;          //< protects queue
+      std::deque<task *>  queue;
+      size_t              index;
+    };
+    typedef boost::shared_ptr<worker> worker_sptr;
+
+    std::vector<task_sptr>      d_tasks;
+    std::vector<worker_sptr>    d_workers;
+    gr::thread::thread_group    d_threads;
+    boost::thread_specific_ptr<size_t> d_current_worker;
+
+    gr::thread::mutex              d_mutex;    //< protects the vars below
+    gr::thread::condition_variable d_cond;
+    size_t                         d_nqueued;  // tasks in all worker deques
+    size_t                         d_nactive;  // tasks not yet FINISHED
+    size_t                         d_next_worker;
+    bool                           d_stopping;
+
+    size_t d_max_nmsgs;
+
+    void notify(task *t);
+    void push(task *t, bool front);
+    task *pop(size_t which);
+    void run_task(task *t);
+    void finish_task(task *t);
+    void handle_messages(block *b);
+    void thread_body(size_t which);
+    void teardown();
+
+  protected:
+    /*!
+     * \brief Construct a scheduler and begin evaluating the graph.
+     *
+     * The scheduler will continue running until all blocks until they
+     * report that they are done or the stop method is called.
+     */
+    scheduler_pool(flat_flowgraph_sptr ffg, int max_noutput_items);
+
+  public:
+    static scheduler_sptr make(flat_flowgraph_sptr ffg,
+                               int max_noutput_items=100000);
+
+    ~scheduler_pool();
+
+    /*!
+     * \brief Tell the scheduler to stop executing.
+     */
+    void stop();
+
+    /*!
+     * \brief Block until the graph is done.
+     */
+    void wait();
+  };
+
+} /* namespace gr */
+
+#endif /* INCLUDED_GR_SCHEDULER_POOL_H */
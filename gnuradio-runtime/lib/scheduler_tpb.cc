@@ -26,10 +26,22 @@
 #include "scheduler_tpb.h"
 #include "tpb_thread_body.h"
 #include <gnuradio/thread/thread_body_wrapper.h>
+#include <set>
 #include <sstream>
 
 namespace gr {
   
+  // Clears block_detail::threaded however the thread body exits, so
+  // that nobody tries to rebind a thread that is gone.
+  class tpb_threaded_guard
+  {
+    block_detail *d_detail;
+
+  public:
+    tpb_threaded_guard(block_detail *detail) : d_detail(detail) {}
+    ~tpb_threaded_guard() { d_detail->threaded = false; }
+  };
+
   class tpb_container
   {
     block_sptr d_block;
@@ -41,6 +53,7 @@ namespace gr {
 
     void operator()()
     {
+      tpb_threaded_guard guard(d_block->detail().get());
       tpb_thread_body body(d_block, d_max_noutput_items);
     }
   };
@@ -53,7 +66,8 @@ namespace gr {
 
   scheduler_tpb::scheduler_tpb(flat_flowgraph_sptr ffg,
                                int max_noutput_items)
-    : scheduler(ffg, max_noutput_items)
+    : scheduler(ffg, max_noutput_items),
+      d_restarting(0), d_max_noutput_items(max_noutput_items), d_nstarted(0)
   {
     // Get a topologically sorted vector of all the blocks in use.
     // Being topologically sorted probably isn't going to matter, but
@@ -63,6 +77,12 @@ namespace gr {
     used_blocks = ffg->topological_sort(used_blocks);
     block_vector_t blocks = flat_flowgraph::make_block_vector(used_blocks);
 
+    start_blocks(blocks);
+  }
+
+  void
+  scheduler_tpb::start_blocks(const block_vector_t &blocks)
+  {
     // Ensure that the done flag is clear on all blocks
 
     for(size_t i = 0; i < blocks.size(); i++) {
@@ -71,21 +91,53 @@ namespace gr {
 
     // Fire off a thead for each block
 
-    for(size_t i = 0; i < blocks.size(); i++) {
-      std::stringstream name;
-      name << "thread-per-block[" << i << "]: " << blocks[i];
-
-      // If set, use internal value instead of global value
-      if(blocks[i]->is_set_max_noutput_items())
-        max_noutput_items = blocks[i]->max_noutput_items();
-    
-      d_threads.create_thread(
-	    gr::thread::thread_body_wrapper<tpb_container>
-            (tpb_container(blocks[i], max_noutput_items),
-             name.str()));
+    for(size_t i = 0; i < blocks.size(); i++)
+      start_block(blocks[i]);
+
+    // End the restart stop_blocks began, if any.
+    gr::thread::scoped_lock guard(d_mutex);
+    if(d_restarting > 0) {
+      d_restarting--;
+      d_joined.notify_all();
     }
   }
 
+  void
+  scheduler_tpb::start_block(block_sptr block)
+  {
+    std::stringstream name;
+    name << "thread-per-block[" << d_nstarted++ << "]: " << block;
+
+    // If set, use internal value instead of global value
+    int max_noutput_items = d_max_noutput_items;
+    if(block->is_set_max_noutput_items())
+      max_noutput_items = block->max_noutput_items();
+
+    block_thread t;
+    t.owner = block.get();
+    t.joining = false;
+    t.thread = boost::shared_ptr<gr::thread::thread>(
+      new gr::thread::thread(gr::thread::thread_body_wrapper<tpb_container>
+                             (tpb_container(block, max_noutput_items),
+                              name.str())));
+
+    gr::thread::scoped_lock guard(d_mutex);
+    d_threads.push_back(t);
+  }
+
+  // Forget a thread we are done joining; called with d_mutex held.
+  void
+  scheduler_tpb::joined(gr::thread::thread *thread)
+  {
+    for(std::list<block_thread>::iterator t = d_threads.begin(); t != d_threads.end(); t++) {
+      if(t->thread.get() == thread) {
+        d_threads.erase(t);
+        break;
+      }
+    }
+    d_joined.notify_all();
+  }
+
   scheduler_tpb::~scheduler_tpb()
   {
     stop();
@@ -94,13 +146,75 @@ namespace gr {
   void
   scheduler_tpb::stop()
   {
-    d_threads.interrupt_all();
+    gr::thread::scoped_lock guard(d_mutex);
+    for(std::list<block_thread>::iterator t = d_threads.begin(); t != d_threads.end(); t++)
+      t->thread->interrupt();
   }
 
   void
   scheduler_tpb::wait()
   {
-    d_threads.join_all();
+    gr::thread::scoped_lock guard(d_mutex);
+    while(!d_threads.empty() || d_restarting > 0) {
+      std::list<block_thread>::iterator t = d_threads.begin();
+      while(t != d_threads.end() && t->joining)
+        t++;
+
+      // Everything left is being joined by stop_blocks, or the
+      // blocks of a restart have yet to be started.
+      if(t == d_threads.end()) {
+        d_joined.wait(guard);
+        continue;
+      }
+
+      boost::shared_ptr<gr::thread::thread> thread = t->thread;
+      t->joining = true;
+      guard.unlock();
+      thread->join();
+      guard.lock();
+      joined(thread.get());
+    }
+  }
+
+  bool
+  scheduler_tpb::stop_blocks(const block_vector_t &blocks)
+  {
+    std::set<block*> stopping;
+    for(size_t i = 0; i < blocks.size(); i++)
+      stopping.insert(blocks[i].get());
+
+    // Interrupt them all before joining any, so they wind down in
+    // parallel.
+    std::vector<boost::shared_ptr<gr::thread::thread> > threads;
+    gr::thread::scoped_lock guard(d_mutex);
+    d_restarting++;
+    for(std::list<block_thread>::iterator t = d_threads.begin(); t != d_threads.end(); t++) {
+      if(!stopping.count(t->owner))
+        continue;
+      t->thread->interrupt();
+      if(!t->joining) {
+        t->joining = true;
+        threads.push_back(t->thread);
+      }
+    }
+
+    guard.unlock();
+    for(size_t i = 0; i < threads.size(); i++)
+      threads[i]->join();
+    guard.lock();
+    for(size_t i = 0; i < threads.size(); i++)
+      joined(threads[i].get());
+
+    // Wait for any that wait() was already joining.
+    for(;;) {
+      std::list<block_thread>::iterator t = d_threads.begin();
+      while(t != d_threads.end() && !stopping.count(t->owner))
+        t++;
+      if(t == d_threads.end())
+        break;
+      d_joined.wait(guard);
+    }
+    return true;
   }
 
 } /* namespace gr */
@@ -23,8 +23,9 @@
 #define INCLUDED_GR_SCHEDULER_TPB_H
 
 #include <gnuradio/api.h>
-#include <gnuradio/thread/thread_group.h>
+#include <gnuradio/thread/thread.h>
 #include "scheduler.h"
+#include <list>
 
 namespace gr {
 
@@ -33,7 +34,29 @@ namespace gr {
    */
   class GR_RUNTIME_API scheduler_tpb : public scheduler
   {
-    gr::thread::thread_group d_threads;
+    struct block_thread {
+      block                                  *owner;
+      boost::shared_ptr<gr::thread::thread>   thread;
+      bool                                    joining; // somebody is joining it
+    };
+
+    // Threads that haven't been joined yet. Threads come and go while
+    // the graph runs (stop_blocks, start_blocks), possibly while
+    // another thread is in wait().
+    gr::thread::mutex              d_mutex;        //< protects d_threads
+    gr::thread::condition_variable d_joined;
+    std::list<block_thread>        d_threads;
+
+    // stop_blocks calls not yet followed by start_blocks. wait()
+    // doesn't return while a restart is in progress, even if it
+    // stopped every thread.
+    int d_restarting;
+
+    int d_max_noutput_items;
+    size_t d_nstarted;
+
+    void start_block(block_sptr block);
+    void joined(gr::thread::thread *thread);
 
   protected:
     /*!
@@ -59,6 +82,19 @@ namespace gr {
      * \brief Block until the graph is done.
      */
     void wait();
+
+    /*!
+     * \brief Interrupt the threads of \p blocks and join them.
+     *
+     * Must be followed by start_blocks(), with the blocks to run
+     * again (if any), to end the restart.
+     */
+    bool stop_blocks(const block_vector_t &blocks);
+
+    /*!
+     * \brief Fire off a thread for each of \p blocks.
+     */
+    void start_blocks(const block_vector_t &blocks);
   };
 
 } /* namespace gr */
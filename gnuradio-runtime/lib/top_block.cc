@@ -127,6 +127,30 @@ namespace gr {
     d_impl->set_max_noutput_items(nmax);
   }
 
+  void
+  top_block::set_auto_affinity(bool on)
+  {
+    d_impl->set_auto_affinity(on);
+  }
+
+  bool
+  top_block::auto_affinity()
+  {
+    return d_impl->auto_affinity();
+  }
+
+  void
+  top_block::reserve_cores(const std::vector<int> &cores)
+  {
+    d_impl->reserve_cores(cores);
+  }
+
+  std::vector<int>
+  top_block::reserved_cores()
+  {
+    return d_impl->reserved_cores();
+  }
+
   top_block_sptr
   top_block::to_top_block()
   {
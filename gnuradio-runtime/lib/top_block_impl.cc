@@ -28,9 +28,15 @@
 #include "flat_flowgraph.h"
 #include "scheduler_sts.h"
 #include "scheduler_tpb.h"
+#include "scheduler_pool.h"
+#include "scheduler_cluster.h"
+#include "cpu_topology.h"
 #include <gnuradio/top_block.h>
 #include <gnuradio/prefs.h>
 
+#include <algorithm>
+#include <map>
+#include <set>
 #include <stdexcept>
 #include <iostream>
 #include <string.h>
@@ -49,7 +55,9 @@ namespace gr {
     scheduler_maker f;
   } scheduler_table[] = {
     { "TPB", scheduler_tpb::make },    // first entry is default
-    { "STS", scheduler_sts::make }
+    { "STS", scheduler_sts::make },
+    { "POOL", scheduler_pool::make },
+    { "CLUSTER", scheduler_cluster::make }
   };
 
   static scheduler_sptr
@@ -79,9 +87,13 @@ namespace gr {
   }
 
   top_block_impl::top_block_impl(top_block *owner)
-    : d_owner(owner), d_ffg(),
+    : d_owner(owner), d_ffg(), d_replacing(false),
       d_state(IDLE), d_lock_count(0)
   {
+    prefs *p = prefs::singleton();
+    d_incremental = p->get_bool("DEFAULT", "incremental_reconfig", true);
+    d_auto_affinity = p->get_bool("DEFAULT", "auto_affinity", false);
+    d_reserved_cores = cpu_topology::parse_cpu_list(p->get_string("DEFAULT", "reserved_cores", ""));
   }
 
   top_block_impl::~top_block_impl()
@@ -105,8 +117,13 @@ namespace gr {
     // Create new flat flow graph by flattening hierarchy
     d_ffg = d_owner->flatten();
 
-    // Validate new simple flow graph and wire it up
+    // Validate new simple flow graph, fuse what can be fused, pin
+    // its threads and wire it up. Placement comes first so that
+    // buffers are allocated on the NUMA node of the block writing
+    // them.
     d_ffg->validate();
+    d_ffg->fuse_sync_blocks();
+    place_blocks();
     d_ffg->setup_connections();
 
     // Only export perf. counters if ControlPort config param is
@@ -115,22 +132,51 @@ namespace gr {
     if(p->get_bool("ControlPort", "on", false) && p->get_bool("PerfCounters", "export", false))
       d_ffg->enable_pc_rpc();
 
-    d_scheduler = make_scheduler(d_ffg, d_max_noutput_items);
+    scheduler_sptr s = make_scheduler(d_ffg, d_max_noutput_items);
+    {
+      gr::thread::scoped_lock guard(d_sched_mutex);
+      d_scheduler = s;
+    }
     d_state = RUNNING;
   }
 
   void
   top_block_impl::stop()
   {
-    if(d_scheduler)
-      d_scheduler->stop();
+    scheduler_sptr s;
+    {
+      gr::thread::scoped_lock guard(d_sched_mutex);
+      s = d_scheduler;
+    }
+    if(s)
+      s->stop();
   }
 
+  /*
+   * A full restart stops the running scheduler and replaces it. A
+   * wait() caught in the middle must not return, nor touch the old
+   * scheduler after restart() drops it, so it holds its own
+   * reference and moves on to the replacement.
+   */
   void
   top_block_impl::wait()
   {
-    if(d_scheduler)
-      d_scheduler->wait();
+    scheduler_sptr s;
+    {
+      gr::thread::scoped_lock guard(d_sched_mutex);
+      s = d_scheduler;
+    }
+
+    while(s) {
+      s->wait();
+
+      gr::thread::scoped_lock guard(d_sched_mutex);
+      while(d_replacing)
+        d_sched_cond.wait(guard);
+      if(d_scheduler == s)
+        break;
+      s = d_scheduler;
+    }
 
     d_state = IDLE;
   }
@@ -163,21 +209,71 @@ namespace gr {
 
   /*
    * restart is called with d_mutex held
+   *
+   * Only the blocks that the new flowgraph adds, removes or connects
+   * differently are stopped, rewired and started again; the others
+   * keep running throughout. Schedulers that can't stop single blocks
+   * get stopped and replaced as a whole.
    */
   void
   top_block_impl::restart()
   {
-    stop();		     // Stop scheduler and wait for completion
-    wait();
-
     // Create new simple flow graph
     flat_flowgraph_sptr new_ffg = d_owner->flatten();
     new_ffg->validate();		 // check consistency, sanity, etc
-    new_ffg->merge_connections(d_ffg);   // reuse buffers, etc
-    d_ffg = new_ffg;
+    new_ffg->fuse_sync_blocks(d_ffg);
+    flat_flowgraph_sptr old_ffg = d_ffg;
+
+    basic_block_vector_t stopping, starting;
+    new_ffg->calc_changed_blocks(old_ffg, stopping, starting);
+
+    if(d_incremental
+       && d_scheduler->stop_blocks(flat_flowgraph::make_block_vector(stopping))) {
+      basic_block_vector_t changed = stopping;
+      changed.insert(changed.end(), starting.begin(), starting.end());
+
+      try {
+        d_ffg = new_ffg;
+        place_blocks(starting);
+        d_ffg->merge_connections(old_ffg, changed);
+      }
+      catch(...) {
+        // End the restart, so that wait() doesn't hang on it.
+        d_scheduler->start_blocks(block_vector_t());
+        throw;
+      }
+      d_scheduler->start_blocks(flat_flowgraph::make_block_vector(starting));
+      return;
+    }
+
+    {
+      gr::thread::scoped_lock guard(d_sched_mutex);
+      d_replacing = true;
+    }
+
+    scheduler_sptr s;
+    try {
+      d_scheduler->stop();   // Stop scheduler and wait for completion
+      d_scheduler->wait();
+
+      d_ffg = new_ffg;
+      place_blocks(starting);
+      d_ffg->merge_connections(old_ffg);   // reuse buffers, etc
+
+      // Create a new scheduler to execute it
+      s = make_scheduler(d_ffg, d_max_noutput_items);
+    }
+    catch(...) {
+      gr::thread::scoped_lock guard(d_sched_mutex);
+      d_replacing = false;
+      d_sched_cond.notify_all();
+      throw;
+    }
 
-    // Create a new scheduler to execute it
-    d_scheduler = make_scheduler(d_ffg, d_max_noutput_items);
+    gr::thread::scoped_lock guard(d_sched_mutex);
+    d_scheduler = s;
+    d_replacing = false;
+    d_sched_cond.notify_all();
     d_state = RUNNING;
   }
 
@@ -218,4 +314,241 @@ namespace gr {
     d_max_noutput_items = nmax;
   }
 
+  void
+  top_block_impl::set_auto_affinity(bool on)
+  {
+    gr::thread::scoped_lock lock(d_mutex);
+    d_auto_affinity = on;
+  }
+
+  bool
+  top_block_impl::auto_affinity()
+  {
+    return d_auto_affinity;
+  }
+
+  void
+  top_block_impl::reserve_cores(const std::vector<int> &cores)
+  {
+    gr::thread::scoped_lock lock(d_mutex);
+    d_reserved_cores = cores;
+  }
+
+  std::vector<int>
+  top_block_impl::reserved_cores()
+  {
+    gr::thread::scoped_lock lock(d_mutex);
+    return d_reserved_cores;
+  }
+
+  /*
+   * The cpus blocks may be pinned to, one vector per last level
+   * cache, leaving out the reserved cores.
+   */
+  std::vector<std::vector<int> >
+  top_block_impl::placement_groups(size_t &ncpus)
+  {
+    std::vector<std::vector<int> > groups;
+    std::vector<std::vector<int> > all = cpu_topology().cache_groups();
+    ncpus = 0;
+    for(size_t g = 0; g < all.size(); g++) {
+      std::vector<int> cpus;
+      for(size_t i = 0; i < all[g].size(); i++) {
+        if(std::find(d_reserved_cores.begin(), d_reserved_cores.end(), all[g][i])
+           == d_reserved_cores.end())
+          cpus.push_back(all[g][i]);
+      }
+      if(!cpus.empty()) {
+        groups.push_back(cpus);
+        ncpus += cpus.size();
+      }
+    }
+    return groups;
+  }
+
+  /*
+   * Pin the thread of every block that has no processor affinity of
+   * its own. Blocks are handed out in the topological order of each
+   * connected piece of the graph, so neighbours land on neighbouring
+   * cpus, and cpus are handed out one last level cache at a time. A
+   * piece that fits in one cache is not split across two if there
+   * is room to avoid it. With more blocks than cpus, runs of
+   * consecutive blocks share a cpu.
+   *
+   * Called with d_mutex held, before the new flat flowgraph is wired
+   * up.
+   */
+  void
+  top_block_impl::place_blocks()
+  {
+    // Forget the previous placement; the graph may have changed.
+    for(size_t i = 0; i < d_placed.size(); i++) {
+      block_sptr b = d_placed[i].first.lock();
+      if(b && b->processor_affinity() == std::vector<int>(1, d_placed[i].second))
+        b->unset_processor_affinity();
+    }
+    d_placed.clear();
+
+    if(!d_auto_affinity)
+      return;
+
+    size_t ncpus;
+    std::vector<std::vector<int> > groups = placement_groups(ncpus);
+    if(ncpus == 0)
+      return;
+
+    std::vector<block_vector_t> pieces;
+    size_t nblocks = 0;
+    std::vector<basic_block_vector_t> parts = d_ffg->partition();
+    for(size_t p = 0; p < parts.size(); p++) {
+      block_vector_t piece;
+      for(size_t i = 0; i < parts[p].size(); i++) {
+        block_sptr b = cast_to_block_sptr(parts[p][i]);
+        if(b && b->processor_affinity().empty())
+          piece.push_back(b);
+      }
+      if(!piece.empty()) {
+        pieces.push_back(piece);
+        nblocks += piece.size();
+      }
+    }
+
+    if(nblocks > ncpus) {
+      std::vector<int> cpus;
+      for(size_t g = 0; g < groups.size(); g++)
+        cpus.insert(cpus.end(), groups[g].begin(), groups[g].end());
+
+      size_t n = 0;
+      for(size_t p = 0; p < pieces.size(); p++) {
+        for(size_t i = 0; i < pieces[p].size(); i++, n++) {
+          int cpu = cpus[n * ncpus / nblocks];
+          pieces[p][i]->set_processor_affinity(std::vector<int>(1, cpu));
+          d_placed.push_back(std::make_pair(boost::weak_ptr<block>(pieces[p][i]), cpu));
+        }
+      }
+    }
+    else {
+      size_t g = 0, slot = 0;
+      size_t nfree = ncpus, nleft = nblocks;
+      for(size_t p = 0; p < pieces.size(); p++) {
+        size_t n = pieces[p].size();
+        size_t room = groups[g].size() - slot;
+        if(slot > 0 && n > room && g + 1 < groups.size()
+           && n <= groups[g+1].size() && nfree - room >= nleft) {
+          nfree -= room;
+          g++;
+          slot = 0;
+        }
+
+        for(size_t i = 0; i < n; i++) {
+          int cpu = groups[g][slot];
+          pieces[p][i]->set_processor_affinity(std::vector<int>(1, cpu));
+          d_placed.push_back(std::make_pair(boost::weak_ptr<block>(pieces[p][i]), cpu));
+          nfree--;
+          nleft--;
+          if(++slot == groups[g].size()) {
+            g++;
+            slot = 0;
+          }
+        }
+      }
+    }
+
+    if(GR_TOP_BLOCK_IMPL_DEBUG) {
+      for(size_t i = 0; i < d_placed.size(); i++) {
+        block_sptr b = d_placed[i].first.lock();
+        std::cout << "place_blocks: " << b->alias() << " -> cpu " << d_placed[i].second << std::endl;
+      }
+    }
+  }
+
+  /*
+   * Placement on restart. Blocks that stay in the graph keep their
+   * cpu, since their threads run on and their buffers were allocated
+   * on that cpu's NUMA node. Blocks that left the graph are unpinned.
+   * Of the blocks in \p starting, those not placed yet and without an
+   * affinity of their own each go to the least loaded cpu, preferring
+   * the last level cache of the blocks already placed in the same
+   * piece of the graph.
+   *
+   * Called with d_mutex held, before the new flat flowgraph is wired
+   * up.
+   */
+  void
+  top_block_impl::place_blocks(const basic_block_vector_t &starting)
+  {
+    std::vector<basic_block_vector_t> parts = d_ffg->partition();
+    std::set<basic_block_sptr> in_graph;
+    for(size_t p = 0; p < parts.size(); p++)
+      in_graph.insert(parts[p].begin(), parts[p].end());
+
+    std::vector<std::pair<boost::weak_ptr<block>, int> > kept;
+    for(size_t i = 0; i < d_placed.size(); i++) {
+      block_sptr b = d_placed[i].first.lock();
+      if(!b)
+        continue;
+      if(in_graph.count(b) && b->processor_affinity() == std::vector<int>(1, d_placed[i].second))
+        kept.push_back(d_placed[i]);
+      else if(b->processor_affinity() == std::vector<int>(1, d_placed[i].second))
+        b->unset_processor_affinity();
+    }
+    d_placed.swap(kept);
+
+    if(!d_auto_affinity)
+      return;
+
+    size_t ncpus;
+    std::vector<std::vector<int> > groups = placement_groups(ncpus);
+    if(ncpus == 0)
+      return;
+
+    std::map<int, size_t> load;
+    std::map<int, size_t> group_of;
+    for(size_t g = 0; g < groups.size(); g++)
+      for(size_t i = 0; i < groups[g].size(); i++) {
+        load[groups[g][i]] = 0;
+        group_of[groups[g][i]] = g;
+      }
+    std::map<block_sptr, int> placed;
+    for(size_t i = 0; i < d_placed.size(); i++) {
+      placed[d_placed[i].first.lock()] = d_placed[i].second;
+      if(load.count(d_placed[i].second))
+        load[d_placed[i].second]++;
+    }
+
+    std::set<basic_block_sptr> todo(starting.begin(), starting.end());
+    for(size_t p = 0; p < parts.size(); p++) {
+      int home = -1;
+      for(size_t i = 0; i < parts[p].size() && home < 0; i++) {
+        std::map<block_sptr, int>::iterator q = placed.find(cast_to_block_sptr(parts[p][i]));
+        if(q != placed.end() && group_of.count(q->second))
+          home = group_of[q->second];
+      }
+
+      for(size_t i = 0; i < parts[p].size(); i++) {
+        block_sptr b = cast_to_block_sptr(parts[p][i]);
+        if(!b || !todo.count(parts[p][i]) || placed.count(b) || !b->processor_affinity().empty())
+          continue;
+
+        int cpu = -1;
+        for(std::map<int, size_t>::iterator c = load.begin(); c != load.end(); c++) {
+          if(cpu < 0 || c->second < load[cpu]
+             || (c->second == load[cpu] && (int)group_of[c->first] == home
+                 && (int)group_of[cpu] != home))
+            cpu = c->first;
+        }
+        if(home < 0)
+          home = group_of[cpu];
+
+        b->set_processor_affinity(std::vector<int>(1, cpu));
+        d_placed.push_back(std::make_pair(boost::weak_ptr<block>(b), cpu));
+        placed[b] = cpu;
+        load[cpu]++;
+
+        if(GR_TOP_BLOCK_IMPL_DEBUG)
+          std::cout << "place_blocks: " << b->alias() << " -> cpu " << cpu << std::endl;
+      }
+    }
+  }
+
 } /* namespace gr */
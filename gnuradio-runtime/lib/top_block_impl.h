@@ -26,6 +26,8 @@
 #include <gnuradio/api.h>
 #include "scheduler.h"
 #include <gnuradio/thread/thread.h>
+#include <boost/weak_ptr.hpp>
+#include <vector>
 
 namespace gr {
 
@@ -72,6 +74,14 @@ namespace gr {
     // Set the maximum number of noutput_items in the flowgraph
     void set_max_noutput_items(int nmax);
 
+    // Turn automatic thread placement on or off
+    void set_auto_affinity(bool on);
+    bool auto_affinity();
+
+    // Keep cores out of automatic thread placement
+    void reserve_cores(const std::vector<int> &cores);
+    std::vector<int> reserved_cores();
+
   protected:
     enum tb_state { IDLE, RUNNING };
 
@@ -79,13 +89,31 @@ namespace gr {
     flat_flowgraph_sptr d_ffg;
     scheduler_sptr d_scheduler;
 
+    // d_sched_mutex protects d_scheduler and d_replacing, so that
+    // wait() can follow the scheduler a full restart replaces
+    gr::thread::mutex d_sched_mutex;
+    gr::thread::condition_variable d_sched_cond;
+    bool d_replacing;
+
     gr::thread::mutex d_mutex;    // protects d_state and d_lock_count
     tb_state d_state;
     int d_lock_count;
     int d_max_noutput_items;
 
+    // rewire only the changed blocks on unlock()
+    bool d_incremental;
+
+    bool d_auto_affinity;
+    std::vector<int> d_reserved_cores;
+
+    // blocks pinned by place_blocks() and the cpu each one got
+    std::vector<std::pair<boost::weak_ptr<block>, int> > d_placed;
+
   private:
     void restart();
+    void place_blocks();
+    void place_blocks(const basic_block_vector_t &starting);
+    std::vector<std::vector<int> > placement_groups(size_t &ncpus);
   };
 
 } /* namespace gr */
@@ -25,6 +25,7 @@
 
 #include "tpb_thread_body.h"
 #include <gnuradio/prefs.h>
+#include <gnuradio/tracer.h>
 #include <boost/thread.hpp>
 #include <boost/foreach.hpp>
 #include <pmt/pmt.h>
@@ -32,6 +33,74 @@
 
 namespace gr {
 
+  static block::wait_policy_t
+  wait_policy_from_string(const std::string &name)
+  {
+    if(name == "spin")
+      return block::WP_SPIN;
+    if(name == "spin_yield")
+      return block::WP_SPIN_YIELD;
+    if(name == "spin_block")
+      return block::WP_SPIN_BLOCK;
+    if(name != "block")
+      std::cerr << "tpb_thread_body: unknown wait_policy \"" << name
+                << "\"; using \"block\"" << std::endl;
+    return block::WP_BLOCK;
+  }
+
+  /*
+   * Poll our tpb_detail for up to nspins rounds, waiting for a
+   * neighbor to signal a change (input or output, depending on \p
+   * input) or for a message to arrive, without entering the kernel.
+   * Returns true if something changed.
+   */
+  static bool
+  spin_for_change(block *b, block_detail *d, bool input, int nspins)
+  {
+    for(int i = 0; i < nspins; i++) {
+      if(input ? d->d_tpb.input_changed_p() : d->d_tpb.output_changed_p())
+        return true;
+      if(!b->empty_handled_p())
+        return true;
+      gr::thread::cpu_relax();
+    }
+    return false;
+  }
+
+  void
+  tpb_thread_body::handle_messages(block *b, size_t max_nmsgs,
+                                   gr::thread::scoped_lock *guard)
+  {
+    pmt::pmt_t msg;
+
+    // One load tells us whether any port has something queued.
+    if(b->empty_p())
+      return;
+
+    BOOST_FOREACH(basic_block::msg_queue_map_t::value_type &i, b->msg_queue) {
+      // Check if we have a message handler attached before getting
+      // any messages. This is mostly a protection for the unknown
+      // startup sequence of the threads.
+      if(b->has_msg_handler(i.first)) {
+        while((msg = b->delete_head_nowait(i.first))) {
+          if(guard)
+            guard->unlock();		// release lock while processing msg
+          tracer::trace(tracer::MSG_BEGIN, b->unique_id());
+          b->dispatch_msg(i.first, msg);
+          tracer::trace(tracer::MSG_END, b->unique_id());
+          if(guard)
+            guard->lock();
+        }
+      }
+      else {
+        // If we don't have a handler but are building up messages,
+        // prune the queue from the front to keep memory in check.
+        if(b->nmsgs(i.first) > max_nmsgs)
+          msg = b->delete_head_nowait(i.first);
+      }
+    }
+  }
+
   tpb_thread_body::tpb_thread_body(block_sptr block, int max_noutput_items)
     : d_exec(block, max_noutput_items)
   {
@@ -39,13 +108,16 @@ namespace gr {
 
     block_detail *d = block->detail().get();
     block_executor::state s;
-    pmt::pmt_t msg;
 
     d->threaded = true;
     d->thread = gr::thread::get_current_thread_id();
 
     prefs *p = prefs::singleton();
     size_t max_nmsgs = static_cast<size_t>(p->get_long("DEFAULT", "max_messages", 100));
+    block::wait_policy_t default_wp =
+      wait_policy_from_string(p->get_string("DEFAULT", "wait_policy", "block"));
+    int nspins = static_cast<int>(p->get_long("DEFAULT", "wait_spin_count", 1000));
+    block::wait_policy_t wp;
 
     // Set thread affinity if it was set before fg was started.
     if(block->processor_affinity().size() > 0) {
@@ -61,22 +133,7 @@ namespace gr {
       boost::this_thread::interruption_point();
 
       // handle any queued up messages
-      BOOST_FOREACH(basic_block::msg_queue_map_t::value_type &i, block->msg_queue) {
-        // Check if we have a message handler attached before getting
-        // any messages. This is mostly a protection for the unknown
-        // startup sequence of the threads.
-        if(block->has_msg_handler(i.first)) {
-          while((msg = block->delete_head_nowait(i.first))) {
-            block->dispatch_msg(i.first,msg);
-          }
-        }
-        else {
-          // If we don't have a handler but are building up messages,
-          // prune the queue from the front to keep memory in check.
-          if(block->nmsgs(i.first) > max_nmsgs)
-            msg = block->delete_head_nowait(i.first);
-        }
-      }
+      handle_messages(block.get(), max_nmsgs);
 
       d->d_tpb.clear_changed();
       // run one iteration if we are a connected stream block
@@ -102,6 +159,22 @@ namespace gr {
 
       case block_executor::BLKD_IN:		// Wait for input.
       {
+        wp = block->wait_policy();
+        if(wp == block::WP_DEFAULT)
+          wp = default_wp;
+        if(wp != block::WP_BLOCK) {
+          bool changed = spin_for_change(block.get(), d, true, nspins);
+          if(!changed && wp == block::WP_SPIN_YIELD)
+            boost::this_thread::yield();
+          if(changed || wp != block::WP_SPIN_BLOCK) {
+            // a message that woke us may have told us to stop
+            handle_messages(block.get(), max_nmsgs);
+            if(d->done())
+              return;
+            break;                      // go around again without sleeping
+          }
+        }
+
         gr::thread::scoped_lock guard(d->d_tpb.mutex);
         while(!d->d_tpb.input_changed) {
 
@@ -110,21 +183,7 @@ namespace gr {
             d->d_tpb.input_cond.wait(guard);
 
           // handle all pending messages
-          BOOST_FOREACH(basic_block::msg_queue_map_t::value_type &i, block->msg_queue) {
-            if(block->has_msg_handler(i.first)) {
-                while((msg = block->delete_head_nowait(i.first))) {
-                  guard.unlock();			// release lock while processing msg
-                  block->dispatch_msg(i.first, msg);
-                  guard.lock();
-                }
-            } 
-            else {
-                // leave msg in queue if no handler is defined
-                // start dropping if we have too many
-                if(block->nmsgs(i.first) > max_nmsgs)
-                    msg = block->delete_head_nowait(i.first);
-            }
-          }
+          handle_messages(block.get(), max_nmsgs, &guard);
 	  if (d->done()) {
 	    return;
 	  }
@@ -134,6 +193,22 @@ namespace gr {
 
       case block_executor::BLKD_OUT:	// Wait for output buffer space.
       {
+        wp = block->wait_policy();
+        if(wp == block::WP_DEFAULT)
+          wp = default_wp;
+        if(wp != block::WP_BLOCK) {
+          bool changed = spin_for_change(block.get(), d, false, nspins);
+          if(!changed && wp == block::WP_SPIN_YIELD)
+            boost::this_thread::yield();
+          if(changed || wp != block::WP_SPIN_BLOCK) {
+            // a message that woke us may have told us to stop
+            handle_messages(block.get(), max_nmsgs);
+            if(d->done())
+              return;
+            break;                      // go around again without sleeping
+          }
+        }
+
 	gr::thread::scoped_lock guard(d->d_tpb.mutex);
 	while(!d->d_tpb.output_changed) {
 	  // wait for output room or message
@@ -141,21 +216,10 @@ namespace gr {
 	    d->d_tpb.output_cond.wait(guard);
 
 	  // handle all pending messages
-          BOOST_FOREACH(basic_block::msg_queue_map_t::value_type &i, block->msg_queue) {
-            if(block->has_msg_handler(i.first)) {
-                while((msg = block->delete_head_nowait(i.first))) {
-                  guard.unlock();			// release lock while processing msg
-                  block->dispatch_msg(i.first, msg);
-                  guard.lock();
-                }
-            } 
-            else {
-                // leave msg in queue if no handler is defined
-                // start dropping if we have too many
-                if(block->nmsgs(i.first) > max_nmsgs)
-                    msg = block->delete_head_nowait(i.first);
-                }
-            }
+	  handle_messages(block.get(), max_nmsgs, &guard);
+	  if (d->done()) {
+	    return;
+	  }
         }
       }
       break;
@@ -39,6 +39,14 @@ namespace gr {
   {
     block_executor d_exec;
 
+    /*
+     * Dispatch the messages queued on ports with handlers and prune
+     * ports without. If guard is given it is released while each
+     * handler runs.
+     */
+    static void handle_messages(block *b, size_t max_nmsgs,
+                                gr::thread::scoped_lock *guard=0);
+
   public:
     tpb_thread_body(block_sptr block, int max_noutput_items=100000);
     ~tpb_thread_body();
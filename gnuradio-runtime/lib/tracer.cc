@@ -0,0 +1,344 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gnuradio/tracer.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/prefs.h>
+#include <gnuradio/thread/thread.h>
+#include <gnuradio/thread/atomic.h>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace gr {
+
+  namespace {
+
+    struct trace_event {
+      high_res_timer_type	ts;
+      long			block;
+      long			arg;
+      int			type;
+    };
+
+    /*
+     * One per thread. Only the owning thread writes; it fills the
+     * slot at head and then publishes it by bumping head. Readers
+     * copy without stopping the writer and afterwards throw away
+     * whatever the writer may have overwritten in the meantime.
+     */
+    struct trace_ring {
+      std::vector<trace_event>	events;
+      size_t			mask;
+      size_t			head;
+      size_t			floor;	// events before this were cleared
+      int			tid;
+      bool			in_use;	// owned by a live thread
+    };
+
+    typedef boost::shared_ptr<trace_ring> trace_ring_sptr;
+
+    gr::thread::mutex			s_mutex;	// protects everything below
+    std::vector<trace_ring_sptr>	s_rings;
+    std::map<long, std::string>		s_names;
+    bool				s_configured = false;
+
+    // Called on thread exit: the ring, and its events, stay around
+    // for the next thread that needs one.
+    void
+    release_ring(trace_ring *r)
+    {
+      gr::thread::scoped_lock guard(s_mutex);
+      r->in_use = false;
+    }
+
+    boost::thread_specific_ptr<trace_ring> &
+    thread_ring()
+    {
+      static boost::thread_specific_ptr<trace_ring> r(release_ring);
+      return r;
+    }
+
+    trace_ring *
+    acquire_ring()
+    {
+      gr::thread::scoped_lock guard(s_mutex);
+
+      for(size_t i = 0; i < s_rings.size(); i++) {
+        if(!s_rings[i]->in_use) {
+          s_rings[i]->in_use = true;
+          return s_rings[i].get();
+        }
+      }
+
+      long n = prefs::singleton()->get_long("Tracer", "ring_size", 65536);
+      size_t size = 2;
+      while(size < (size_t)std::max(n, 2L))
+        size <<= 1;
+
+      trace_ring_sptr r(new trace_ring);
+      r->events.resize(size);
+      r->mask = size - 1;
+      r->head = 0;
+      r->floor = 0;
+      r->tid = s_rings.size() + 1;
+      r->in_use = true;
+      s_rings.push_back(r);
+      return r.get();
+    }
+
+    // The events of r still in the ring, oldest first.
+    std::vector<trace_event>
+    snapshot(const trace_ring &r)
+    {
+      size_t size = r.mask + 1;
+      size_t head = gr::thread::atomic_load_acquire(&r.head);
+      size_t start = std::max(head > size ? head - size : 0, r.floor);
+
+      std::vector<trace_event> copy;
+      for(size_t i = start; i < head; i++)
+        copy.push_back(r.events[i & r.mask]);
+
+      // The writer may be filling slot h, which is also where event
+      // h - size lived. The copy must be done before head is read
+      // again, or an overwrite could go unnoticed.
+      gr::thread::atomic_fence_acquire();
+      size_t h = gr::thread::atomic_load_acquire(&r.head);
+      size_t valid = h + 1 > size ? h + 1 - size : 0;
+      if(valid > start)
+        copy.erase(copy.begin(), copy.begin() + std::min(valid - start, copy.size()));
+      return copy;
+    }
+
+    std::string
+    json_escape(const std::string &s)
+    {
+      std::string r;
+      for(size_t i = 0; i < s.size(); i++) {
+        char c = s[i];
+        if(c == '"' || c == '\\') {
+          r += '\\';
+          r += c;
+        }
+        else if((unsigned char)c < 0x20) {
+          r += ' ';
+        }
+        else
+          r += c;
+      }
+      return r;
+    }
+
+  } /* anonymous namespace */
+
+  bool tracer::s_enabled = false;
+
+  void
+  tracer::enable(bool on)
+  {
+    gr::thread::scoped_lock guard(s_mutex);
+    s_configured = true;
+    s_enabled = on;
+  }
+
+  void
+  tracer::register_block(long block_id, const std::string &name)
+  {
+    gr::thread::scoped_lock guard(s_mutex);
+
+    // The first flowgraph to start picks up the preference, unless
+    // enable() got there first.
+    if(!s_configured) {
+      s_configured = true;
+      s_enabled = prefs::singleton()->get_bool("Tracer", "on", false);
+    }
+
+    s_names[block_id] = name;
+  }
+
+  void
+  tracer::record(event_t ev, long block_id, long arg)
+  {
+    trace_ring *r = thread_ring().get();
+    if(r == 0) {
+      r = acquire_ring();
+      thread_ring().reset(r);
+    }
+
+    // Readers must not see the slot change before the head bump of
+    // the previous record, which tells them the slot is being reused.
+    gr::thread::atomic_fence_release();
+    trace_event &e = r->events[r->head & r->mask];
+    e.ts = high_res_timer_now();
+    e.block = block_id;
+    e.arg = arg;
+    e.type = ev;
+    gr::thread::atomic_store_release(&r->head, r->head + 1);
+  }
+
+  void
+  tracer::clear()
+  {
+    // Rings may be in use; only the owning thread writes them, so
+    // just skip everything recorded so far.
+    gr::thread::scoped_lock guard(s_mutex);
+    for(size_t i = 0; i < s_rings.size(); i++)
+      s_rings[i]->floor = gr::thread::atomic_load_acquire(&s_rings[i]->head);
+  }
+
+  /*
+   * Work calls and message dispatches become begin/end pairs. A run
+   * of BLKD_IN (BLKD_OUT) events from one block becomes a single
+   * span lasting until the thread's next event of another kind, so a
+   * stall shows up as one bar however many times the thread polled.
+   */
+  void
+  tracer::dump_chrome_json(const std::string &filename)
+  {
+    std::vector<std::vector<trace_event> > events;
+    std::vector<int> tids;
+    std::map<long, std::string> names;
+    {
+      gr::thread::scoped_lock guard(s_mutex);
+      for(size_t i = 0; i < s_rings.size(); i++) {
+        events.push_back(snapshot(*s_rings[i]));
+        tids.push_back(s_rings[i]->tid);
+      }
+      names = s_names;
+    }
+
+    // Time 0 is the oldest event kept.
+    high_res_timer_type t0 = 0;
+    bool have_t0 = false;
+    for(size_t i = 0; i < events.size(); i++) {
+      if(!events[i].empty() && (!have_t0 || events[i][0].ts < t0)) {
+        t0 = events[i][0].ts;
+        have_t0 = true;
+      }
+    }
+    double us_per_tick = 1e6 / high_res_timer_tps();
+
+    std::ofstream out(filename.c_str());
+    if(!out)
+      throw std::runtime_error("tracer: can't open " + filename);
+    out.precision(3);
+    out << std::fixed;
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"gnuradio\"}}";
+
+    for(size_t i = 0; i < events.size(); i++) {
+      const std::vector<trace_event> &ev = events[i];
+      int tid = tids[i];
+
+      // Name the thread after its block when it only ran one.
+      std::set<long> blocks;
+      for(size_t j = 0; j < ev.size(); j++)
+        blocks.insert(ev[j].block);
+      std::string tname;
+      if(blocks.size() == 1 && names.count(*blocks.begin()))
+        tname = names[*blocks.begin()];
+      else {
+        std::stringstream s;
+        s << "thread " << tid;
+        tname = s.str();
+      }
+      out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+          << ",\"args\":{\"name\":\"" << json_escape(tname) << "\"}}";
+
+      int depth = 0;				// open begin events
+      for(size_t j = 0; j < ev.size(); j++) {
+        const trace_event &e = ev[j];
+
+        std::string name;
+        if(names.count(e.block))
+          name = json_escape(names[e.block]);
+        else {
+          std::stringstream s;
+          s << "block " << e.block;
+          name = s.str();
+        }
+        double ts = (e.ts - t0) * us_per_tick;
+
+        switch(e.type) {
+        case WORK_BEGIN:
+        case MSG_BEGIN:
+          out << ",\n{\"name\":\"" << name << "\",\"cat\":\""
+              << (e.type == WORK_BEGIN ? "work" : "msg")
+              << "\",\"ph\":\"B\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << ts;
+          if(e.type == WORK_BEGIN)
+            out << ",\"args\":{\"noutput_items\":" << e.arg << "}";
+          out << "}";
+          depth++;
+          break;
+
+        case WORK_END:
+        case MSG_END:
+          if(depth == 0)			// its begin was overwritten
+            break;
+          out << ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << ts;
+          if(e.type == WORK_END)
+            out << ",\"args\":{\"result\":" << e.arg << "}";
+          out << "}";
+          depth--;
+          break;
+
+        case BLKD_IN:
+        case BLKD_OUT:
+          {
+            size_t k = j + 1;
+            while(k < ev.size() && ev[k].type == e.type && ev[k].block == e.block)
+              k++;
+            if(k == ev.size())			// still blocked at the end
+              break;
+            double dur = (ev[k].ts - e.ts) * us_per_tick;
+            out << ",\n{\"name\":\"" << (e.type == BLKD_IN ? "blocked input" : "blocked output")
+                << "\",\"cat\":\"blocked\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << ts << ",\"dur\":" << dur
+                << ",\"args\":{\"block\":\"" << name << "\"}}";
+            j = k - 1;
+          }
+          break;
+
+        case DONE:
+          out << ",\n{\"name\":\"" << name << " done\",\"cat\":\"work\",\"ph\":\"i\",\"s\":\"t\""
+              << ",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << ts << "}";
+          break;
+        }
+      }
+    }
+
+    out << "\n]}\n";
+    if(!out)
+      throw std::runtime_error("tracer: error writing " + filename);
+  }
+
+} /* namespace gr */
@@ -39,6 +39,7 @@
 #include "vmcircbuf_sysv_shm.h"
 #include "vmcircbuf_mmap_shm_open.h"
 #include "vmcircbuf_mmap_tmpfile.h"
+#include "vmcircbuf_memfd_hugetlb.h"
 
 gr::thread::mutex s_vm_mutex;
 
@@ -112,6 +113,10 @@ namespace gr {
 #endif
     result.push_back (gr::vmcircbuf_mmap_tmpfile_factory::singleton());
 
+    // Last, so the search for a working factory prefers the others;
+    // name it in the vmcircbuf_default_factory pref to use it.
+    result.push_back(gr::vmcircbuf_memfd_hugetlb_factory::singleton());
+
     return result;
   }
 
@@ -79,6 +79,22 @@ namespace gr {
      * Call this to create a doubly mapped circular buffer.
      */
     virtual vmcircbuf *make(int size) = 0;
+
+    /*!
+     * \brief return granularity to use for a buffer of about \p size bytes.
+     *
+     * Factories that can map large buffers with bigger pages return
+     * a bigger value for them. Defaults to granularity().
+     */
+    virtual int granularity_for_size(int size) { (void) size; return granularity(); }
+
+    /*!
+     * \brief like make(), but place the memory near \p cpu if we can.
+     *
+     * \p cpu is the processor the buffer's writer is bound to, or -1.
+     * Defaults to make(size).
+     */
+    virtual vmcircbuf *make_for_cpu(int size, int cpu) { (void) cpu; return make(size); }
   };
 
   /*
@@ -98,6 +114,11 @@ namespace gr {
     static int granularity()         { return get_default_factory()->granularity(); }
     static vmcircbuf *make(int size) { return get_default_factory()->make(size);    }
 
+    static int granularity_for_size(int size)
+    { return get_default_factory()->granularity_for_size(size); }
+    static vmcircbuf *make_for_cpu(int size, int cpu)
+    { return get_default_factory()->make_for_cpu(size, cpu); }
+
     // N.B. not all factories are guaranteed to work.
     // It's too hard to check everything at config time, so we check at runtime
     static std::vector<vmcircbuf_factory*> all_factories();
@@ -0,0 +1,323 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "vmcircbuf_memfd_hugetlb.h"
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_MEMFD_CREATE
+#include <sys/syscall.h>
+#include <dirent.h>
+#endif
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pagesize.h"
+
+#if defined(HAVE_MEMFD_CREATE) && defined(HAVE_MMAP)
+#define GR_HAVE_MEMFD_VMCIRCBUF 1
+#endif
+
+// Older headers know the syscall but not the flags.
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB 0x0004U
+#endif
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+namespace gr {
+
+#ifdef GR_HAVE_MEMFD_VMCIRCBUF
+
+  static long
+  read_long(const char *path)
+  {
+    long v = 0;
+    FILE *fp = fopen(path, "r");
+    if(fp) {
+      if(fscanf(fp, "%ld", &v) != 1)
+        v = 0;
+      fclose(fp);
+    }
+    return v;
+  }
+
+  // The default huge page size in bytes, or 0 if we have none.
+  static int
+  huge_pagesize()
+  {
+    static int s_huge_pagesize = -1;
+
+    if(s_huge_pagesize == -1) {
+      s_huge_pagesize = 0;
+      FILE *fp = fopen("/proc/meminfo", "r");
+      if(fp) {
+        char line[256];
+        long kb;
+        while(fgets(line, sizeof(line), fp)) {
+          if(sscanf(line, "Hugepagesize: %ld kB", &kb) == 1) {
+            s_huge_pagesize = kb * 1024;
+            break;
+          }
+        }
+        fclose(fp);
+      }
+    }
+    return s_huge_pagesize;
+  }
+
+  // Has the administrator set aside (or allowed) any huge pages?
+  static bool
+  huge_pages_configured()
+  {
+    static int s_configured = -1;
+
+    if(s_configured == -1) {
+      s_configured = (huge_pagesize() > 0 &&
+                      (read_long("/proc/sys/vm/nr_hugepages") > 0 ||
+                       read_long("/proc/sys/vm/nr_overcommit_hugepages") > 0));
+    }
+    return s_configured;
+  }
+
+  // sysfs lists a cpu's node as a nodeN entry in the cpu's directory.
+  static int
+  numa_node_of_cpu(int cpu)
+  {
+    if(cpu < 0)
+      return -1;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    DIR *dir = opendir(path);
+    if(dir == 0)
+      return -1;
+
+    int node = -1;
+    struct dirent *e;
+    while((e = readdir(dir)) != 0) {
+      if(strncmp(e->d_name, "node", 4) == 0 && e->d_name[4] >= '0' && e->d_name[4] <= '9') {
+        node = atoi(e->d_name + 4);
+        break;
+      }
+    }
+    closedir(dir);
+    return node;
+  }
+
+  static int
+  memfd(unsigned int flags)
+  {
+    return syscall(SYS_memfd_create, "gnuradio", flags);
+  }
+
+  // Prefer node for the pages of [addr, addr+len). Best effort.
+  static void
+  bind_to_node(void *addr, size_t len, int node)
+  {
+#ifdef SYS_mbind
+    unsigned long mask[16];
+    if(node < 0 || node >= (int)(8 * sizeof(mask)))
+      return;
+    memset(mask, 0, sizeof(mask));
+    mask[node / (8 * sizeof(long))] = 1UL << (node % (8 * sizeof(long)));
+    if(syscall(SYS_mbind, addr, len, MPOL_PREFERRED, mask, 8 * sizeof(mask), 0) == -1)
+      perror("gr::vmcircbuf_memfd_hugetlb: mbind");
+#endif
+  }
+
+  /*
+   * Map fd twice, back to back, at an address aligned to align.
+   * Returns the start of the first copy, or 0.
+   */
+  static char *
+  double_map(int fd, size_t size, size_t align, int node)
+  {
+    // Reserve enough address space to find an aligned hole in.
+    size_t len = 2 * size + align;
+    void *r = mmap(0, len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(r == MAP_FAILED)
+      return 0;
+
+    char *reserve = (char*)r;
+    char *base = (char*)(((unsigned long)reserve + align - 1) & ~(unsigned long)(align - 1));
+    if(base > reserve)
+      munmap(reserve, base - reserve);
+    if(reserve + len > base + 2 * size)
+      munmap(base + 2 * size, reserve + len - (base + 2 * size));
+
+    void *first_copy = mmap(base, size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_FIXED, fd, (off_t)0);
+    void *second_copy = MAP_FAILED;
+    if(first_copy != MAP_FAILED)
+      second_copy = mmap(base + size, size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_FIXED, fd, (off_t)0);
+
+    if(first_copy == MAP_FAILED || second_copy == MAP_FAILED) {
+      munmap(base, 2 * size);
+      return 0;
+    }
+
+    // Both copies share the file's pages, and hence its policy.
+    bind_to_node(base, size, node);
+    return base;
+  }
+
+#endif /* GR_HAVE_MEMFD_VMCIRCBUF */
+
+  vmcircbuf_memfd_hugetlb::vmcircbuf_memfd_hugetlb(int size, int numa_node)
+    : gr::vmcircbuf(size)
+  {
+#ifndef GR_HAVE_MEMFD_VMCIRCBUF
+    fprintf(stderr, "gr::vmcircbuf_memfd_hugetlb: mmap or memfd_create is not available\n");
+    throw std::runtime_error("gr::vmcircbuf_memfd_hugetlb");
+#else
+    gr::thread::scoped_lock guard(s_vm_mutex);
+
+    if(size <= 0 || (size % gr::pagesize()) != 0) {
+      fprintf(stderr, "gr::vmcircbuf_memfd_hugetlb: invalid size = %d\n", size);
+      throw std::runtime_error("gr::vmcircbuf_memfd_hugetlb");
+    }
+
+    char *base = 0;
+
+    // Huge pages first, if the size allows. Shared hugetlb mappings
+    // reserve their pages at mmap time, so running out shows up here
+    // rather than as a SIGBUS later.
+    int huge = huge_pagesize();
+    if(huge > 0 && (size % huge) == 0) {
+      int fd = memfd(MFD_CLOEXEC | MFD_HUGETLB);
+      if(fd != -1) {
+        if(ftruncate(fd, (off_t)size) == 0)
+          base = double_map(fd, size, huge, numa_node);
+        close(fd);
+      }
+    }
+
+    // Fall back to ordinary pages.
+    if(base == 0) {
+      int fd = memfd(MFD_CLOEXEC);
+      if(fd == -1) {
+        perror("gr::vmcircbuf_memfd_hugetlb: memfd_create");
+        throw std::runtime_error("gr::vmcircbuf_memfd_hugetlb");
+      }
+      if(ftruncate(fd, (off_t)size) == -1) {
+        close(fd);						// cleanup
+        perror("gr::vmcircbuf_memfd_hugetlb: ftruncate");
+        throw std::runtime_error("gr::vmcircbuf_memfd_hugetlb");
+      }
+      base = double_map(fd, size, gr::pagesize(), numa_node);
+      close(fd);    // fd no longer needed.  The mapping is retained.
+      if(base == 0) {
+        perror("gr::vmcircbuf_memfd_hugetlb: mmap");
+        throw std::runtime_error("gr::vmcircbuf_memfd_hugetlb");
+      }
+    }
+
+    // Now remember the important stuff
+    d_base = base;
+    d_size = size;
+#endif
+  }
+
+  vmcircbuf_memfd_hugetlb::~vmcircbuf_memfd_hugetlb()
+  {
+#ifdef GR_HAVE_MEMFD_VMCIRCBUF
+    gr::thread::scoped_lock guard(s_vm_mutex);
+
+    if(munmap(d_base, 2 * d_size) == -1) {
+      perror("gr::vmcircbuf_memfd_hugetlb: munmap");
+    }
+#endif
+  }
+
+  // ----------------------------------------------------------------
+  //			The factory interface
+  // ----------------------------------------------------------------
+
+  gr::vmcircbuf_factory *vmcircbuf_memfd_hugetlb_factory::s_the_factory = 0;
+
+  gr::vmcircbuf_factory *
+  vmcircbuf_memfd_hugetlb_factory::singleton()
+  {
+    if(s_the_factory)
+      return s_the_factory;
+
+    s_the_factory = new gr::vmcircbuf_memfd_hugetlb_factory();
+    return s_the_factory;
+  }
+
+  int
+  vmcircbuf_memfd_hugetlb_factory::granularity()
+  {
+    return gr::pagesize();
+  }
+
+  int
+  vmcircbuf_memfd_hugetlb_factory::granularity_for_size(int size)
+  {
+#ifdef GR_HAVE_MEMFD_VMCIRCBUF
+    // Rounding a buffer up to whole huge pages only pays when it is
+    // at least one huge page to begin with.
+    if(huge_pages_configured() && size >= huge_pagesize())
+      return huge_pagesize();
+#endif
+    return granularity();
+  }
+
+  gr::vmcircbuf *
+  vmcircbuf_memfd_hugetlb_factory::make(int size)
+  {
+    return make_for_cpu(size, -1);
+  }
+
+  gr::vmcircbuf *
+  vmcircbuf_memfd_hugetlb_factory::make_for_cpu(int size, int cpu)
+  {
+    try {
+#ifdef GR_HAVE_MEMFD_VMCIRCBUF
+      return new vmcircbuf_memfd_hugetlb(size, numa_node_of_cpu(cpu));
+#else
+      return new vmcircbuf_memfd_hugetlb(size);
+#endif
+    }
+    catch (...) {
+      return 0;
+    }
+  }
+
+} /* namespace gr */
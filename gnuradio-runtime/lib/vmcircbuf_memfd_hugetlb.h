@@ -0,0 +1,89 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef GR_VMCIRCBUF_MEMFD_HUGETLB_H
+#define GR_VMCIRCBUF_MEMFD_HUGETLB_H
+
+#include <gnuradio/api.h>
+#include "vmcircbuf.h"
+
+namespace gr {
+
+  /*!
+   * \brief concrete class to implement circular buffers with memfd_create,
+   * using huge pages where possible
+   * \ingroup internal
+   *
+   * Buffers that are a multiple of the huge page size are backed by
+   * a MFD_HUGETLB memfd; if that fails (no huge pages reserved, old
+   * kernel) or the buffer is smaller, by an ordinary memfd. Given a
+   * CPU, the memory is bound to that CPU's NUMA node before it is
+   * first touched.
+   */
+  class GR_RUNTIME_API vmcircbuf_memfd_hugetlb : public gr::vmcircbuf
+  {
+  public:
+    vmcircbuf_memfd_hugetlb(int size, int numa_node=-1);
+    virtual ~vmcircbuf_memfd_hugetlb();
+  };
+
+  /*!
+   * \brief concrete factory for circular buffers built using memfd_create
+   * and huge pages
+   */
+  class GR_RUNTIME_API vmcircbuf_memfd_hugetlb_factory : public gr::vmcircbuf_factory
+  {
+  private:
+    static gr::vmcircbuf_factory *s_the_factory;
+
+  public:
+    static gr::vmcircbuf_factory *singleton();
+
+    virtual const char *name() const { return "gr::vmcircbuf_memfd_hugetlb_factory"; }
+
+    /*!
+     * \brief return granularity of mapping, typically equal to page size
+     */
+    virtual int granularity();
+
+    /*!
+     * \brief return the huge page size for buffers of at least one
+     * huge page, if the system has huge pages to give us.
+     */
+    virtual int granularity_for_size(int size);
+
+    /*!
+     * \brief return a gr::vmcircbuf, or 0 if unable.
+     *
+     * Call this to create a doubly mapped circular buffer.
+     */
+    virtual gr::vmcircbuf *make(int size);
+
+    /*!
+     * \brief return a gr::vmcircbuf on \p cpu's NUMA node, or 0 if unable.
+     */
+    virtual gr::vmcircbuf *make_for_cpu(int size, int cpu);
+  };
+
+} /* namespace gr */
+
+#endif /* GR_VMCIRCBUF_MEMFD_HUGETLB_H */
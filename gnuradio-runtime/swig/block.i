@@ -33,6 +33,15 @@ namespace std {
 
 class gr::block : public gr::basic_block
 {
+ public:
+  enum wait_policy_t {
+    WP_DEFAULT = 0,
+    WP_BLOCK = 1,
+    WP_SPIN = 2,
+    WP_SPIN_YIELD = 3,
+    WP_SPIN_BLOCK = 4
+  };
+
  protected:
   block (const std::string &name,
          gr::io_signature::sptr input_signature,
@@ -90,7 +99,26 @@ class gr::block : public gr::basic_block
   float pc_work_time_avg();
   float pc_work_time_var();
   float pc_work_time_total();
+  float pc_work_time_percentile(float p);
+  std::vector<float> pc_work_time_percentiles();
+  float pc_input_latency_percentile(float p);
+  std::vector<float> pc_input_latency_percentiles();
+  float pc_blocked_input_percentile(float p);
+  std::vector<float> pc_blocked_input_percentiles();
+  float pc_blocked_output_percentile(float p);
+  std::vector<float> pc_blocked_output_percentiles();
+  std::vector<int> pc_path_latency_sources();
+  float pc_path_latency_percentile(long source_id, float p);
+  std::vector<float> pc_path_latency_percentiles();
   
+  // Methods to manage how the scheduler waits when blocked.
+  wait_policy_t wait_policy() const;
+  void set_wait_policy(wait_policy_t p);
+  int cluster() const;
+  void set_cluster(int id);
+  bool latency_probe() const;
+  void set_latency_probe(bool on);
+
   // Methods to manage processor affinity.
   void set_processor_affinity(const std::vector<int> &mask);
   void unset_processor_affinity();
@@ -217,6 +217,8 @@ namespace pmt{
   void c32vector_set(pmt_t v, size_t k, std::complex<float> x);
   void c64vector_set(pmt_t v, size_t k, std::complex<double> x);
 
+  pmt_t uniform_vector_slice(pmt_t v, size_t start, size_t k);
+
   %apply size_t & INOUT { size_t &len };
   const void *uniform_vector_elements(pmt_t v, size_t &len);  
 
@@ -58,6 +58,7 @@
 #include <gnuradio/tags.h>
 #include <gnuradio/tagged_stream_block.h>
 #include <gnuradio/top_block.h>
+#include <gnuradio/tracer.h>
 #include <gnuradio/logger.h>
 %}
 
@@ -88,6 +89,7 @@
 %include "tagged_stream_block.i"
 %include "tags.i"
 %include "top_block.i"
+%include <gnuradio/tracer.h>
 %include "block_gateway.i"
 %include "gr_logger.i"
 %include "gr_swig_block_magic.i"
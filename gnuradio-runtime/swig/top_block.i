@@ -49,6 +49,10 @@ namespace gr {
 
     int max_noutput_items();
     void set_max_noutput_items(int nmax);
+    void set_auto_affinity(bool on);
+    bool auto_affinity();
+    void reserve_cores(const std::vector<int> &cores);
+    std::vector<int> reserved_cores();
 
     gr::top_block_sptr to_top_block(); // Needed for Python type coercion
   };
@@ -38,6 +38,7 @@ namespace gr {
       BLOCKS_API size_t itemsize(vector_type type);
       BLOCKS_API bool type_matches(vector_type type, pmt::pmt_t v);
       BLOCKS_API pmt::pmt_t make_pdu_vector(vector_type type, const uint8_t* buf, size_t items);
+      BLOCKS_API pmt::pmt_t make_pdu_vector(vector_type type, pmt::memory_block_t mem, size_t items);
       BLOCKS_API vector_type type_from_pmt(pmt::pmt_t vector);
 
     } /* namespace pdu */
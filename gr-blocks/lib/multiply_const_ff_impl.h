@@ -44,6 +44,8 @@ namespace gr {
       int work(int noutput_items,
 	       gr_vector_const_void_star &input_items,
 	       gr_vector_void_star &output_items);
+
+      bool fusable() const { return true; }
     };
 
   } /* namespace blocks */
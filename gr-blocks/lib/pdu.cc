@@ -75,6 +75,21 @@ namespace gr {
 	}
       }
 
+      pmt::pmt_t
+      make_pdu_vector(vector_type type, pmt::memory_block_t mem, size_t items)
+      {
+	switch(type) {
+	case byte_t:
+	  return pmt::make_u8vector_view(mem, 0, items);
+	case float_t:
+	  return pmt::make_f32vector_view(mem, 0, items);
+	case complex_t:
+	  return pmt::make_c32vector_view(mem, 0, items);
+	default:
+	  throw std::runtime_error("bad PDU type");
+	}
+      }
+
       vector_type
       type_from_pmt(pmt::pmt_t vector)
       {
@@ -43,6 +43,7 @@ namespace gr {
 		      io_signature::make(1, 1, pdu::itemsize(type))),
 	d_itemsize(pdu::itemsize(type)),
 	d_type(type),
+	d_remain(pmt::PMT_NIL),
     d_tag(pmt::mp(lengthtagname))
     {
       message_port_register_in(PDU_PORT_ID);
@@ -57,10 +58,15 @@ namespace gr {
       int nout = 0;
 
       // if we have remaining output, send it
-      if (d_remain.size() > 0) {
-	nout = std::min((size_t)d_remain.size()/d_itemsize, (size_t)noutput_items);
-	memcpy(out, &d_remain[0], nout*d_itemsize);
-	d_remain.erase(d_remain.begin(), d_remain.begin()+nout);
+      if (!pmt::eq(d_remain, pmt::PMT_NIL)) {
+	size_t nremain = pmt::length(d_remain);
+	size_t io(0);
+	nout = std::min(nremain, (size_t)noutput_items);
+	memcpy(out, uniform_vector_elements(d_remain,io), nout*d_itemsize);
+	if ((size_t)nout < nremain)
+	  d_remain = pmt::uniform_vector_slice(d_remain, nout, nremain - nout);
+	else
+	  d_remain = pmt::PMT_NIL;
 	noutput_items -= nout;
 	out += nout*d_itemsize;
       }
@@ -92,9 +98,10 @@ namespace gr {
 	  pmt::pmt_t pair(pmt::dict_keys(meta));
 
 	  while (!pmt::eq(pair, pmt::PMT_NIL) ) {
-            pmt::pmt_t k(pmt::cdr(pair));
+            pmt::pmt_t k(pmt::car(pair));
             pmt::pmt_t v(pmt::dict_ref(meta, k, pmt::PMT_NIL));
             add_item_tag(0, offset, k, v, pmt::mp(alias()));
+            pair = pmt::cdr(pair);
             }
         }
 
@@ -107,10 +114,9 @@ namespace gr {
 	nout += ncopy;
 	memcpy(out, uniform_vector_elements(vect,io), ncopy*d_itemsize);
 	
-	// save leftover items if needed for next work call
+	// keep a view of the leftover items for the next work call
 	if (nsave > 0) {
-	  d_remain.resize(nsave*d_itemsize, 0);
-	  memcpy(&d_remain[0], uniform_vector_elements(vect,ncopy), nsave*d_itemsize);
+	  d_remain = pmt::uniform_vector_slice(vect, ncopy, nsave);
         }
       }
       
@@ -32,7 +32,7 @@ namespace gr {
     {
       size_t               d_itemsize;
       pdu::vector_type     d_type;
-      std::vector<uint8_t> d_remain;
+      pmt::pmt_t           d_remain;
       pmt::pmt_t           d_tag;
 
     public:
@@ -75,6 +75,7 @@ namespace gr {
 	  d_pdu_length = pmt::to_long((*d_tags_itr).value);
 	  d_pdu_remain = d_pdu_length;
 	  d_pdu_meta = pmt::make_dict();
+	  d_save = pmt::make_memory_block(d_pdu_length*d_itemsize);
               break;
           } // if have length tag
 	} // iter over tags
@@ -91,27 +92,17 @@ namespace gr {
 	if(!pmt::eq((*d_tags_itr).key, d_tag ))
 	  d_pdu_meta = dict_add(d_pdu_meta, (*d_tags_itr).key, (*d_tags_itr).value);
 
-      // copy samples for this vector into either a pmt or our save buffer
-      if (ncopy == d_pdu_remain) { // we will send this pdu
-	if (d_save.size() == 0) {
-	  d_pdu_vector = pdu::make_pdu_vector(d_type, in, ncopy);
-	  send_message();
-	} 
-	else {
-	  size_t oldsize = d_save.size();
-	  d_save.resize((oldsize + ncopy)*d_itemsize, 0);
-	  memcpy(&d_save[oldsize*d_itemsize], in, ncopy*d_itemsize);
-	  d_pdu_vector = pdu::make_pdu_vector(d_type, &d_save[0], d_pdu_length);
-	  send_message();
-	  d_save.clear();
-        }
-      } 
+      // copy samples straight into the memory the pdu vector will use
+      uint8_t *save = (uint8_t *) pmt::memory_block_data(d_save);
+      memcpy(save + (d_pdu_length - d_pdu_remain)*d_itemsize, in, ncopy*d_itemsize);
+      d_pdu_remain -= ncopy;
+
+      if (d_pdu_remain == 0) { // we will send this pdu
+	d_pdu_vector = pdu::make_pdu_vector(d_type, d_save, d_pdu_length);
+	send_message();
+      }
       else {
         d_inpdu = true;
-        size_t oldsize = d_save.size();
-        d_save.resize((oldsize+ncopy)*d_itemsize);
-        memcpy(&d_save[oldsize*d_itemsize], in, ncopy*d_itemsize);
-        d_pdu_remain -= ncopy;
       }
 
       return ncopy;
@@ -128,6 +119,7 @@ namespace gr {
       
       d_pdu_meta = pmt::PMT_NIL;
       d_pdu_vector = pmt::PMT_NIL;
+      d_save.reset();
       d_pdu_length = 0;
       d_pdu_remain = 0;
       d_inpdu = false;
@@ -35,7 +35,7 @@ namespace gr {
       size_t               d_pdu_remain;
       bool                 d_inpdu;
       pdu::vector_type     d_type;
-      std::vector<uint8_t> d_save;
+      pmt::memory_block_t  d_save;
       pmt::pmt_t           d_pdu_meta;
       pmt::pmt_t           d_pdu_vector;
 
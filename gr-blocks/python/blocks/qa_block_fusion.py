@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+#
+# Copyright 2013 Free Software Foundation, Inc.
+#
+# This file is part of GNU Radio
+#
+# GNU Radio is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# GNU Radio is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Radio; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest, blocks
+import pmt
+
+class test_block_fusion(gr_unittest.TestCase):
+
+    def setUp(self):
+        gr.prefs().set_bool("DEFAULT", "block_fusion", True)
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+        gr.prefs().set_bool("DEFAULT", "block_fusion", False)
+
+    def test_001_float_chain(self):
+        src_data = [float(x) for x in range(100000)]
+        expected_result = tuple([x + 0.5 for x in src_data])
+        src = blocks.vector_source_f(src_data)
+        op1 = blocks.multiply_const_ff(2.0)
+        op2 = blocks.add_const_ff(1.0)
+        op3 = blocks.multiply_const_ff(0.5)
+        dst = blocks.vector_sink_f()
+        self.tb.connect(src, op1, op2, op3, dst)
+        self.tb.run()
+        self.assertTrue("fused_block" in self.tb.edge_list())
+        self.assertFloatTuplesAlmostEqual(expected_result, dst.data(), 6)
+
+    def test_002_complex_to_float(self):
+        src_data = (1+1j, -2+0j, 0-3j, 4+4j) * 1000
+        expected_result = tuple([abs(2*x.conjugate())**2 for x in src_data])
+        src = blocks.vector_source_c(src_data)
+        op1 = blocks.multiply_const_cc(2.0)
+        op2 = blocks.conjugate_cc()
+        op3 = blocks.complex_to_mag_squared()
+        dst = blocks.vector_sink_f()
+        self.tb.connect(src, op1, op2, op3, dst)
+        self.tb.run()
+        self.assertTrue("fused_block" in self.tb.edge_list())
+        self.assertFloatTuplesAlmostEqual(expected_result, dst.data(), 5)
+
+    def test_003_tags_pass_through(self):
+        src_data = (1.0,) * 10000
+        tags = []
+        for offset in (0, 17, 5000, 9999):
+            tag = gr.tag_t()
+            tag.offset = offset
+            tag.key = pmt.intern("mark")
+            tag.value = pmt.from_long(offset)
+            tags.append(tag)
+        src = blocks.vector_source_f(src_data, False, 1, tags)
+        op1 = blocks.add_const_ff(1.0)
+        op2 = blocks.multiply_const_ff(3.0)
+        dst = blocks.vector_sink_f()
+        self.tb.connect(src, op1, op2, dst)
+        self.tb.run()
+        self.assertEqual((6.0,) * 10000, dst.data())
+        result_tags = dst.tags()
+        self.assertEqual(len(tags), len(result_tags))
+        for t in result_tags:
+            self.assertEqual(t.offset, pmt.to_long(t.value))
+
+    def test_004_unfusable_block_splits_chain(self):
+        # copy is not fusable, which leaves chains of one block
+        src_data = [float(x) for x in range(1000)]
+        expected_result = tuple([2*x + 2 for x in src_data])
+        src = blocks.vector_source_f(src_data)
+        op1 = blocks.add_const_ff(1.0)
+        op2 = blocks.copy(gr.sizeof_float)
+        op3 = blocks.multiply_const_ff(2.0)
+        dst = blocks.vector_sink_f()
+        self.tb.connect(src, op1, op2, op3, dst)
+        self.tb.run()
+        self.assertFalse("fused_block" in self.tb.edge_list())
+        self.assertFloatTuplesAlmostEqual(expected_result, dst.data(), 6)
+
+if __name__ == '__main__':
+    gr_unittest.run(test_block_fusion, "test_block_fusion.xml")
@@ -2,6 +2,8 @@
 
 from gnuradio import gr, gr_unittest, blocks
 import numpy
+import pmt
+import time
 
 class add_ff(gr.sync_block):
     def __init__(self):
@@ -30,6 +32,24 @@ class multiply_const_ff(gr.sync_block):
         output_items[0][:] = map(lambda x: self.k*x, input_items[0])
         return len(output_items[0])
 
+class copy_count_ff(gr.sync_block):
+    def __init__(self):
+        gr.sync_block.__init__(
+            self,
+            name = "copy_count_ff",
+            in_sig = [numpy.float32],
+            out_sig = [numpy.float32],
+        )
+        self.nstarts = 0
+
+    def start(self):
+        self.nstarts += 1
+        return True
+
+    def work(self, input_items, output_items):
+        output_items[0][:] = input_items[0]
+        return len(output_items[0])
+
 class test_hier_block2(gr_unittest.TestCase):
 
     def setUp(self):
@@ -426,5 +446,82 @@ class test_hier_block2(gr_unittest.TestCase):
         procs = hblock.processor_affinity()
         self.assertEquals((0,), procs)
 
+    def test_034_nested_rewire_after_run(self):
+        # Flattening remembers the resolved edges of each hier block;
+        # rewiring a nested one must not reuse stale ones.
+        tb = gr.top_block()
+        hb = gr.hier_block2("hb",
+                            gr.io_signature(1, 1, gr.sizeof_float),
+                            gr.io_signature(1, 1, gr.sizeof_float))
+        hb2 = gr.hier_block2("hb2",
+                            gr.io_signature(1, 1, gr.sizeof_float),
+                            gr.io_signature(1, 1, gr.sizeof_float))
+        m1 = multiply_const_ff(2.0)
+        m2 = multiply_const_ff(3.0)
+        hb2.connect(hb2, m1, hb2)
+        hb.connect(hb, hb2, hb)
+        src = blocks.vector_source_f([1.0,])
+        dst = blocks.vector_sink_f()
+        tb.connect(src, hb, dst)
+        tb.run()
+        self.assertEquals(dst.data(), (2.0,))
+
+        hb2.disconnect_all()
+        hb2.connect(hb2, m2, hb2)
+        src.rewind()
+        dst.reset()
+        tb.run()
+        self.assertEquals(dst.data(), (3.0,))
+
+    def test_035_reconfigure_one_branch(self):
+        # Rewiring one branch restarts only the blocks of that branch;
+        # the other one keeps streaming.
+        tb = gr.top_block()
+        src_a = blocks.vector_source_f(range(10), True)
+        cnt_a = copy_count_ff()
+        dst_a = blocks.null_sink(gr.sizeof_float)
+        src_b = blocks.vector_source_f(range(10), True)
+        cnt_b = copy_count_ff()
+        dst_b1 = blocks.null_sink(gr.sizeof_float)
+        dst_b2 = blocks.null_sink(gr.sizeof_float)
+        tb.connect(src_a, cnt_a, dst_a)
+        tb.connect(src_b, cnt_b, dst_b1)
+        tb.start()
+        tb.lock()
+        tb.disconnect(cnt_b, dst_b1)
+        tb.connect(cnt_b, dst_b2)
+        tb.unlock()
+        na = cnt_a.nitems_written(0)
+        nb = dst_b2.nitems_read(0)
+        for i in xrange(500):
+            if cnt_a.nitems_written(0) > na and dst_b2.nitems_read(0) > nb:
+                break
+            time.sleep(0.01)
+        tb.stop()
+        tb.wait()
+        self.assertTrue(cnt_a.nitems_written(0) > na)
+        self.assertTrue(dst_b2.nitems_read(0) > nb)
+        self.assertEqual(1, cnt_a.nstarts)
+        self.assertEqual(2, cnt_b.nstarts)
+
+    def test_036_reconfigure_msg_connect(self):
+        # A message connection made while locked takes effect too
+        tb = gr.top_block()
+        strobe = blocks.message_strobe(pmt.intern("hello"), 10)
+        dbg1 = blocks.message_debug()
+        dbg2 = blocks.message_debug()
+        tb.msg_connect(strobe, "strobe", dbg1, "store")
+        tb.start()
+        tb.lock()
+        tb.msg_connect(strobe, "strobe", dbg2, "store")
+        tb.unlock()
+        for i in xrange(500):
+            if dbg2.num_messages() > 0:
+                break
+            time.sleep(0.01)
+        tb.stop()
+        tb.wait()
+        self.assertTrue(dbg2.num_messages() > 0)
+
 if __name__ == "__main__":
     gr_unittest.run(test_hier_block2, "test_hier_block2.xml")
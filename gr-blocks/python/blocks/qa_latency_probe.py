@@ -0,0 +1,93 @@
+#!/usr/bin/env python
+#
+# Copyright 2004,2007,2010,2013 Free Software Foundation, Inc.
+#
+# This file is part of GNU Radio
+#
+# GNU Radio is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# GNU Radio is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Radio; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest, blocks
+import os
+
+class test_latency_probe(gr_unittest.TestCase):
+
+    def setUp(self):
+        # Perf. counters must be on before the flowgraph starts; stamp
+        # a probe on every work call so that short runs get plenty.
+        os.environ['GR_CONF_PERFCOUNTERS_ON'] = '1'
+        os.environ['GR_CONF_PERFCOUNTERS_LATENCY_PROBE_PERIOD'] = '0'
+        self.tb = gr.top_block()
+
+    def tearDown(self):
+        self.tb = None
+        for k in ('GR_CONF_PERFCOUNTERS_ON',
+                  'GR_CONF_PERFCOUNTERS_LATENCY_PROBE_PERIOD',
+                  'GR_CONF_PERFCOUNTERS_LATENCY_PROBE'):
+            os.environ.pop(k, None)
+
+    def assertPercentiles(self, p, nsources):
+        self.assertEqual(3*nsources, len(p))
+        for i in range(0, len(p), 3):
+            self.assertTrue(p[i] > 0)
+            self.assertTrue(p[i] <= p[i+1])
+            self.assertTrue(p[i+1] <= p[i+2])
+
+    def test_001_one_source(self):
+        src = blocks.null_source(gr.sizeof_float)
+        head = blocks.head(gr.sizeof_float, 1000000)
+        dst = blocks.null_sink(gr.sizeof_float)
+        src.set_latency_probe(True)
+        self.tb.connect(src, head, dst)
+        self.tb.run()
+
+        self.assertEqual((src.unique_id(),), tuple(dst.pc_path_latency_sources()))
+        p = dst.pc_path_latency_percentiles()
+        self.assertPercentiles(p, 1)
+        self.assertEqual(p[0], dst.pc_path_latency_percentile(src.unique_id(), 0.5))
+
+        # Only sinks keep track of the probes
+        self.assertEqual((), tuple(head.pc_path_latency_sources()))
+        self.assertEqual((), tuple(head.pc_path_latency_percentiles()))
+
+    def test_002_all_sources(self):
+        os.environ['GR_CONF_PERFCOUNTERS_LATENCY_PROBE'] = '1'
+        src1 = blocks.null_source(gr.sizeof_float)
+        src2 = blocks.null_source(gr.sizeof_float)
+        add = blocks.add_ff()
+        head = blocks.head(gr.sizeof_float, 1000000)
+        dst = blocks.null_sink(gr.sizeof_float)
+        self.tb.connect(src1, (add, 0))
+        self.tb.connect(src2, (add, 1))
+        self.tb.connect(add, head, dst)
+        self.tb.run()
+
+        self.assertEqual(sorted([src1.unique_id(), src2.unique_id()]),
+                         sorted(dst.pc_path_latency_sources()))
+        self.assertPercentiles(dst.pc_path_latency_percentiles(), 2)
+
+    def test_003_probes_off(self):
+        src = blocks.null_source(gr.sizeof_float)
+        head = blocks.head(gr.sizeof_float, 100000)
+        dst = blocks.null_sink(gr.sizeof_float)
+        self.tb.connect(src, head, dst)
+        self.tb.run()
+
+        self.assertEqual((), tuple(dst.pc_path_latency_sources()))
+        self.assertEqual((), tuple(dst.pc_path_latency_percentiles()))
+
+if __name__ == '__main__':
+    gr_unittest.run(test_latency_probe, "test_latency_probe.xml")
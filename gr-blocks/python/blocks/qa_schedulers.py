@@ -0,0 +1,86 @@
+#!/usr/bin/env python
+#
+# Copyright 2013 Free Software Foundation, Inc.
+#
+# This file is part of GNU Radio
+#
+# GNU Radio is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# GNU Radio is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GNU Radio; see the file COPYING.  If not, write to
+# the Free Software Foundation, Inc., 51 Franklin Street,
+# Boston, MA 02110-1301, USA.
+#
+
+from gnuradio import gr, gr_unittest, blocks
+import os
+import subprocess
+import sys
+
+def run_flowgraph():
+    # Fan-out, rate changes and history, run to completion
+    src_data = [float(x) for x in range(20000)]
+    tb = gr.top_block()
+    src = blocks.vector_source_f(src_data, False)
+    mult = blocks.multiply_const_ff(2)
+    keep = blocks.keep_one_in_n(gr.sizeof_float, 3)
+    rep = blocks.repeat(gr.sizeof_float, 2)
+    head = blocks.head(gr.sizeof_float, 25000)
+    delay = blocks.delay(gr.sizeof_float, 5)
+    add = blocks.add_ff()
+    dst1 = blocks.vector_sink_f()
+    dst2 = blocks.vector_sink_f()
+    dst3 = blocks.vector_sink_f()
+    # Schedulers that share a thread between blocks take this on
+    src.set_processor_affinity([0])
+    tb.connect(src, mult, keep, dst1)
+    tb.connect(src, rep, head, dst2)
+    tb.connect(src, delay, (add, 0))
+    tb.connect(mult, (add, 1))
+    tb.connect(add, dst3)
+    tb.run()
+    return (dst1.data(), dst2.data(), dst3.data())
+
+def run_under(scheduler, **conf):
+    # The scheduler is picked once per process, so each run gets one
+    env = dict(os.environ)
+    env['GR_SCHEDULER'] = scheduler
+    for k, v in conf.items():
+        env['GR_CONF_DEFAULT_' + k.upper()] = str(v)
+    p = subprocess.Popen([sys.executable, __file__, '--child'],
+                         stdout=subprocess.PIPE, env=env)
+    out = p.communicate()[0]
+    if p.returncode != 0:
+        raise RuntimeError("flowgraph failed under " + scheduler)
+    return out
+
+class test_schedulers(gr_unittest.TestCase):
+
+    def test_001_pool(self):
+        expected = run_under("TPB")
+        self.assertTrue(len(expected) > 0)
+        self.assertEqual(expected, run_under("POOL"))
+
+    def test_002_cluster(self):
+        expected = run_under("TPB")
+        self.assertTrue(len(expected) > 0)
+        self.assertEqual(expected, run_under("CLUSTER"))
+
+    def test_003_cluster_small(self):
+        # Two blocks per cluster, so most edges cross clusters
+        expected = run_under("TPB")
+        self.assertEqual(expected, run_under("CLUSTER", cluster_size=2))
+
+if __name__ == '__main__':
+    if sys.argv[1:] == ['--child']:
+        sys.stdout.write(repr(run_flowgraph()))
+    else:
+        gr_unittest.run(test_schedulers, "test_schedulers.xml")
@@ -0,0 +1,168 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Times how long it takes to flatten, start, reconfigure and stop
+ * large flowgraphs made of nested hierarchical blocks.
+ *
+ *   benchmark_startup [nblocks ...]
+ *
+ * For each size (1000 and 10000 blocks by default) the graph has
+ * lanes of null_source -> group -> null_sink, where a group is a
+ * hierarchical block holding GROUP_SIZE stages, and a stage is a
+ * hierarchical block holding a chain of STAGE_SIZE copy blocks.
+ *
+ * Use GR_SCHEDULER=POOL for the larger sizes unless the system is
+ * happy to run one thread per block.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/hier_block2.h>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/high_res_timer.h>
+#include <gnuradio/blocks/copy.h>
+#include <gnuradio/blocks/null_source.h>
+#include <gnuradio/blocks/null_sink.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#define STAGE_SIZE 10		// copy blocks per stage
+#define GROUP_SIZE 10		// stages per group
+
+class stage : public gr::hier_block2
+{
+public:
+  stage()
+    : gr::hier_block2("stage",
+                      gr::io_signature::make(1, 1, sizeof(float)),
+                      gr::io_signature::make(1, 1, sizeof(float)))
+  {
+    gr::basic_block_sptr prev = self();
+    for(int i = 0; i < STAGE_SIZE; i++) {
+      gr::basic_block_sptr b = gr::blocks::copy::make(sizeof(float));
+      connect(prev, 0, b, 0);
+      prev = b;
+    }
+    connect(prev, 0, self(), 0);
+  }
+};
+
+class group : public gr::hier_block2
+{
+public:
+  std::vector<gr::hier_block2_sptr> d_stages;
+
+  group()
+    : gr::hier_block2("group",
+                      gr::io_signature::make(1, 1, sizeof(float)),
+                      gr::io_signature::make(1, 1, sizeof(float)))
+  {
+    gr::basic_block_sptr prev = self();
+    for(int i = 0; i < GROUP_SIZE; i++) {
+      gr::hier_block2_sptr s = gnuradio::get_initial_sptr(new stage());
+      d_stages.push_back(s);
+      connect(prev, 0, s, 0);
+      prev = s;
+    }
+    connect(prev, 0, self(), 0);
+  }
+};
+
+static double
+elapsed(gr::high_res_timer_type t0)
+{
+  return double(gr::high_res_timer_now() - t0) / gr::high_res_timer_tps();
+}
+
+static void
+benchmark(int nblocks)
+{
+  int nlanes = std::max(1, nblocks / (STAGE_SIZE * GROUP_SIZE));
+  gr::high_res_timer_type t0;
+
+  t0 = gr::high_res_timer_now();
+  gr::top_block_sptr tb = gr::make_top_block("benchmark_startup");
+  std::vector<gr::basic_block_sptr> groups, sinks;
+  for(int i = 0; i < nlanes; i++) {
+    gr::basic_block_sptr src = gr::blocks::null_source::make(sizeof(float));
+    gr::hier_block2_sptr g = gnuradio::get_initial_sptr(new group());
+    gr::basic_block_sptr snk = gr::blocks::null_sink::make(sizeof(float));
+    tb->connect(src, 0, g, 0);
+    tb->connect(g, 0, snk, 0);
+    groups.push_back(g);
+    sinks.push_back(snk);
+  }
+  double t_build = elapsed(t0);
+
+  t0 = gr::high_res_timer_now();
+  tb->flatten();
+  double t_flatten = elapsed(t0);
+
+  t0 = gr::high_res_timer_now();
+  tb->flatten();
+  double t_reflatten = elapsed(t0);
+
+  t0 = gr::high_res_timer_now();
+  tb->start();
+  double t_start = elapsed(t0);
+
+  // Give the first lane a new sink.
+  t0 = gr::high_res_timer_now();
+  tb->lock();
+  tb->disconnect(groups[0], 0, sinks[0], 0);
+  tb->connect(groups[0], 0, gr::blocks::null_sink::make(sizeof(float)), 0);
+  tb->unlock();
+  double t_reconf = elapsed(t0);
+
+  t0 = gr::high_res_timer_now();
+  tb->stop();
+  tb->wait();
+  double t_stop = elapsed(t0);
+
+  int total = nlanes * (STAGE_SIZE * GROUP_SIZE + 2);
+  printf("%6d blocks: build %8.3f  flatten %8.3f  re-flatten %8.3f  "
+         "start %8.3f  unlock %8.3f  stop %8.3f  (s)\n",
+         total, t_build, t_flatten, t_reflatten, t_start, t_reconf, t_stop);
+}
+
+int
+main(int argc, char **argv)
+{
+  std::vector<int> sizes;
+  for(int i = 1; i < argc; i++)
+    sizes.push_back(atoi(argv[i]));
+  if(sizes.empty()) {
+    sizes.push_back(1000);
+    sizes.push_back(10000);
+  }
+
+  for(size_t i = 0; i < sizes.size(); i++)
+    benchmark(sizes[i]);
+
+  return 0;
+}
@@ -107,6 +107,62 @@ namespace gr {
       void execute();
     };
 
+    /*!
+     * \brief Many FFTs of the same size in one go: complex in, complex out
+     * \ingroup misc
+     *
+     * Transforms \p howmany vectors of \p fft_size points with a
+     * single FFTW plan. Point k of vector v is at k*stride + v*dist
+     * in both the input and the output buffer. So stride = howmany,
+     * dist = 1 interleaves the vectors and stride = 1, dist =
+     * fft_size puts them back to back.
+     */
+    class FFT_API fft_complex_many {
+      int	      d_fft_size;
+      int         d_howmany;
+      int         d_stride;
+      int         d_dist;
+      int         d_nthreads;
+      gr_complex *d_inbuf;
+      gr_complex *d_outbuf;
+      void	     *d_plan;
+
+    public:
+      fft_complex_many(int fft_size, int howmany, int stride, int dist,
+		       bool forward = true, int nthreads=1);
+      virtual ~fft_complex_many();
+
+      /*
+       * These return pointers to buffers owned by fft_complex_many
+       * into which input and output take place. It's done this way in
+       * order to ensure optimal alignment for SIMD instructions.
+       */
+      gr_complex *get_inbuf()  const { return d_inbuf; }
+      gr_complex *get_outbuf() const { return d_outbuf; }
+
+      int inbuf_length()  const { return (d_fft_size-1)*d_stride + (d_howmany-1)*d_dist + 1; }
+      int outbuf_length() const { return inbuf_length(); }
+
+      int fft_size() const { return d_fft_size; }
+      int howmany() const { return d_howmany; }
+
+      /*!
+       *  Set the number of threads to use for caclulation.
+       */
+      void set_nthreads(int n);
+
+      /*!
+       *  Get the number of threads being used by FFTW
+       */
+      int nthreads() const { return d_nthreads; }
+
+      /*!
+       * compute all the FFTs. The input comes from inbuf, the output
+       * is placed in outbuf.
+       */
+      void execute();
+    };
+
     /*!
      * \brief FFT: real in, complex out
      * \ingroup misc
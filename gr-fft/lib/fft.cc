@@ -203,6 +203,81 @@ namespace gr {
       fftwf_execute((fftwf_plan) d_plan);
     }
 
+// ----------------------------------------------------------------
+
+    fft_complex_many::fft_complex_many(int fft_size, int howmany,
+				       int stride, int dist,
+				       bool forward, int nthreads)
+    {
+      // Hold global mutex during plan construction and destruction.
+      planner::scoped_lock lock(planner::mutex());
+
+      assert (sizeof (fftwf_complex) == sizeof (gr_complex));
+
+      if (fft_size <= 0 || howmany <= 0)
+	throw std::out_of_range ("gr::fft::fft_complex_many: invalid fft_size or howmany");
+
+      d_fft_size = fft_size;
+      d_howmany = howmany;
+      d_stride = stride;
+      d_dist = dist;
+      d_inbuf = (gr_complex *) fftwf_malloc (sizeof (gr_complex) * inbuf_length ());
+      if (d_inbuf == 0)
+	throw std::runtime_error ("fftwf_malloc");
+
+      d_outbuf = (gr_complex *) fftwf_malloc (sizeof (gr_complex) * outbuf_length ());
+      if (d_outbuf == 0){
+	fftwf_free (d_inbuf);
+	throw std::runtime_error ("fftwf_malloc");
+      }
+
+      d_nthreads = nthreads;
+      config_threading(nthreads);
+      import_wisdom();	// load prior wisdom from disk
+
+      d_plan = fftwf_plan_many_dft (1, &d_fft_size, d_howmany,
+				    reinterpret_cast<fftwf_complex *>(d_inbuf),
+				    NULL, d_stride, d_dist,
+				    reinterpret_cast<fftwf_complex *>(d_outbuf),
+				    NULL, d_stride, d_dist,
+				    forward ? FFTW_FORWARD : FFTW_BACKWARD,
+				    FFTW_MEASURE);
+
+      if (d_plan == NULL) {
+	fprintf(stderr, "gr::fft::fft_complex_many: error creating plan\n");
+	throw std::runtime_error ("fftwf_plan_many_dft failed");
+      }
+      export_wisdom();	// store new wisdom to disk
+    }
+
+    fft_complex_many::~fft_complex_many()
+    {
+      // Hold global mutex during plan construction and destruction.
+      planner::scoped_lock lock(planner::mutex());
+
+      fftwf_destroy_plan ((fftwf_plan) d_plan);
+      fftwf_free (d_inbuf);
+      fftwf_free (d_outbuf);
+    }
+
+    void
+    fft_complex_many::set_nthreads(int n)
+    {
+      if (n <= 0)
+	throw std::out_of_range ("gr::fft::fft_complex_many::set_nthreads: invalid number of threads");
+      d_nthreads = n;
+
+#ifdef FFTW3F_THREADS
+      fftwf_plan_with_nthreads(d_nthreads);
+#endif
+    }
+
+    void
+    fft_complex_many::execute()
+    {
+      fftwf_execute((fftwf_plan) d_plan);
+    }
+
 // ----------------------------------------------------------------
 
     fft_real_fwd::fft_real_fwd (int fft_size, int nthreads)
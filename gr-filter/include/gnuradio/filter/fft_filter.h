@@ -40,18 +40,20 @@ namespace gr {
       {
       private:
 	int			 d_ntaps;
+	int			 d_padded_ntaps;    // d_ntaps padded for decimation
 	int			 d_nsamples;
-	int			 d_fftsize;         // fftsize = ntaps + nsamples - 1
+	int			 d_fftsize;         // fftsize = padded_ntaps + nsamples - 1
 	int                      d_decimation;
+	int                      d_fft_factor;      // fftsize is at least this times ntaps
 	fft::fft_real_fwd       *d_fwdfft;	    // forward "plan"
 	fft::fft_real_rev       *d_invfft;          // inverse "plan"
 	int                      d_nthreads;        // number of FFTW threads to use
-	std::vector<float>       d_tail;	    // state carried between blocks for overlap-add
+	std::vector<float>       d_tail;	    // last inputs carried between blocks for overlap-save
 	std::vector<float>       d_new_taps;
 	gr_complex              *d_xformed_taps;    // Fourier xformed taps
 	
 	void compute_sizes(int ntaps);
-	int tailsize() const { return d_ntaps - 1; }
+	int tailsize() const { return d_padded_ntaps - 1; }
 
       public:
 	/*!
@@ -74,9 +76,15 @@ namespace gr {
 	 * \brief Set new taps for the filter.
 	 *
 	 * Sets new taps and resets the class properties to handle different sizes
+	 * \return the number of outputs per FFT block; filter() takes a multiple of it
 	 * \param taps       The filter taps (complex)
 	 */
 	int set_taps(const std::vector<float> &taps);
+
+	/*!
+	 * \brief Get the number of taps given to set_taps().
+	 */
+	int ntaps() const;
 	
 	/*!
 	 * \brief Set number of threads to use.
@@ -87,6 +95,23 @@ namespace gr {
 	 * \brief Get number of threads being used.
 	 */
 	int nthreads() const;
+
+	/*!
+	 * \brief Set the FFT size as a multiple of the number of taps.
+	 *
+	 * The FFT size is the smallest decimation * 2^k of at least
+	 * \p factor times the number of taps (2 by default). Larger
+	 * FFTs cost fewer operations per output but add latency and
+	 * use more memory. Takes effect at the next set_taps().
+	 *
+	 * \param factor  FFT size in number of taps, at least 2
+	 */
+	void set_fft_factor(int factor);
+
+	/*!
+	 * \brief Get the FFT size as a multiple of the number of taps.
+	 */
+	int fft_factor() const;
 	
 	/*!
 	 * \brief Perform the filter operation
@@ -96,6 +121,18 @@ namespace gr {
 	 * \param output  The result of the filter operation
 	 */
 	int filter(int nitems, const float *input, float *output);
+
+	/*!
+	 * \brief Continue a stream filtered so far by other means.
+	 *
+	 * Makes \p history the inputs that came just before the next
+	 * call to filter(), in place of what the last call left
+	 * behind. set_taps() clears them.
+	 *
+	 * \param history  the most recent inputs, oldest first
+	 * \param nitems   how many there are; only the last ntaps-1 matter
+	 */
+	void set_tail(const float *history, int nitems);
       };
 
     
@@ -107,18 +144,20 @@ namespace gr {
       {
       private:
 	int			 d_ntaps;
+	int			 d_padded_ntaps;    // d_ntaps padded for decimation
 	int			 d_nsamples;
-	int			 d_fftsize;         // fftsize = ntaps + nsamples - 1
+	int			 d_fftsize;         // fftsize = padded_ntaps + nsamples - 1
 	int                      d_decimation;
+	int                      d_fft_factor;      // fftsize is at least this times ntaps
 	fft::fft_complex        *d_fwdfft;	    // forward "plan"
 	fft::fft_complex        *d_invfft;          // inverse "plan"
 	int                      d_nthreads;        // number of FFTW threads to use
-	std::vector<gr_complex>  d_tail;	    // state carried between blocks for overlap-add
+	std::vector<gr_complex>  d_tail;	    // last inputs carried between blocks for overlap-save
 	std::vector<gr_complex>  d_new_taps;
 	gr_complex              *d_xformed_taps;    // Fourier xformed taps
 	
 	void compute_sizes(int ntaps);
-	int tailsize() const { return d_ntaps - 1; }
+	int tailsize() const { return d_padded_ntaps - 1; }
 
       public:
 	/*!
@@ -141,9 +180,15 @@ namespace gr {
 	 * \brief Set new taps for the filter.
 	 *
 	 * Sets new taps and resets the class properties to handle different sizes
+	 * \return the number of outputs per FFT block; filter() takes a multiple of it
 	 * \param taps       The filter taps (complex)
 	 */
 	int set_taps(const std::vector<gr_complex> &taps);
+
+	/*!
+	 * \brief Get the number of taps given to set_taps().
+	 */
+	int ntaps() const;
 	
 	/*!
 	 * \brief Set number of threads to use.
@@ -154,6 +199,23 @@ namespace gr {
 	 * \brief Get number of threads being used.
 	 */
 	int nthreads() const;
+
+	/*!
+	 * \brief Set the FFT size as a multiple of the number of taps.
+	 *
+	 * The FFT size is the smallest decimation * 2^k of at least
+	 * \p factor times the number of taps (2 by default). Larger
+	 * FFTs cost fewer operations per output but add latency and
+	 * use more memory. Takes effect at the next set_taps().
+	 *
+	 * \param factor  FFT size in number of taps, at least 2
+	 */
+	void set_fft_factor(int factor);
+
+	/*!
+	 * \brief Get the FFT size as a multiple of the number of taps.
+	 */
+	int fft_factor() const;
 	
 	/*!
 	 * \brief Perform the filter operation
@@ -163,6 +225,18 @@ namespace gr {
 	 * \param output  The result of the filter operation
 	 */
 	int filter(int nitems, const gr_complex *input, gr_complex *output);
+
+	/*!
+	 * \brief Continue a stream filtered so far by other means.
+	 *
+	 * Makes \p history the inputs that came just before the next
+	 * call to filter(), in place of what the last call left
+	 * behind. set_taps() clears them.
+	 *
+	 * \param history  the most recent inputs, oldest first
+	 * \param nitems   how many there are; only the last ntaps-1 matter
+	 */
+	void set_tail(const gr_complex *history, int nitems);
       };
 
     } /* namespace kernel */
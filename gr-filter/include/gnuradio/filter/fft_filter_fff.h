@@ -51,6 +51,18 @@ namespace gr {
      * improve performance on very large FFTs (that is, if the number
      * of taps used is very large) if you have enough threads/cores to
      * support it.
+     *
+     * For short filters, the time domain filter (as in fir_filter_fff)
+     * can be faster than the FFT; set_engine("fir") uses it instead.
+     * With set_engine("auto") the block times both on the given taps
+     * and decimation whenever the taps change and runs the faster
+     * one; engine() reports which it picked. The choice depends on
+     * the machine and its load, and the two differ in rounding.
+     *
+     * The FFT engine uses overlap-save. When decimating, its inverse
+     * FFTs only compute the outputs that are kept. The FFT size is
+     * set with set_fft_factor() as a multiple of the number of taps:
+     * larger FFTs give more throughput for more latency.
      */
     class FILTER_API fft_filter_fff : virtual public sync_decimator
     {
@@ -81,6 +93,31 @@ namespace gr {
        * \brief Get number of threads being used.
        */
       virtual int nthreads() const = 0;
+
+      /*!
+       * \brief Select the filter engine: "fft" (the default), "fir"
+       * (time domain) or "auto", which times both and uses the
+       * faster. Takes effect at the next call to work, like
+       * set_taps; the stream continues across the switch.
+       */
+      virtual void set_engine(const std::string &engine) = 0;
+
+      /*!
+       * \brief The filter engine in use: "fft" or "fir".
+       */
+      virtual std::string engine() const = 0;
+
+      /*!
+       * \brief Set the FFT size to at least \p factor times the
+       * number of taps (default 2). Takes effect at the next call to
+       * work, like set_taps.
+       */
+      virtual void set_fft_factor(int factor) = 0;
+
+      /*!
+       * \brief Get the FFT size as a multiple of the number of taps.
+       */
+      virtual int fft_factor() const = 0;
     };
 
   } /* namespace filter */
@@ -194,6 +194,19 @@ namespace gr {
        * Gets the current channel map.
        */
       virtual std::vector<int> channel_map() const = 0;
+
+      /*!
+       * Set the number of threads to use. The streams are filtered,
+       * and the FFTs and output channels handled, by that many
+       * threads; use more than 1 when the number of channels is
+       * large and the cores are available.
+       */
+      virtual void set_nthreads(int n) = 0;
+
+      /*!
+       * Get the number of threads being used.
+       */
+      virtual int nthreads() const = 0;
     };
 
   } /* namespace filter */
@@ -1,6 +1,6 @@
 /* -*- c++ -*- */
 /*
- * Copyright 2010,2012 Free Software Foundation, Inc.
+ * Copyright 2010,2012,2013 Free Software Foundation, Inc.
  *
  * This file is part of GNU Radio
  *
@@ -28,6 +28,8 @@
 #include <volk/volk.h>
 #include <iostream>
 #include <cstring>
+#include <stdexcept>
+#include <algorithm>
 
 namespace gr {
   namespace filter {
@@ -35,11 +37,44 @@ namespace gr {
 
       #define VERBOSE 0
 
+      /*
+       * Both filters use overlap-save. Each FFT block is the last
+       * tailsize() inputs of the previous block followed by
+       * d_nsamples new ones, and the last d_nsamples outputs of its
+       * circular convolution are valid.
+       *
+       * With decimation, the taps are zero padded so that the first
+       * valid output falls on the decimation grid, and the FFT size
+       * and d_nsamples are multiples of the decimation. Summing the
+       * product spectrum onto d_fftsize/d_decimation bins then makes
+       * the smaller inverse transform compute exactly the kept
+       * outputs.
+       */
+
+      // Padded tap count, FFT size and new inputs per block for
+      // ntaps taps; returns the FFT size.
+      static int
+      overlap_save_sizes(int ntaps, int decimation, int fft_factor,
+			 int &padded_ntaps, int &nsamples)
+      {
+	ntaps = std::max(ntaps, 1);
+	padded_ntaps = ((ntaps - 1 + decimation - 1) / decimation) * decimation + 1;
+
+	// smallest decimation * 2^k of at least fft_factor * padded_ntaps
+	int min_size = (fft_factor * padded_ntaps + decimation - 1) / decimation;
+	int fftsize = decimation;
+	while(fftsize < min_size * decimation)
+	  fftsize *= 2;
+
+	nsamples = fftsize - padded_ntaps + 1;
+	return fftsize;
+      }
+
       fft_filter_fff::fft_filter_fff(int decimation,
 				     const std::vector<float> &taps,
 				     int nthreads)
-	: d_fftsize(-1), d_decimation(decimation), d_fwdfft(0),
-	  d_invfft(0), d_nthreads(nthreads)
+	: d_fftsize(-1), d_decimation(decimation), d_fft_factor(2),
+	  d_fwdfft(0), d_invfft(0), d_nthreads(nthreads), d_xformed_taps(0)
       {
 	set_taps(taps);
       }
@@ -71,7 +106,7 @@ namespace gr {
 	
 	// Compute forward xform of taps.
 	// Copy taps into first ntaps slots, then pad with zeros
-	for (i = 0; i < d_ntaps; i++)
+	for (i = 0; i < (int)taps.size(); i++)
 	  in[i] = taps[i] * scale;
 	
 	for (; i < d_fftsize; i++)
@@ -83,20 +118,27 @@ namespace gr {
 	for (i = 0; i < d_fftsize/2+1; i++)
 	  d_xformed_taps[i] = out[i];
 	
-	return d_nsamples;
+	return d_nsamples / d_decimation;
       }
       
-      // determine and set d_ntaps, d_nsamples, d_fftsize
+      int
+      fft_filter_fff::ntaps() const
+      {
+	return d_ntaps;
+      }
+
+      // determine and set d_ntaps, d_padded_ntaps, d_nsamples, d_fftsize
       void
       fft_filter_fff::compute_sizes(int ntaps)
       {
 	int old_fftsize = d_fftsize;
 	d_ntaps = ntaps;
-	d_fftsize = (int) (2 * pow(2.0, ceil(log(double(ntaps)) / log(2.0))));
-	d_nsamples = d_fftsize - d_ntaps + 1;
+	d_fftsize = overlap_save_sizes(ntaps, d_decimation, d_fft_factor,
+				       d_padded_ntaps, d_nsamples);
 	
 	if(VERBOSE) {
 	  std::cerr << "fft_filter_fff: ntaps = " << d_ntaps
+		    << " padded_ntaps = " << d_padded_ntaps
 		    << " fftsize = " << d_fftsize
 		    << " nsamples = " << d_nsamples << std::endl;
 	}
@@ -105,8 +147,9 @@ namespace gr {
 	if(d_fftsize != old_fftsize) {
 	  delete d_fwdfft;
 	  delete d_invfft;
+	  fft::free(d_xformed_taps);
 	  d_fwdfft = new fft::fft_real_fwd(d_fftsize);
-	  d_invfft = new fft::fft_real_rev(d_fftsize);
+	  d_invfft = new fft::fft_real_rev(d_fftsize / d_decimation);
 	  d_xformed_taps = fft::malloc_complex(d_fftsize/2+1);
 	}
       }
@@ -127,19 +170,33 @@ namespace gr {
 	return d_nthreads;
       }
       
+      void
+      fft_filter_fff::set_fft_factor(int factor)
+      {
+	if(factor < 2)
+	  throw std::invalid_argument("fft_filter_fff: fft_factor must be at least 2");
+	d_fft_factor = factor;
+      }
+
+      int
+      fft_filter_fff::fft_factor() const
+      {
+	return d_fft_factor;
+      }
+
       int
       fft_filter_fff::filter(int nitems, const float *input, float *output)
       {
-	int dec_ctr = 0;
 	int j = 0;
 	int ninput_items = nitems * d_decimation;
+	int invsize = d_fftsize / d_decimation;
+	int nout = d_nsamples / d_decimation;
+	float *in = d_fwdfft->get_inbuf();
 	
 	for (int i = 0; i < ninput_items; i += d_nsamples){
 	  
-	  memcpy(d_fwdfft->get_inbuf(), &input[i], d_nsamples * sizeof(float));
-	  
-	  for (j = d_nsamples; j < d_fftsize; j++)
-	    d_fwdfft->get_inbuf()[j] = 0;
+	  memcpy(in, &d_tail[0], tailsize() * sizeof(float));
+	  memcpy(in + tailsize(), &input[i], d_nsamples * sizeof(float));
 	  
 	  d_fwdfft->execute();	// compute fwd xform
 	  
@@ -147,30 +204,46 @@ namespace gr {
 	  gr_complex *b = d_xformed_taps;
 	  gr_complex *c = d_invfft->get_inbuf();
 	  
-	  volk_32fc_x2_multiply_32fc_a(c, a, b, d_fftsize/2+1);
+	  if(d_decimation == 1) {
+	    volk_32fc_x2_multiply_32fc_a(c, a, b, d_fftsize/2+1);
+	  }
+	  else {
+	    // Fold the spectrum onto the bins of the smaller inverse
+	    // xform; bins above d_fftsize/2 are the conjugates of the
+	    // ones below.
+	    volk_32fc_x2_multiply_32fc_a(a, a, b, d_fftsize/2+1);
+	    for (j = 0; j < invsize/2+1; j++) {
+	      gr_complex sum = 0;
+	      for (int k = j; k < d_fftsize; k += invsize)
+		sum += (k <= d_fftsize/2) ? a[k] : std::conj(a[d_fftsize - k]);
+	      c[j] = sum;
+	    }
+	  }
 	  
 	  d_invfft->execute();	// compute inv xform
 	  
-	  // add in the overlapping tail	  
-	  for (j = 0; j < tailsize(); j++)
-	    d_invfft->get_outbuf()[j] += d_tail[j];
-	  
-	  // copy nsamples to output
-	  j = dec_ctr;
-	  while (j < d_nsamples) {
-	    *output++ = d_invfft->get_outbuf()[j];
-	    j += d_decimation;
-	  }
-	  dec_ctr = (j - d_nsamples);
+	  // the last nout outputs are valid
+	  memcpy(output, d_invfft->get_outbuf() + invsize - nout,
+		 nout * sizeof(float));
+	  output += nout;
 	  
 	  // stash the tail
-	  memcpy(&d_tail[0], d_invfft->get_outbuf() + d_nsamples,
+	  memcpy(&d_tail[0], &input[i + d_nsamples - tailsize()],
 		 tailsize() * sizeof(float));
 	}
 	
 	return nitems;
       }
 
+      void
+      fft_filter_fff::set_tail(const float *history, int nitems)
+      {
+	// The padding taps only ever see the oldest part of the tail.
+	int n = std::min(nitems, tailsize());
+	std::fill(d_tail.begin(), d_tail.end() - n, float(0));
+	std::copy(history + nitems - n, history + nitems, d_tail.end() - n);
+      }
+
 
       /**************************************************************/
 
@@ -178,8 +251,8 @@ namespace gr {
       fft_filter_ccc::fft_filter_ccc(int decimation,
 				     const std::vector<gr_complex> &taps,
 				     int nthreads)
-	: d_fftsize(-1), d_decimation(decimation), d_fwdfft(0),
-	  d_invfft(0), d_nthreads(nthreads)
+	: d_fftsize(-1), d_decimation(decimation), d_fft_factor(2),
+	  d_fwdfft(0), d_invfft(0), d_nthreads(nthreads), d_xformed_taps(0)
       {
 	set_taps(taps);
       }
@@ -211,7 +284,7 @@ namespace gr {
 	
 	// Compute forward xform of taps.
 	// Copy taps into first ntaps slots, then pad with zeros
-	for(i = 0; i < d_ntaps; i++)
+	for(i = 0; i < (int)taps.size(); i++)
 	  in[i] = taps[i] * scale;
 	
 	for(; i < d_fftsize; i++)
@@ -223,20 +296,27 @@ namespace gr {
 	for(i = 0; i < d_fftsize; i++)
 	  d_xformed_taps[i] = out[i];
 	
-	return d_nsamples;
+	return d_nsamples / d_decimation;
       }
       
-      // determine and set d_ntaps, d_nsamples, d_fftsize
+      int
+      fft_filter_ccc::ntaps() const
+      {
+	return d_ntaps;
+      }
+
+      // determine and set d_ntaps, d_padded_ntaps, d_nsamples, d_fftsize
       void
       fft_filter_ccc::compute_sizes(int ntaps)
       {
 	int old_fftsize = d_fftsize;
 	d_ntaps = ntaps;
-	d_fftsize = (int) (2 * pow(2.0, ceil(log(double(ntaps)) / log(2.0))));
-	d_nsamples = d_fftsize - d_ntaps + 1;
+	d_fftsize = overlap_save_sizes(ntaps, d_decimation, d_fft_factor,
+				       d_padded_ntaps, d_nsamples);
 	
 	if(VERBOSE) {
 	  std::cerr << "fft_filter_ccc: ntaps = " << d_ntaps
+		    << " padded_ntaps = " << d_padded_ntaps
 		    << " fftsize = " << d_fftsize
 		    << " nsamples = " << d_nsamples << std::endl;
 	}
@@ -245,8 +325,9 @@ namespace gr {
 	if(d_fftsize != old_fftsize) {
 	  delete d_fwdfft;
 	  delete d_invfft;
+	  fft::free(d_xformed_taps);
 	  d_fwdfft = new fft::fft_complex(d_fftsize, true, d_nthreads);
-	  d_invfft = new fft::fft_complex(d_fftsize, false, d_nthreads);
+	  d_invfft = new fft::fft_complex(d_fftsize / d_decimation, false, d_nthreads);
 	  d_xformed_taps = fft::malloc_complex(d_fftsize);
 	}
       }
@@ -267,18 +348,31 @@ namespace gr {
 	return d_nthreads;
       }
       
+      void
+      fft_filter_ccc::set_fft_factor(int factor)
+      {
+	if(factor < 2)
+	  throw std::invalid_argument("fft_filter_ccc: fft_factor must be at least 2");
+	d_fft_factor = factor;
+      }
+
+      int
+      fft_filter_ccc::fft_factor() const
+      {
+	return d_fft_factor;
+      }
+
       int
       fft_filter_ccc::filter(int nitems, const gr_complex *input, gr_complex *output)
       {
-	int dec_ctr = 0;
-	int j = 0;
 	int ninput_items = nitems * d_decimation;
+	int invsize = d_fftsize / d_decimation;
+	int nout = d_nsamples / d_decimation;
+	gr_complex *in = d_fwdfft->get_inbuf();
 	
 	for(int i = 0; i < ninput_items; i += d_nsamples) {
-	  memcpy(d_fwdfft->get_inbuf(), &input[i], d_nsamples * sizeof(gr_complex));
-	  
-	  for(j = d_nsamples; j < d_fftsize; j++)
-	    d_fwdfft->get_inbuf()[j] = 0;
+	  memcpy(in, &d_tail[0], tailsize() * sizeof(gr_complex));
+	  memcpy(in + tailsize(), &input[i], d_nsamples * sizeof(gr_complex));
 
 	  d_fwdfft->execute();	// compute fwd xform
 
@@ -286,31 +380,42 @@ namespace gr {
 	  gr_complex *b = d_xformed_taps;
 	  gr_complex *c = d_invfft->get_inbuf();
 	  
-	  volk_32fc_x2_multiply_32fc_a(c, a, b, d_fftsize);
+	  if(d_decimation == 1) {
+	    volk_32fc_x2_multiply_32fc_a(c, a, b, d_fftsize);
+	  }
+	  else {
+	    // Fold the spectrum onto the bins of the smaller inverse
+	    // xform.
+	    volk_32fc_x2_multiply_32fc_a(a, a, b, d_fftsize);
+	    memcpy(c, a, invsize * sizeof(gr_complex));
+	    for(int k = invsize; k < d_fftsize; k += invsize)
+	      volk_32f_x2_add_32f((float*)c, (float*)c, (float*)(a + k), 2*invsize);
+	  }
 	  
 	  d_invfft->execute();	// compute inv xform
 	  
-	  // add in the overlapping tail
-	  
-	  for(j = 0; j < tailsize(); j++)
-	    d_invfft->get_outbuf()[j] += d_tail[j];
-	  
-	  // copy nsamples to output
-	  j = dec_ctr;
-	  while(j < d_nsamples) {
-	    *output++ = d_invfft->get_outbuf()[j];
-	    j += d_decimation;
-	  }
-	  dec_ctr = (j - d_nsamples);
+	  // the last nout outputs are valid
+	  memcpy(output, d_invfft->get_outbuf() + invsize - nout,
+		 nout * sizeof(gr_complex));
+	  output += nout;
 	  
 	  // stash the tail
-	  memcpy(&d_tail[0], d_invfft->get_outbuf() + d_nsamples,
+	  memcpy(&d_tail[0], &input[i + d_nsamples - tailsize()],
 		 tailsize() * sizeof(gr_complex));
 	}
 
 	return nitems;
       }
 
+      void
+      fft_filter_ccc::set_tail(const gr_complex *history, int nitems)
+      {
+	// The padding taps only ever see the oldest part of the tail.
+	int n = std::min(nitems, tailsize());
+	std::fill(d_tail.begin(), d_tail.end() - n, gr_complex(0));
+	std::copy(history + nitems - n, history + nitems, d_tail.end() - n);
+      }
+
     } /* namespace kernel */
   } /* namespace filter */
 } /* namespace gr */
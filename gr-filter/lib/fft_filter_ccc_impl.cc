@@ -25,6 +25,7 @@
 #endif
 
 #include "fft_filter_ccc_impl.h"
+#include "fft_filter_engine.h"
 #include <gnuradio/io_signature.h>
 
 #include <math.h>
@@ -49,20 +50,42 @@ namespace gr {
 			  io_signature::make (1, 1, sizeof(gr_complex)),
 			  io_signature::make (1, 1, sizeof(gr_complex)),
 			  decimation),
-	d_updated(false)
+	d_updated(false), d_engine_mode("fft"), d_fft_factor(2)
     {
-      set_history(1);
-      
       d_filter = new kernel::fft_filter_ccc(decimation, taps, nthreads);
+      d_fir = new kernel::fir_filter_ccc(decimation, taps);
 
       d_new_taps = taps;
-      d_nsamples = d_filter->set_taps(taps);
-      set_output_multiple(d_nsamples);
+      install_taps(taps);
     }
 
     fft_filter_ccc_impl::~fft_filter_ccc_impl()
     {
       delete d_filter;
+      delete d_fir;
+    }
+
+    void
+    fft_filter_ccc_impl::install_taps(const std::vector<gr_complex> &taps)
+    {
+      d_filter->set_fft_factor(d_fft_factor);
+      d_nsamples = d_filter->set_taps(taps);
+      d_fir->set_taps(taps);
+
+      if(d_engine_mode == "auto") {
+	d_use_fft = fft_filter_is_faster<gr_complex>(d_fir, d_filter,
+						     decimation(), d_nsamples);
+      }
+      else {
+	d_use_fft = (d_engine_mode == "fft");
+      }
+
+      // Both engines keep the same history, so switching between them
+      // does not shift the stream; the FFT engine picks up its
+      // overlap from it the next time it runs.
+      set_history(std::max(d_fir->ntaps(), 1u));
+      d_prime_tail = true;
+      set_output_multiple(d_use_fft ? d_nsamples : 1);
     }
 
     void
@@ -94,6 +117,36 @@ namespace gr {
 	return 0;
     }
 
+    void
+    fft_filter_ccc_impl::set_engine(const std::string &engine)
+    {
+      if(engine != "auto" && engine != "fft" && engine != "fir")
+	throw std::invalid_argument("fft_filter_ccc: engine must be \"auto\", \"fft\" or \"fir\"");
+      d_engine_mode = engine;
+      d_updated = true;
+    }
+
+    std::string
+    fft_filter_ccc_impl::engine() const
+    {
+      return d_use_fft ? "fft" : "fir";
+    }
+
+    void
+    fft_filter_ccc_impl::set_fft_factor(int factor)
+    {
+      if(factor < 2)
+	throw std::invalid_argument("fft_filter_ccc: fft_factor must be at least 2");
+      d_fft_factor = factor;
+      d_updated = true;
+    }
+
+    int
+    fft_filter_ccc_impl::fft_factor() const
+    {
+      return d_fft_factor;
+    }
+
     int
     fft_filter_ccc_impl::work(int noutput_items,
 			      gr_vector_const_void_star &input_items,
@@ -103,13 +156,22 @@ namespace gr {
       gr_complex *out = (gr_complex *) output_items[0];
       
       if (d_updated){
-	d_nsamples = d_filter->set_taps(d_new_taps);
+	install_taps(d_new_taps);
 	d_updated = false;
-	set_output_multiple(d_nsamples);
-	return 0;				// output multiple may have changed
+	return 0;		// history and output multiple may have changed
       }
-      
-      d_filter->filter(noutput_items, in, out);
+
+      if(d_use_fft) {
+	if(d_prime_tail) {
+	  d_filter->set_tail(in, history() - 1);
+	  d_prime_tail = false;
+	}
+	d_filter->filter(noutput_items, in + history() - 1, out);
+      }
+      else if(decimation() == 1)
+	d_fir->filterN(out, in, noutput_items);
+      else
+	d_fir->filterNdec(out, in, noutput_items, decimation());
 
       return noutput_items;
     }
@@ -24,6 +24,7 @@
 
 #include <gnuradio/filter/api.h>
 #include <gnuradio/filter/fft_filter.h>
+#include <gnuradio/filter/fir_filter.h>
 #include <gnuradio/filter/fft_filter_ccc.h>
 
 namespace gr {
@@ -35,7 +36,14 @@ namespace gr {
       int d_nsamples;
       bool d_updated;
       kernel::fft_filter_ccc *d_filter;
+      kernel::fir_filter_ccc *d_fir;
       std::vector<gr_complex> d_new_taps;
+      std::string d_engine_mode;
+      int d_fft_factor;
+      bool d_use_fft;
+      bool d_prime_tail;
+
+      void install_taps(const std::vector<gr_complex> &taps);
 
     public:
       fft_filter_ccc_impl(int decimation,
@@ -49,6 +57,12 @@ namespace gr {
 
       void set_nthreads(int n);
       int nthreads() const;
+
+      void set_engine(const std::string &engine);
+      std::string engine() const;
+
+      void set_fft_factor(int factor);
+      int fft_factor() const;
       
       int work(int noutput_items,
 	       gr_vector_const_void_star &input_items,
@@ -0,0 +1,87 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_FILTER_FFT_FILTER_ENGINE_H
+#define INCLUDED_FILTER_FFT_FILTER_ENGINE_H
+
+#include <gnuradio/high_res_timer.h>
+#include <algorithm>
+#include <vector>
+
+namespace gr {
+  namespace filter {
+
+    /*!
+     * \brief Times the FFT and the time domain filter kernels on the
+     * same taps and tells whether the FFT one is faster.
+     *
+     * Both kernels must already hold the taps. The FFT kernel runs
+     * whole blocks of \p nsamples outputs; the time domain kernel
+     * runs a few thousand outputs at most, fewer for long filters.
+     * The best of three runs of each is compared per output.
+     *
+     * This leaves junk in the overlap tail of the FFT kernel; call
+     * its set_tail() or set_taps() before filtering real data with it.
+     */
+    template<class T, class fir_type, class fft_type>
+    bool
+    fft_filter_is_faster(fir_type *fir, fft_type *fft,
+			 unsigned int decimation, int nsamples)
+    {
+      const int nruns = 3;
+      const unsigned int ntaps = std::max(fir->ntaps(), 1u);
+
+      // Keep the time domain run to about a million multiplies.
+      int nfft = nsamples * std::max(1, 4096 / nsamples);
+      int nfir = std::max(16, std::min(4096, (int)((1 << 20) / ntaps)));
+      int nout = std::max(nfft, nfir);
+
+      std::vector<T> in(nout * decimation + ntaps);
+      std::vector<T> out(nout);
+      for(unsigned int i = 0; i < in.size(); i++)
+	in[i] = T((i & 1) ? 1 : -1);
+
+      high_res_timer_type t_fft = 0, t_fir = 0;
+      for(int r = 0; r < nruns; r++) {
+	high_res_timer_type t0 = high_res_timer_now();
+	fft->filter(nfft, &in[0], &out[0]);
+	high_res_timer_type t1 = high_res_timer_now();
+	if(decimation == 1)
+	  fir->filterN(&out[0], &in[0], nfir);
+	else
+	  fir->filterNdec(&out[0], &in[0], nfir, decimation);
+	high_res_timer_type t2 = high_res_timer_now();
+
+	if(r == 0 || t1 - t0 < t_fft)
+	  t_fft = t1 - t0;
+	if(r == 0 || t2 - t1 < t_fir)
+	  t_fir = t2 - t1;
+      }
+
+      // t_fft/nfft < t_fir/nfir
+      return t_fft * nfir < t_fir * nfft;
+    }
+
+  } /* namespace filter */
+} /* namespace gr */
+
+#endif /* INCLUDED_FILTER_FFT_FILTER_ENGINE_H */
@@ -86,18 +86,21 @@ namespace gr {
 	return 0;
       }
 
+      if((int)d_filtered.size() < noutput_items)
+	d_filtered.resize(noutput_items);
+
       switch(input_items.size ()) {
       case 1:
+	d_fir->filterN(&d_filtered[0], in0, noutput_items);
 	for(int i = 0; i < noutput_items; i++) {
-	  out[i] = gr_complex(in0[i + d_delay],
-			      d_fir->filter(&in0[i]));
+	  out[i] = gr_complex(in0[i + d_delay], d_filtered[i]);
 	}
 	break;
 	
       case 2:
+	d_fir->filterN(&d_filtered[0], in1, noutput_items);
 	for(int j = 0; j < noutput_items; j++) {
-	  out[j] = gr_complex(in0[j + d_delay],
-			      d_fir->filter(&in1[j]));
+	  out[j] = gr_complex(in0[j + d_delay], d_filtered[j]);
 	}
 	break;
 	
@@ -36,6 +36,7 @@ namespace gr {
       unsigned int d_delay;
       kernel::fir_filter_fff *d_fir;
       std::vector<float> d_taps;
+      std::vector<float> d_filtered;
       bool d_update;
 
     public:
@@ -124,9 +124,7 @@ namespace gr {
 			      const float input[],
 			      unsigned long n)
       {
-	for(unsigned long i = 0; i < n; i++) {
-	  output[i] = filter(&input[i]);
-	}
+	volk_32f_x2_fir_32f(output, input, d_aligned_taps[0], d_ntaps, n);
       }
       
       void
@@ -238,8 +236,7 @@ namespace gr {
 			      const gr_complex input[],
 			      unsigned long n)
       {
-	for(unsigned long i = 0; i < n; i++)
-	  output[i] = filter(&input[i]);
+	volk_32fc_32f_fir_32fc(output, input, d_aligned_taps[0], d_ntaps, n);
       }
       
       
@@ -249,9 +246,16 @@ namespace gr {
 				 unsigned long n,
 				 unsigned int decimate)
       {
+	// Leaves d_output alone, unlike filter(), so that threads may
+	// share a filter here (see pfb_channelizer_ccf).
 	unsigned long j = 0;
 	for(unsigned long i = 0; i < n; i++){
-	  output[i] = filter(&input[j]);
+	  const gr_complex *ar = (gr_complex *)((unsigned long) &input[j] & ~(d_align-1));
+	  unsigned al = &input[j] - ar;
+
+	  volk_32fc_32f_dot_prod_32fc_a(&output[i], ar,
+					d_aligned_taps[al],
+					(d_ntaps+al));
 	  j += decimate;
 	}
       }
@@ -356,8 +360,7 @@ namespace gr {
 			      const float input[],
 			      unsigned long n)
       {
-	for(unsigned long i = 0; i < n; i++)
-	  output[i] = filter(&input[i]);
+	volk_32f_32fc_fir_32fc(output, input, d_aligned_taps[0], d_ntaps, n);
       }
       
       
@@ -470,8 +473,7 @@ namespace gr {
 			      const gr_complex input[],
 			      unsigned long n)
       {
-	for(unsigned long i = 0; i < n; i++)
-	  output[i] = filter(&input[i]);
+	volk_32fc_x2_fir_32fc(output, input, d_aligned_taps[0], d_ntaps, n);
       }
       
       
@@ -585,8 +587,7 @@ namespace gr {
 			      const short input[],
 			      unsigned long n)
       {
-	for(unsigned long i = 0; i < n; i++)
-	  output[i] = filter(&input[i]);
+	volk_16i_32fc_fir_32fc(output, input, d_aligned_taps[0], d_ntaps, n);
       }
       
       
@@ -141,11 +141,16 @@ namespace gr {
       int nfilters = interpolation();
       int ni = noutput_items / interpolation();
 
-      for(int i = 0; i < ni; i++) {
-	for(int nf = 0; nf < nfilters; nf++) {
-	  out[nf] = d_firs[nf]->filter(&in[i]);
+      if((int)d_phase_out.size() < ni)
+	d_phase_out.resize(ni);
+
+      // Run each phase over the whole block, so its filter can work
+      // on several outputs at a time, then interleave the phases.
+      for(int nf = 0; nf < nfilters; nf++) {
+	d_firs[nf]->filterN(&d_phase_out[0], in, ni);
+	for(int i = 0; i < ni; i++) {
+	  out[i*nfilters + nf] = d_phase_out[i];
 	}
-	out += nfilters;
       }
 
       return noutput_items;
@@ -39,6 +39,7 @@ namespace gr {
       bool d_updated;
       std::vector<kernel::@FIR_TYPE@ *> d_firs;
       std::vector<@TAP_TYPE@> d_new_taps;
+      std::vector<@O_TYPE@> d_phase_out;
 
       void install_taps(const std::vector<@TAP_TYPE@> &taps);
 
@@ -26,6 +26,8 @@
 
 #include "pfb_channelizer_ccf_impl.h"
 #include <gnuradio/io_signature.h>
+#include <boost/bind.hpp>
+#include <string.h>
 
 namespace gr {
   namespace filter {
@@ -45,7 +47,8 @@ namespace gr {
 		 io_signature::make(nfilts, nfilts, sizeof(gr_complex)),
 		 io_signature::make(1, nfilts, sizeof(gr_complex))),
 	polyphase_filterbank(nfilts, taps),
-	d_updated(false), d_oversample_rate(oversample_rate)
+	d_updated(false), d_oversample_rate(oversample_rate),
+	d_nthreads(1), d_nthreads_req(1), d_barrier(0), d_stopping(false)
     {
       // The over sampling rate must be rationally related to the number of channels
       // in that it must be N/i for i in [1,N], which gives an outputsample rate
@@ -79,7 +82,28 @@ namespace gr {
       d_output_multiple = 1;
       while((d_output_multiple * d_rate_ratio) % d_nfilts != 0)
 	d_output_multiple++;
+
+      // Walk one such round the way the filtering does it, one
+      // output at a time (see general_work).
+      int i = -1, n = 1;
+      d_phase_last.resize(d_output_multiple);
+      d_phase_n.resize(d_output_multiple);
+      for(int p = 0; p < d_output_multiple; p++) {
+	i = (i + d_rate_ratio) % d_nfilts;
+	d_phase_last[p] = i;
+	d_phase_n[p] = n;
+	n += (i + d_rate_ratio) >= (int)d_nfilts;
+      }
+      d_phase_stride = n - 1;
+
       set_output_multiple(d_output_multiple);
+      make_filter_set();
+
+      // Work in batches of up to several thousand FFT points, in
+      // whole rounds.
+      d_batch_rounds = std::max(1, 8192 / (int)(d_nfilts * d_output_multiple));
+      d_batch = d_batch_rounds * d_output_multiple;
+      start_workers();
 
       // History is the length of each filter arm plus 1.
       // The +1 comes from the channel mapping in the work function
@@ -89,15 +113,145 @@ namespace gr {
 
     pfb_channelizer_ccf_impl::~pfb_channelizer_ccf_impl()
     {
+      stop_workers();
       delete [] d_idxlut;
     }
 
+    void
+    pfb_channelizer_ccf_impl::make_filter_set()
+    {
+      boost::shared_ptr<filter_set> set(new filter_set(d_nfilts));
+      for(unsigned int i = 0; i < d_nfilts; i++)
+	(*set)[i].reset(new kernel::fir_filter_ccf(1, d_taps[i]));
+      d_set = set;
+    }
+
+    void
+    pfb_channelizer_ccf_impl::start_workers()
+    {
+      for(int t = 0; t < d_nthreads; t++) {
+	// Bin k of output step q is at k*d_batch + q
+	d_ffts.push_back(new fft::fft_complex_many(d_nfilts, d_batch, d_batch, 1, false));
+	memset(d_ffts[t]->get_inbuf(), 0, d_nfilts * d_batch * sizeof(gr_complex));
+	d_scratch.push_back(std::vector<gr_complex>(d_batch));
+      }
+
+      if(d_nthreads > 1) {
+	d_stopping = false;
+	d_barrier = new boost::barrier(d_nthreads);
+	for(int t = 1; t < d_nthreads; t++)
+	  d_workers.create_thread(boost::bind(&pfb_channelizer_ccf_impl::worker, this, t));
+      }
+    }
+
+    void
+    pfb_channelizer_ccf_impl::stop_workers()
+    {
+      if(d_barrier) {
+	d_stopping = true;
+	d_barrier->wait();
+	d_workers.join_all();
+	delete d_barrier;
+	d_barrier = 0;
+      }
+
+      for(unsigned int t = 0; t < d_ffts.size(); t++)
+	delete d_ffts[t];
+      d_ffts.clear();
+      d_scratch.clear();
+    }
+
+    void
+    pfb_channelizer_ccf_impl::worker(int t)
+    {
+      while(true) {
+	d_barrier->wait();	// wait for general_work
+	if(d_stopping)
+	  return;
+	process(t);
+      }
+    }
+
+    void
+    pfb_channelizer_ccf_impl::sync()
+    {
+      if(d_barrier)
+	d_barrier->wait();
+    }
+
+    void
+    pfb_channelizer_ccf_impl::process(int t)
+    {
+      const size_t noutputs = d_out->size();
+
+      // Read once: after the last sync general_work may already be
+      // setting up the next call.
+      const int nrounds = d_nrounds;
+      const int nbatches = (nrounds + d_batch_rounds - 1) / d_batch_rounds;
+
+      // Each thread takes one batch at a time; the last one of the
+      // call may be short.
+      for(int first = 0; first < nbatches; first += d_nthreads) {
+	int nb = std::min(d_nthreads, nbatches - first);
+
+	// Filter: this thread's streams, over all the batches. Within
+	// one step of the round, a stream always goes through the same
+	// filter and reads d_phase_stride samples further on each round.
+	for(unsigned int j = t; j < d_nfilts; j += d_nthreads) {
+	  const gr_complex *in = (const gr_complex*)(*d_in)[j];
+
+	  for(int tt = 0; tt < nb; tt++) {
+	    gr_complex *buf = d_ffts[tt]->get_inbuf() + d_idxlut[j] * d_batch;
+	    int round = (first + tt) * d_batch_rounds;
+	    int nr = std::min(d_batch_rounds, nrounds - round);
+
+	    for(int p = 0; p < d_output_multiple; p++) {
+	      int last = d_phase_last[p];
+	      int f = (last - (int)j + d_nfilts) % d_nfilts;
+	      int n = d_phase_n[p] - ((int)j > last) + round * d_phase_stride;
+
+	      gr_complex *out = (d_output_multiple == 1) ? buf : &d_scratch[t][0];
+	      // Threads may share a filter: neither call writes to it.
+	      if(d_phase_stride == 1)
+		(*d_work_set)[f]->filterN(out, &in[n], nr);
+	      else
+		(*d_work_set)[f]->filterNdec(out, &in[n], nr, d_phase_stride);
+
+	      if(d_output_multiple > 1) {
+		for(int q = 0; q < nr; q++)
+		  buf[q * d_output_multiple + p] = out[q];
+	      }
+	    }
+	  }
+	}
+	sync();
+
+	// despin through FFT
+	if(t < nb)
+	  d_ffts[t]->execute();
+	sync();
+
+	// Send this thread's share of the output channels
+	for(size_t nn = t; nn < noutputs; nn += d_nthreads) {
+	  gr_complex *out = (gr_complex*)(*d_out)[nn] + first * d_batch;
+	  for(int tt = 0; tt < nb; tt++) {
+	    int nr = std::min(d_batch_rounds, nrounds - (first + tt) * d_batch_rounds);
+	    memcpy(out + tt * d_batch,
+		   d_ffts[tt]->get_outbuf() + d_work_map[nn] * d_batch,
+		   nr * d_output_multiple * sizeof(gr_complex));
+	  }
+	}
+	sync();
+      }
+    }
+
     void
     pfb_channelizer_ccf_impl::set_taps(const std::vector<float> &taps)
     {
       gr::thread::scoped_lock guard(d_mutex);
 
       polyphase_filterbank::set_taps(taps);
+      make_filter_set();
       set_history(d_taps_per_filter+1);
       d_updated = true;
     }
@@ -134,57 +288,64 @@ namespace gr {
       return d_channel_map;
     }
 
+    void
+    pfb_channelizer_ccf_impl::set_nthreads(int n)
+    {
+      gr::thread::scoped_lock guard(d_mutex);
+
+      if(n < 1)
+	throw std::invalid_argument("pfb_channelizer_ccf_impl::set_nthreads: need at least one thread.\n");
+
+      // The threads are only started and stopped by general_work,
+      // between calls.
+      d_nthreads_req = n;
+    }
+
+    int
+    pfb_channelizer_ccf_impl::nthreads() const
+    {
+      return d_nthreads_req;
+    }
+
     int
     pfb_channelizer_ccf_impl::general_work(int noutput_items,
 					   gr_vector_int &ninput_items,
 					   gr_vector_const_void_star &input_items,
 					   gr_vector_void_star &output_items)
     {
-      gr::thread::scoped_lock guard(d_mutex);
-
-      gr_complex *in = (gr_complex *) input_items[0];
-      gr_complex *out = (gr_complex *) output_items[0];
-      
-      if(d_updated) {
-	d_updated = false;
-	return 0;		     // history requirements may have changed.
-      }
-
-      size_t noutputs = output_items.size();
+      int nthreads;
+      {
+	gr::thread::scoped_lock guard(d_mutex);
 
-      int n=1, i=-1, j=0, oo=0, last;
-      int toconsume = (int)rintf(noutput_items/d_oversample_rate);
-      while(n <= toconsume) {
-	j = 0;
-	i = (i + d_rate_ratio) % d_nfilts;
-	last = i;
-	while(i >= 0) {
-	  in = (gr_complex*)input_items[j];
-	  d_fft->get_inbuf()[d_idxlut[j]] = d_filters[i]->filter(&in[n]);
-	  j++;
-	  i--;
+	if(d_updated) {
+	  d_updated = false;
+	  return 0;		     // history requirements may have changed.
 	}
 
-	i = d_nfilts-1;
-	while(i > last) {
-	  in = (gr_complex*)input_items[j];
-	  d_fft->get_inbuf()[d_idxlut[j]] = d_filters[i]->filter(&in[n-1]);
-	  j++;
-	  i--;
-	}
+	d_work_set = d_set;
+	d_work_map = d_channel_map;
+	nthreads = d_nthreads_req;
+      }
 
-	n += (i+d_rate_ratio) >= (int)d_nfilts;
+      if(nthreads != d_nthreads) {
+	stop_workers();
+	d_nthreads = nthreads;
+	start_workers();
+      }
 
-	// despin through FFT
-	d_fft->execute();
+      // Each output step gives streams 0 up to 'last' a new sample,
+      // filtered by filters 'last' down to 0; the other streams
+      // reuse their previous sample with the remaining filters. The
+      // FFT of the filter outputs despins the channels. Steps are
+      // done in batches: each filter computes all its outputs of a
+      // batch in one go, and one plan does all the FFTs of a batch.
+      int toconsume = (int)rintf(noutput_items/d_oversample_rate);
 
-	// Send to output channels
-	for(unsigned int nn = 0; nn < noutputs; nn++) {
-	  out = (gr_complex*)output_items[nn];
-	  out[oo] = d_fft->get_outbuf()[d_channel_map[nn]];
-	}
-	oo++;
-      }
+      d_in = &input_items;
+      d_out = &output_items;
+      d_nrounds = noutput_items / d_output_multiple;
+      sync();			// start the worker threads
+      process(0);
 
       consume_each(toconsume);
       return noutput_items;
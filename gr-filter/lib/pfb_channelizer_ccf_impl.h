@@ -28,6 +28,9 @@
 #include <gnuradio/filter/fir_filter.h>
 #include <gnuradio/fft/fft.h>
 #include <gnuradio/thread/thread.h>
+#include <gnuradio/thread/thread_group.h>
+#include <boost/thread/barrier.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace gr {
   namespace filter {
@@ -43,6 +46,46 @@ namespace gr {
       std::vector<int> d_channel_map;
       gr::thread::mutex     d_mutex; // mutex to protect set/work access
 
+      // The filters work runs on. set_taps() makes a new set rather
+      // than changing the one a call may be working with, so work
+      // holds d_mutex only to take the latest set and channel map.
+      typedef std::vector<boost::shared_ptr<kernel::fir_filter_ccf> > filter_set;
+      boost::shared_ptr<filter_set> d_set;
+      boost::shared_ptr<filter_set> d_work_set;
+      std::vector<int> d_work_map;
+
+      // The streams given new samples and the filters they use repeat
+      // every d_output_multiple outputs; per step of that cycle, the
+      // last stream given a new sample and the offset it reads at.
+      std::vector<int> d_phase_last;
+      std::vector<int> d_phase_n;
+      int              d_phase_stride;  // input samples per cycle
+
+      // Work is done in batches of d_batch outputs (d_batch_rounds
+      // cycles), one batch per thread at a time; d_ffts[t] holds
+      // thread t's batch.
+      int              d_nthreads;
+      int              d_nthreads_req;  // applied by the next call
+      int              d_batch_rounds;
+      int              d_batch;
+      std::vector<fft::fft_complex_many*> d_ffts;
+      std::vector<std::vector<gr_complex> > d_scratch;
+      gr::thread::thread_group d_workers;
+      boost::barrier  *d_barrier;
+      bool             d_stopping;
+
+      // the call being worked on, for the worker threads
+      gr_vector_const_void_star *d_in;
+      gr_vector_void_star *d_out;
+      int              d_nrounds;
+
+      void make_filter_set();
+      void start_workers();
+      void stop_workers();
+      void worker(int t);
+      void process(int t);
+      void sync();
+
     public:
       pfb_channelizer_ccf_impl(unsigned int nfilts,
 			       const std::vector<float> &taps,
@@ -57,6 +100,9 @@ namespace gr {
       void set_channel_map(const std::vector<int> &map);
       std::vector<int> channel_map() const;
 
+      void set_nthreads(int n);
+      int nthreads() const;
+
       int general_work(int noutput_items,
 		       gr_vector_int &ninput_items,
 		       gr_vector_const_void_star &input_items,
@@ -27,6 +27,7 @@
 
 #include <qa_filter.h>
 #include <qa_firdes.h>
+#include <qa_fir_filter.h>
 #include <qa_fir_filter_with_buffer.h>
 #include <qa_mmse_fir_interpolator_cc.h>
 #include <qa_mmse_fir_interpolator_ff.h>
@@ -37,6 +38,7 @@ qa_gr_filter::suite ()
   CppUnit::TestSuite *s = new CppUnit::TestSuite ("gr-filter");
 
   s->addTest(gr::filter::qa_firdes::suite());
+  s->addTest(gr::filter::qa_fir_filter::suite());
   s->addTest(gr::filter::fff::qa_fir_filter_with_buffer_fff::suite());
   s->addTest(gr::filter::ccc::qa_fir_filter_with_buffer_ccc::suite());
   s->addTest(gr::filter::ccf::qa_fir_filter_with_buffer_ccf::suite());
@@ -0,0 +1,138 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gnuradio/types.h>
+#include <qa_fir_filter.h>
+#include <gnuradio/filter/fir_filter.h>
+#include <cppunit/TestAssert.h>
+#include <cmath>
+#include <gnuradio/random.h>
+#include <vector>
+
+namespace gr {
+  namespace filter {
+
+#define	ERR_DELTA	(1e-5)
+
+    static float
+    uniform()
+    {
+      return 2.0 * ((float)(::random()) / RANDOM_MAX - 0.5); // uniformly (-1, 1)
+    }
+
+    static void random_value(float &x) { x = uniform(); }
+    static void random_value(short &x) { x = (short)rint(uniform() * 32767); }
+    static void random_value(gr_complex &x) { x = gr_complex(uniform(), uniform()); }
+
+    static float      promote(float x) { return x; }
+    static float      promote(short x) { return x; }
+    static gr_complex promote(gr_complex x) { return x; }
+
+    //
+    // Test for ntaps in [0,29], output lengths in [0,37] and three
+    // input offsets. This exercises the outputs and taps left over
+    // by the kernels that compute several outputs at once.
+    //
+    template<class filter_type, class i_type, class o_type, class tap_type>
+    static void
+    test_filterN(double max_input)
+    {
+      const int MAX_TAPS   = 29;
+      const int OUTPUT_LEN = 37;
+      const int INPUT_LEN  = MAX_TAPS + OUTPUT_LEN + 2;
+
+      std::vector<i_type>   input(INPUT_LEN);
+      std::vector<tap_type> taps(MAX_TAPS);
+      std::vector<o_type>   expected_output(OUTPUT_LEN);
+      std::vector<o_type>   actual_output(OUTPUT_LEN);
+
+      srandom(0);	// we want reproducibility
+
+      for(int n = 0; n <= MAX_TAPS; n++) {
+	for(int ol = 0; ol <= OUTPUT_LEN; ol++) {
+	  const i_type *in = &input[ol % 3];
+
+	  // build random test case
+	  for(int i = 0; i < INPUT_LEN; i++)
+	    random_value(input[i]);
+	  for(int i = 0; i < MAX_TAPS; i++)
+	    random_value(taps[i]);
+
+	  // compute expected output values; the filter applies the
+	  // taps time reversed
+	  for(int o = 0; o < ol; o++) {
+	    o_type sum = 0;
+	    for(int i = 0; i < n; i++)
+	      sum += promote(in[o+i]) * taps[n-1-i];
+	    expected_output[o] = sum;
+	  }
+
+	  // build filter
+	  std::vector<tap_type> f_taps(taps.begin(), taps.begin() + n);
+	  filter_type f(1, f_taps);
+
+	  f.filterN(&actual_output[0], in, ol);
+
+	  for(int o = 0; o < ol; o++) {
+	    CPPUNIT_ASSERT_DOUBLES_EQUAL(0, std::abs(expected_output[o] - actual_output[o]),
+					 (n+1) * max_input * ERR_DELTA);
+	  }
+	}
+      }
+    }
+
+    void
+    qa_fir_filter::t_fff()
+    {
+      test_filterN<kernel::fir_filter_fff, float, float, float>(1.0);
+    }
+
+    void
+    qa_fir_filter::t_ccf()
+    {
+      test_filterN<kernel::fir_filter_ccf, gr_complex, gr_complex, float>(1.0);
+    }
+
+    void
+    qa_fir_filter::t_fcc()
+    {
+      test_filterN<kernel::fir_filter_fcc, float, gr_complex, gr_complex>(1.0);
+    }
+
+    void
+    qa_fir_filter::t_ccc()
+    {
+      test_filterN<kernel::fir_filter_ccc, gr_complex, gr_complex, gr_complex>(2.0);
+    }
+
+    void
+    qa_fir_filter::t_scc()
+    {
+      test_filterN<kernel::fir_filter_scc, short, gr_complex, gr_complex>(32767.0);
+    }
+
+  } /* namespace filter */
+} /* namespace gr */
@@ -0,0 +1,58 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _QA_FIR_FILTER_H_
+#define _QA_FIR_FILTER_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCase.h>
+
+namespace gr {
+  namespace filter {
+
+    /*!
+     * Checks the block-based kernel::fir_filter_XXX::filterN against
+     * a plain dot product for every tap count and output length in a
+     * range, which covers the remainders of the multi-output kernels.
+     */
+    class qa_fir_filter : public CppUnit::TestCase
+    {
+      CPPUNIT_TEST_SUITE(qa_fir_filter);
+      CPPUNIT_TEST(t_fff);
+      CPPUNIT_TEST(t_ccf);
+      CPPUNIT_TEST(t_fcc);
+      CPPUNIT_TEST(t_ccc);
+      CPPUNIT_TEST(t_scc);
+      CPPUNIT_TEST_SUITE_END();
+
+    private:
+      void t_fff();
+      void t_ccf();
+      void t_fcc();
+      void t_ccc();
+      void t_scc();
+    };
+
+  } /* namespace filter */
+} /* namespace gr */
+
+#endif /* _QA_FIR_FILTER_H_ */
@@ -77,6 +77,9 @@ class channelizer_ccf(gr.hier_block2):
     def set_channel_map(self, newmap):
         self.pfb.set_channel_map(newmap)
 
+    def set_nthreads(self, n):
+        self.pfb.set_nthreads(n)
+
 
 
 class interpolator_ccf(gr.hier_block2):
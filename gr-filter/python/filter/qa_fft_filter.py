@@ -375,6 +375,111 @@ class test_fft_filter(gr_unittest.TestCase):
             self.assertComplexTuplesAlmostEqual(taps, result_data, 4)
 
 
+    def test_ccc_engine(self):
+        # Both engines, and the automatic choice, give the same output
+        random.seed(0)
+        for i in xrange(10):
+            dec = i % 3 + 1
+            src_data = make_random_complex_tuple(4*1024)
+            ntaps = int(random.uniform(2, 300))
+            taps = make_random_complex_tuple(ntaps)
+            expected_result = reference_filter_ccc(dec, taps, src_data)
+
+            for engine in ("fft", "fir", "auto"):
+                src = blocks.vector_source_c(src_data)
+                op = filter.fft_filter_ccc(dec, taps)
+                op.set_engine(engine)
+                dst = blocks.vector_sink_c()
+                tb = gr.top_block()
+                tb.connect(src, op, dst)
+                tb.run()
+                del tb
+
+                self.assertTrue(op.engine() in ("fft", "fir"))
+                if engine != "auto":
+                    self.assertEqual(engine, op.engine())
+                self.assert_fft_ok2(expected_result, dst.data())
+
+    def test_fff_engine(self):
+        # Both engines, and the automatic choice, give the same output
+        random.seed(0)
+        for i in xrange(10):
+            dec = i % 3 + 1
+            src_data = make_random_float_tuple(4*1024)
+            ntaps = int(random.uniform(2, 300))
+            taps = make_random_float_tuple(ntaps)
+            expected_result = reference_filter_fff(dec, taps, src_data)
+
+            for engine in ("fft", "fir", "auto"):
+                src = blocks.vector_source_f(src_data)
+                op = filter.fft_filter_fff(dec, taps)
+                op.set_engine(engine)
+                dst = blocks.vector_sink_f()
+                tb = gr.top_block()
+                tb.connect(src, op, dst)
+                tb.run()
+                del tb
+
+                self.assertTrue(op.engine() in ("fft", "fir"))
+                if engine != "auto":
+                    self.assertEqual(engine, op.engine())
+                self.assert_fft_float_ok2(expected_result, dst.data())
+
+
+    def test_ccc_fft_factor(self):
+        # Decimating overlap-save with larger FFT sizes
+        random.seed(0)
+        for dec in (2, 3, 8, 32):
+            src_data = make_random_complex_tuple(8*1024)
+            ntaps = int(random.uniform(2, 300))
+            taps = make_random_complex_tuple(ntaps)
+            expected_result = reference_filter_ccc(dec, taps, src_data)
+
+            for factor in (2, 4, 8):
+                src = blocks.vector_source_c(src_data)
+                op = filter.fft_filter_ccc(dec, taps)
+                op.set_engine("fft")
+                op.set_fft_factor(factor)
+                dst = blocks.vector_sink_c()
+                tb = gr.top_block()
+                tb.connect(src, op, dst)
+                tb.run()
+                del tb
+
+                self.assertEqual(factor, op.fft_factor())
+                self.assert_fft_ok2(expected_result, dst.data())
+
+    def test_fff_fft_factor(self):
+        # Decimating overlap-save with larger FFT sizes
+        random.seed(0)
+        for dec in (2, 3, 8, 32):
+            src_data = make_random_float_tuple(8*1024)
+            ntaps = int(random.uniform(2, 300))
+            taps = make_random_float_tuple(ntaps)
+            expected_result = reference_filter_fff(dec, taps, src_data)
+
+            for factor in (2, 4, 8):
+                src = blocks.vector_source_f(src_data)
+                op = filter.fft_filter_fff(dec, taps)
+                op.set_engine("fft")
+                op.set_fft_factor(factor)
+                dst = blocks.vector_sink_f()
+                tb = gr.top_block()
+                tb.connect(src, op, dst)
+                tb.run()
+                del tb
+
+                self.assertEqual(factor, op.fft_factor())
+                self.assert_fft_float_ok2(expected_result, dst.data())
+
+    def test_engine_default(self):
+        # The FFT engine is used unless another is asked for
+        taps = make_random_float_tuple(5)
+        self.assertEqual("fft", filter.fft_filter_fff(1, taps).engine())
+        taps = make_random_complex_tuple(5)
+        self.assertEqual("fft", filter.fft_filter_ccc(1, taps).engine())
+
+
 if __name__ == '__main__':
     gr_unittest.run(test_fft_filter, "test_fft_filter.xml")
 
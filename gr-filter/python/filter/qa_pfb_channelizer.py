@@ -112,5 +112,46 @@ class test_pfb_channelizer(gr_unittest.TestCase):
         self.assertComplexTuplesAlmostEqual(expected3_data[-Ntest:], dst3_data[-Ntest:], 3)
         self.assertComplexTuplesAlmostEqual(expected4_data[-Ntest:], dst4_data[-Ntest:], 3)
 
+    def run_channelizer(self, M, osr, nthreads, data):
+        taps = filter.firdes.low_pass_2(1, M, 0.5, 0.1, attenuation_dB=80)
+        src = blocks.vector_source_c(data)
+        s2ss = blocks.stream_to_streams(gr.sizeof_gr_complex, M)
+        pfb = filter.pfb_channelizer_ccf(M, taps, osr)
+        pfb.set_nthreads(nthreads)
+        self.assertEqual(nthreads, pfb.nthreads())
+
+        tb = gr.top_block()
+        tb.connect(src, s2ss)
+        snks = list()
+        for i in xrange(M):
+            snks.append(blocks.vector_sink_c())
+            tb.connect((s2ss,i), (pfb,i))
+            tb.connect((pfb, i), snks[i])
+        tb.run()
+        return [s.data() for s in snks]
+
+    def test_001(self):
+        # Threads share out the work; the output must not change
+        M = 8
+        data = sig_source_c(1000, 123, 1, 20000)
+        for osr in (1, 2, 4):
+            expected = self.run_channelizer(M, osr, 1, data)
+            for nthreads in (2, 3):
+                result = self.run_channelizer(M, osr, nthreads, data)
+                for i in xrange(M):
+                    self.assertComplexTuplesAlmostEqual(expected[i], result[i], 5)
+
+    def test_002(self):
+        # Oversample rates that do not divide M read several input
+        # samples per round and filter through filterNdec
+        M = 8
+        data = sig_source_c(1000, 123, 1, 20000)
+        for osr in (8/3., 8/5.):
+            expected = self.run_channelizer(M, osr, 1, data)
+            for nthreads in (2, 3):
+                result = self.run_channelizer(M, osr, nthreads, data)
+                for i in xrange(M):
+                    self.assertComplexTuplesAlmostEqual(expected[i], result[i], 5)
+
 if __name__ == '__main__':
     gr_unittest.run(test_pfb_channelizer, "test_pfb_channelizer.xml")
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <gnuradio/trellis/core_algorithms.h>
 #include <gnuradio/trellis/calc_metric.h>
+#include "trellis_engine.h"
 
 namespace gr {
   namespace trellis {
@@ -54,57 +55,7 @@ namespace gr {
 		      const float *in, T *out)//,
                       //std::vector<int> &trace)
     {
-      std::vector<int> trace(S*K);
-      std::vector<float> alpha(S*2);
-      int alphai;
-      float norm,mm,minm;
-      int minmi;
-      int st;
-
-      if(S0<0) { // initial state not specified
-	for(int i=0;i<S;i++) alpha[0*S+i]=0;
-      }
-      else {
-	for(int i=0;i<S;i++) alpha[0*S+i]=INF;
-	alpha[0*S+S0]=0.0;
-      }
-
-      alphai=0;
-      for(int k=0;k<K;k++) {
-	norm=INF;
-	for(int j=0;j<S;j++) { // for each next state do ACS
-          minm=INF;
-          minmi=0;
-          for(unsigned int i=0;i<PS[j].size();i++) {
-	    //int i0 = j*I+i;
-	    if((mm=alpha[alphai*S+PS[j][i]]+in[k*O+OS[PS[j][i]*I+PI[j][i]]])<minm)
-	      minm=mm,minmi=i;
-          }
-          trace[k*S+j]=minmi;
-          alpha[((alphai+1)%2)*S+j]=minm;
-          if(minm<norm) norm=minm;
-	}
-	for(int j=0;j<S;j++)
-          alpha[((alphai+1)%2)*S+j]-=norm; // normalize total metrics so they do not explode
-	alphai=(alphai+1)%2;
-      }
-
-      if(SK<0) { // final state not specified
-	minm=INF;
-	minmi=0;
-	for(int i=0;i<S;i++)
-          if((mm=alpha[alphai*S+i])<minm) minm=mm,minmi=i;
-	st=minmi;
-      }
-      else {
-	st=SK;
-      }
-
-      for(int k=K-1;k>=0;k--) { // traceback
-	int i0=trace[k*S+st];
-	out[k]= (T) PI[st][i0];
-	st=PS[st][i0];
-      }
+      trellis_engine(I, S, O, NS, OS, PS, PI).viterbi(K, S0, SK, in, out);
     }
 
     template void
@@ -152,61 +103,7 @@ namespace gr {
 			       digital::trellis_metric_type_t TYPE,
 			       const Ti *in, To *out)
     {
-      std::vector<int> trace(S*K);
-      std::vector<float> alpha(S*2);
-      float *metric = new float[O];
-      int alphai;
-      float norm,mm,minm;
-      int minmi;
-      int st;
-
-      if(S0<0) { // initial state not specified
-	for(int i=0;i<S;i++) alpha[0*S+i]=0;
-      }
-      else {
-	for(int i=0;i<S;i++) alpha[0*S+i]=INF;
-	alpha[0*S+S0]=0.0;
-      }
-
-      alphai=0;
-      for(int k=0;k<K;k++) {
-	calc_metric(O, D, TABLE, &(in[k*D]), metric,TYPE); // calc metrics
-	norm=INF;
-	for(int j=0;j<S;j++) { // for each next state do ACS
-          minm=INF;
-          minmi=0;
-          for(unsigned int i=0;i<PS[j].size();i++) {
-	    //int i0 = j*I+i;
-	    if((mm=alpha[alphai*S+PS[j][i]]+metric[OS[PS[j][i]*I+PI[j][i]]])<minm)
-	      minm=mm,minmi=i;
-          }
-          trace[k*S+j]=minmi;
-          alpha[((alphai+1)%2)*S+j]=minm;
-          if(minm<norm) norm=minm;
-	}
-	for(int j=0;j<S;j++)
-          alpha[((alphai+1)%2)*S+j]-=norm; // normalize total metrics so they do not explode
-	alphai=(alphai+1)%2;
-      }
-
-      if(SK<0) { // final state not specified
-	minm=INF;
-	minmi=0;
-	for(int i=0;i<S;i++)
-          if((mm=alpha[alphai*S+i])<minm) minm=mm,minmi=i;
-	st=minmi;
-      }
-      else {
-	st=SK;
-      }
-
-      for(int k=K-1;k>=0;k--) { // traceback
-	int i0=trace[k*S+st];
-	out[k]= (To) PI[st][i0];
-	st=PS[st][i0];
-      }
-
-      delete [] metric;
+      trellis_engine(I, S, O, NS, OS, PS, PI).viterbi_combined(K, S0, SK, D, TABLE, TYPE, in, out);
     }
 
     // Ti = s i f c
@@ -391,130 +288,8 @@ namespace gr {
 		   //std::vector<float> &beta
 		   )
     {
-      float norm,mm,minm;
-      std::vector<float> alpha(S*(K+1));
-      std::vector<float> beta(S*(K+1));
-
-      if(S0<0) { // initial state not specified
-	for(int i=0;i<S;i++) alpha[0*S+i]=0;
-      }
-      else {
-	for(int i=0;i<S;i++) alpha[0*S+i]=INF;
-	alpha[0*S+S0]=0.0;
-      }
-
-      for(int k=0;k<K;k++) { // forward recursion
-	norm=INF;
-	for(int j=0;j<S;j++) {
-          minm=INF;
-          for(unsigned int i=0;i<PS[j].size();i++) {
-	    //int i0 = j*I+i;
-	    mm=alpha[k*S+PS[j][i]]+priori[k*I+PI[j][i]]+prioro[k*O+OS[PS[j][i]*I+PI[j][i]]];
-	    minm=(*p2mymin)(minm,mm);
-          }
-          alpha[(k+1)*S+j]=minm;
-          if(minm<norm) norm=minm;
-	}
-	for(int j=0;j<S;j++)
-          alpha[(k+1)*S+j]-=norm; // normalize total metrics so they do not explode
-      }
-
-      if(SK<0) { // final state not specified
-	for(int i=0;i<S;i++) beta[K*S+i]=0;
-      }
-      else {
-	for(int i=0;i<S;i++) beta[K*S+i]=INF;
-	beta[K*S+SK]=0.0;
-      }
-
-      for(int k=K-1;k>=0;k--) { // backward recursion
-	norm=INF;
-	for(int j=0;j<S;j++) {
-          minm=INF;
-          for(int i=0;i<I;i++) {
-	    int i0 = j*I+i;
-	    mm=beta[(k+1)*S+NS[i0]]+priori[k*I+i]+prioro[k*O+OS[i0]];
-	    minm=(*p2mymin)(minm,mm);
-          }
-          beta[k*S+j]=minm;
-          if(minm<norm) norm=minm;
-	}
-	for(int j=0;j<S;j++)
-          beta[k*S+j]-=norm; // normalize total metrics so they do not explode
-      }
-
-      if(POSTI && POSTO)
-	{
-	  for(int k=0;k<K;k++) { // input combining
-	    norm=INF;
-	    for(int i=0;i<I;i++) {
-	      minm=INF;
-	      for(int j=0;j<S;j++) {
-		mm=alpha[k*S+j]+prioro[k*O+OS[j*I+i]]+beta[(k+1)*S+NS[j*I+i]];
-		minm=(*p2mymin)(minm,mm);
-	      }
-	      post[k*(I+O)+i]=minm;
-	      if(minm<norm) norm=minm;
-	    }
-	    for(int i=0;i<I;i++)
-	      post[k*(I+O)+i]-=norm; // normalize metrics
-	  }
-
-	  for(int k=0;k<K;k++) { // output combining
-	    norm=INF;
-	    for(int n=0;n<O;n++) {
-	      minm=INF;
-	      for(int j=0;j<S;j++) {
-		for(int i=0;i<I;i++) {
-                  mm= (n==OS[j*I+i] ? alpha[k*S+j]+priori[k*I+i]+beta[(k+1)*S+NS[j*I+i]] : INF);
-                  minm=(*p2mymin)(minm,mm);
-		}
-	      }
-	      post[k*(I+O)+I+n]=minm;
-	      if(minm<norm) norm=minm;
-	    }
-	    for(int n=0;n<O;n++)
-	      post[k*(I+O)+I+n]-=norm; // normalize metrics
-	  }
-	}
-      else if(POSTI)
-	{
-	  for(int k=0;k<K;k++) { // input combining
-	    norm=INF;
-	    for(int i=0;i<I;i++) {
-	      minm=INF;
-	      for(int j=0;j<S;j++) {
-		mm=alpha[k*S+j]+prioro[k*O+OS[j*I+i]]+beta[(k+1)*S+NS[j*I+i]];
-		minm=(*p2mymin)(minm,mm);
-	      }
-	      post[k*I+i]=minm;
-	      if(minm<norm) norm=minm;
-	    }
-	    for(int i=0;i<I;i++)
-	      post[k*I+i]-=norm; // normalize metrics
-	  }
-	}
-      else if(POSTO)
-	{
-	  for(int k=0;k<K;k++) { // output combining
-	    norm=INF;
-	    for(int n=0;n<O;n++) {
-	      minm=INF;
-	      for(int j=0;j<S;j++) {
-		for(int i=0;i<I;i++) {
-                  mm= (n==OS[j*I+i] ? alpha[k*S+j]+priori[k*I+i]+beta[(k+1)*S+NS[j*I+i]] : INF);
-                  minm=(*p2mymin)(minm,mm);
-		}
-	      }
-	      post[k*O+n]=minm;
-	      if(minm<norm) norm=minm;
-	    }
-	    for(int n=0;n<O;n++)
-	      post[k*O+n]-=norm; // normalize metrics
-	  }
-	}
-      else
-	throw std::runtime_error("Not both POSTI and POSTO can be false.");
+      trellis_engine(I, S, O, NS, OS, PS, PI).siso(K, S0, SK, POSTI, POSTO, p2mymin,
+							 priori, prioro, post);
     }
 
     //===========================================================
@@ -534,133 +309,9 @@ namespace gr {
 			    digital::trellis_metric_type_t TYPE,
 			    const float *priori, const T *observations, float *post)
     {
-      float norm,mm,minm;
-      std::vector<float> alpha(S*(K+1));
-      std::vector<float> beta(S*(K+1));
-      float *prioro = new float[O*K];
-
-      if(S0<0) { // initial state not specified
-	for(int i=0;i<S;i++) alpha[0*S+i]=0;
-      }
-      else {
-	for(int i=0;i<S;i++) alpha[0*S+i]=INF;
-	alpha[0*S+S0]=0.0;
-      }
-
-      for(int k=0;k<K;k++) { // forward recursion
-	calc_metric(O, D, TABLE, &(observations[k*D]), &(prioro[k*O]),TYPE); // calc metrics
-	norm=INF;
-	for(int j=0;j<S;j++) {
-          minm=INF;
-          for(unsigned int i=0;i<PS[j].size();i++) {
-	    //int i0 = j*I+i;
-	    mm=alpha[k*S+PS[j][i]]+priori[k*I+PI[j][i]]+prioro[k*O+OS[PS[j][i]*I+PI[j][i]]];
-	    minm=(*p2mymin)(minm,mm);
-          }
-          alpha[(k+1)*S+j]=minm;
-          if(minm<norm) norm=minm;
-	}
-	for(int j=0;j<S;j++)
-          alpha[(k+1)*S+j]-=norm; // normalize total metrics so they do not explode
-      }
-
-      if(SK<0) { // final state not specified
-	for(int i=0;i<S;i++) beta[K*S+i]=0;
-      }
-      else {
-	for(int i=0;i<S;i++) beta[K*S+i]=INF;
-	beta[K*S+SK]=0.0;
-      }
-
-      for(int k=K-1;k>=0;k--) { // backward recursion
-	norm=INF;
-	for(int j=0;j<S;j++) {
-          minm=INF;
-          for(int i=0;i<I;i++) {
-	    int i0 = j*I+i;
-	    mm=beta[(k+1)*S+NS[i0]]+priori[k*I+i]+prioro[k*O+OS[i0]];
-	    minm=(*p2mymin)(minm,mm);
-          }
-          beta[k*S+j]=minm;
-          if(minm<norm) norm=minm;
-	}
-	for(int j=0;j<S;j++)
-          beta[k*S+j]-=norm; // normalize total metrics so they do not explode
-      }
-
-      if(POSTI && POSTO)
-	{
-	  for(int k=0;k<K;k++) { // input combining
-	    norm=INF;
-	    for(int i=0;i<I;i++) {
-	      minm=INF;
-	      for(int j=0;j<S;j++) {
-                mm=alpha[k*S+j]+prioro[k*O+OS[j*I+i]]+beta[(k+1)*S+NS[j*I+i]];
-                minm=(*p2mymin)(minm,mm);
-	      }
-	      post[k*(I+O)+i]=minm;
-	      if(minm<norm) norm=minm;
-	    }
-	    for(int i=0;i<I;i++)
-	      post[k*(I+O)+i]-=norm; // normalize metrics
-	  }
-
-	  for(int k=0;k<K;k++) { // output combining
-	    norm=INF;
-	    for(int n=0;n<O;n++) {
-	      minm=INF;
-	      for(int j=0;j<S;j++) {
-                for(int i=0;i<I;i++) {
-		  mm= (n==OS[j*I+i] ? alpha[k*S+j]+priori[k*I+i]+beta[(k+1)*S+NS[j*I+i]] : INF);
-		  minm=(*p2mymin)(minm,mm);
-                }
-	      }
-	      post[k*(I+O)+I+n]=minm;
-	      if(minm<norm) norm=minm;
-	    }
-	    for(int n=0;n<O;n++)
-	      post[k*(I+O)+I+n]-=norm; // normalize metrics
-	  }
-	}
-      else if(POSTI)
-	{
-	  for(int k=0;k<K;k++) { // input combining
-	    norm=INF;
-	    for(int i=0;i<I;i++) {
-	      minm=INF;
-	      for(int j=0;j<S;j++) {
-                mm=alpha[k*S+j]+prioro[k*O+OS[j*I+i]]+beta[(k+1)*S+NS[j*I+i]];
-                minm=(*p2mymin)(minm,mm);
-	      }
-	      post[k*I+i]=minm;
-	      if(minm<norm) norm=minm;
-	    }
-	    for(int i=0;i<I;i++)
-	      post[k*I+i]-=norm; // normalize metrics
-	  }
-	}
-      else if(POSTO) {
-	for(int k=0;k<K;k++) { // output combining
-	  norm=INF;
-	  for(int n=0;n<O;n++) {
-	    minm=INF;
-            for(int j=0;j<S;j++) {
-	      for(int i=0;i<I;i++) {
-		mm= (n==OS[j*I+i] ? alpha[k*S+j]+priori[k*I+i]+beta[(k+1)*S+NS[j*I+i]] : INF);
-		minm=(*p2mymin)(minm,mm);
-	      }
-            }
-            post[k*O+n]=minm;
-            if(minm<norm) norm=minm;
-	  }
-	  for(int n=0;n<O;n++)
-	    post[k*O+n]-=norm; // normalize metrics
-	}
-      }
-      else
-	throw std::runtime_error ("Not both POSTI and POSTO can be false.");
-
-      delete [] prioro;
+      trellis_engine(I, S, O, NS, OS, PS, PI).siso_combined(K, S0, SK, POSTI, POSTO, p2mymin,
+								  D, TABLE, TYPE,
+								  priori, observations, post);
     }
 
     //---------
@@ -754,15 +405,15 @@ namespace gr {
 	iprioro[k*FSMi.O()] *= scaling;
       }
 
+      trellis_engine engine_i(FSMi), engine_o(FSMo);
+
       for(int rep=0;rep<iterations;rep++) {
 	// run inner SISO
-	siso_algorithm(FSMi.I(),FSMi.S(),FSMi.O(),
-		       FSMi.NS(), FSMi.OS(), FSMi.PS(), FSMi.PI(),
-		       blocklength,
-		       STi0,STiK,
-		       true, false,
-		       p2mymin,
-		       &(ipriori[0]), &(iprioro[0]), &(iposti[0]));
+	engine_i.siso(blocklength,
+		      STi0,STiK,
+		      true, false,
+		      p2mymin,
+		      &(ipriori[0]), &(iprioro[0]), &(iposti[0]));
 
 	//interleave soft info inner -> outer
 	for(int k=0;k<blocklength;k++) {
@@ -776,13 +427,11 @@ namespace gr {
 	// run outer SISO
 
 	if(rep<iterations-1) { // do not produce posti
-	  siso_algorithm(FSMo.I(),FSMo.S(),FSMo.O(),
-			 FSMo.NS(), FSMo.OS(), FSMo.PS(), FSMo.PI(),
-			 blocklength,
-			 STo0,SToK,
-			 false, true,
-			 p2mymin,
-			 &(opriori[0]),  &(oprioro[0]), &(oposto[0]));
+	  engine_o.siso(blocklength,
+			STo0,SToK,
+			false, true,
+			p2mymin,
+			&(opriori[0]),  &(oprioro[0]), &(oposto[0]));
 
 	  //interleave soft info outer --> inner
 	  for(int k=0;k<blocklength;k++) {
@@ -795,13 +444,11 @@ namespace gr {
 	}
 	else // produce posti but not posto
 
-	  siso_algorithm(FSMo.I(),FSMo.S(),FSMo.O(),
-			 FSMo.NS(), FSMo.OS(), FSMo.PS(), FSMo.PI(),
-			 blocklength,
-			 STo0,SToK,
-			 true, false,
-			 p2mymin,
-			 &(opriori[0]),  &(oprioro[0]), &(oposti[0]));
+	  engine_o.siso(blocklength,
+			STo0,SToK,
+			true, false,
+			p2mymin,
+			&(opriori[0]),  &(oprioro[0]), &(oposti[0]));
 
 	/*
 	  viterbi_algorithm(FSMo.I(),FSMo.S(),FSMo.O(),
@@ -915,15 +562,15 @@ namespace gr {
       std::vector<float> oposti(blocklength*FSMo.I());
       std::vector<float> oposto(blocklength*FSMo.O());
 
+      trellis_engine engine_i(FSMi), engine_o(FSMo);
+
       for(int rep=0;rep<iterations;rep++) {
 	// run inner SISO
-	siso_algorithm(FSMi.I(),FSMi.S(),FSMi.O(),
-		       FSMi.NS(), FSMi.OS(), FSMi.PS(), FSMi.PI(),
-		       blocklength,
-		       STi0,STiK,
-		       true, false,
-		       p2mymin,
-		       &(ipriori[0]),  &(iprioro[0]), &(iposti[0]));
+	engine_i.siso(blocklength,
+		      STi0,STiK,
+		      true, false,
+		      p2mymin,
+		      &(ipriori[0]),  &(iprioro[0]), &(iposti[0]));
 
 	//interleave soft info inner -> outer
 	for(int k=0;k<blocklength;k++) {
@@ -937,13 +584,11 @@ namespace gr {
 	// run outer SISO
 
 	if(rep<iterations-1) { // do not produce posti
-	  siso_algorithm(FSMo.I(),FSMo.S(),FSMo.O(),
-			 FSMo.NS(), FSMo.OS(), FSMo.PS(), FSMo.PI(),
-			 blocklength,
-			 STo0,SToK,
-			 false, true,
-			 p2mymin,
-			 &(opriori[0]),  &(oprioro[0]), &(oposto[0]));
+	  engine_o.siso(blocklength,
+			STo0,SToK,
+			false, true,
+			p2mymin,
+			&(opriori[0]),  &(oprioro[0]), &(oposto[0]));
 
 	  //interleave soft info outer --> inner
 	  for(int k=0;k<blocklength;k++) {
@@ -955,13 +600,11 @@ namespace gr {
 	  }
 	}
 	else {// produce posti but not posto
-	  siso_algorithm(FSMo.I(),FSMo.S(),FSMo.O(),
-			 FSMo.NS(), FSMo.OS(), FSMo.PS(), FSMo.PI(),
-			 blocklength,
-			 STo0,SToK,
-			 true, false,
-			 p2mymin,
-			 &(opriori[0]),  &(oprioro[0]), &(oposti[0]));
+	  engine_o.siso(blocklength,
+			STo0,SToK,
+			true, false,
+			p2mymin,
+			&(opriori[0]),  &(oprioro[0]), &(oposti[0]));
 
 	  /*
 	    viterbi_algorithm(FSMo.I(),FSMo.S(),FSMo.O(),
@@ -1052,15 +695,15 @@ namespace gr {
 	}
       }
 
+      trellis_engine engine_1(FSM1), engine_2(FSM2);
+
       for(int rep=0;rep<iterations;rep++) {
 	// run  SISO 1
-	siso_algorithm(FSM1.I(),FSM1.S(),FSM1.O(),
-		       FSM1.NS(), FSM1.OS(), FSM1.PS(), FSM1.PI(),
-		       blocklength,
-		       ST10,ST1K,
-		       true, false,
-		       p2mymin,
-		       &(priori1[0]),  &(prioro1[0]), &(posti1[0]));
+	engine_1.siso(blocklength,
+		      ST10,ST1K,
+		      true, false,
+		      p2mymin,
+		      &(priori1[0]),  &(prioro1[0]), &(posti1[0]));
 
 	//for(int k=0;k<blocklength;k++){
 	//for(int i=0;i<FSM1.I();i++)
@@ -1078,13 +721,11 @@ namespace gr {
 	}
 
 	// run SISO 2
-	siso_algorithm(FSM2.I(),FSM2.S(),FSM2.O(),
-		       FSM2.NS(), FSM2.OS(), FSM2.PS(), FSM2.PI(),
-		       blocklength,
-		       ST20,ST2K,
-		       true, false,
-		       p2mymin,
-		       &(priori2[0]),  &(prioro2[0]), &(posti2[0]));
+	engine_2.siso(blocklength,
+		      ST20,ST2K,
+		      true, false,
+		      p2mymin,
+		      &(priori2[0]),  &(prioro2[0]), &(posti2[0]));
 
 	//interleave soft info 2 --> 1
 	for(int k=0;k<blocklength;k++) {
@@ -1192,15 +833,15 @@ namespace gr {
 	}
       }
 
+      trellis_engine engine_1(FSM1), engine_2(FSM2);
+
       for(int rep=0;rep<iterations;rep++) {
 	// run  SISO 1
-	siso_algorithm(FSM1.I(),FSM1.S(),FSM1.O(),
-		       FSM1.NS(), FSM1.OS(), FSM1.PS(), FSM1.PI(),
-		       blocklength,
-		       ST10,ST1K,
-		       true, false,
-		       p2mymin,
-		       &(priori1[0]),  &(prioro1[0]), &(posti1[0]));
+	engine_1.siso(blocklength,
+		      ST10,ST1K,
+		      true, false,
+		      p2mymin,
+		      &(priori1[0]),  &(prioro1[0]), &(posti1[0]));
 
 	//for(int k=0;k<blocklength;k++){
 	//for(int i=0;i<FSM1.I();i++)
@@ -1218,13 +859,11 @@ namespace gr {
 	}
 
 	// run SISO 2
-	siso_algorithm(FSM2.I(),FSM2.S(),FSM2.O(),
-		       FSM2.NS(), FSM2.OS(), FSM2.PS(), FSM2.PI(),
-		       blocklength,
-		       ST20,ST2K,
-		       true, false,
-		       p2mymin,
-		       &(priori2[0]),  &(prioro2[0]), &(posti2[0]));
+	engine_2.siso(blocklength,
+		      ST20,ST2K,
+		      true, false,
+		      p2mymin,
+		      &(priori2[0]),  &(prioro2[0]), &(posti2[0]));
 
 	//interleave soft info 2 --> 1
 	for(int k=0;k<blocklength;k++) {
@@ -0,0 +1,342 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "qa_trellis_engine.h"
+#include <gnuradio/trellis/core_algorithms.h>
+#include <gnuradio/trellis/fsm.h>
+#include <gnuradio/random.h>
+#include <cppunit/TestAssert.h>
+#include <stdexcept>
+#include <vector>
+
+namespace gr {
+  namespace trellis {
+
+    static const float INF = 1.0e9;
+
+    static float
+    frand()
+    {
+      return (float)(::random()) / RANDOM_MAX; // uniformly [0, 1]
+    }
+
+    //
+    // The Viterbi and SISO algorithms as they were before
+    // trellis_engine, as the reference.
+    //
+    static void
+    ref_viterbi(int I, int S, int O,
+		const std::vector<int> &NS,
+		const std::vector<int> &OS,
+		const std::vector< std::vector<int> > &PS,
+		const std::vector< std::vector<int> > &PI,
+		int K, int S0, int SK,
+		const float *in, int *out)
+    {
+      std::vector<int> trace(S*K);
+      std::vector<float> alpha(S*2);
+      int alphai;
+      float norm,mm,minm;
+      int minmi;
+      int st;
+
+      if(S0<0) { // initial state not specified
+	for(int i=0;i<S;i++) alpha[0*S+i]=0;
+      }
+      else {
+	for(int i=0;i<S;i++) alpha[0*S+i]=INF;
+	alpha[0*S+S0]=0.0;
+      }
+
+      alphai=0;
+      for(int k=0;k<K;k++) {
+	norm=INF;
+	for(int j=0;j<S;j++) { // for each next state do ACS
+	  minm=INF;
+	  minmi=0;
+	  for(unsigned int i=0;i<PS[j].size();i++) {
+	    if((mm=alpha[alphai*S+PS[j][i]]+in[k*O+OS[PS[j][i]*I+PI[j][i]]])<minm)
+	      minm=mm,minmi=i;
+	  }
+	  trace[k*S+j]=minmi;
+	  alpha[((alphai+1)%2)*S+j]=minm;
+	  if(minm<norm) norm=minm;
+	}
+	for(int j=0;j<S;j++)
+	  alpha[((alphai+1)%2)*S+j]-=norm; // normalize total metrics so they do not explode
+	alphai=(alphai+1)%2;
+      }
+
+      if(SK<0) { // final state not specified
+	minm=INF;
+	minmi=0;
+	for(int i=0;i<S;i++)
+	  if((mm=alpha[alphai*S+i])<minm) minm=mm,minmi=i;
+	st=minmi;
+      }
+      else {
+	st=SK;
+      }
+
+      for(int k=K-1;k>=0;k--) { // traceback
+	int i0=trace[k*S+st];
+	out[k]=PI[st][i0];
+	st=PS[st][i0];
+      }
+    }
+
+    static void
+    ref_siso(int I, int S, int O,
+	     const std::vector<int> &NS,
+	     const std::vector<int> &OS,
+	     const std::vector< std::vector<int> > &PS,
+	     const std::vector< std::vector<int> > &PI,
+	     int K, int S0, int SK,
+	     bool POSTI, bool POSTO,
+	     float (*p2mymin)(float,float),
+	     const float *priori, const float *prioro, float *post)
+    {
+      float norm,mm,minm;
+      std::vector<float> alpha(S*(K+1));
+      std::vector<float> beta(S*(K+1));
+
+      if(S0<0) { // initial state not specified
+	for(int i=0;i<S;i++) alpha[0*S+i]=0;
+      }
+      else {
+	for(int i=0;i<S;i++) alpha[0*S+i]=INF;
+	alpha[0*S+S0]=0.0;
+      }
+
+      for(int k=0;k<K;k++) { // forward recursion
+	norm=INF;
+	for(int j=0;j<S;j++) {
+	  minm=INF;
+	  for(unsigned int i=0;i<PS[j].size();i++) {
+	    mm=alpha[k*S+PS[j][i]]+priori[k*I+PI[j][i]]+prioro[k*O+OS[PS[j][i]*I+PI[j][i]]];
+	    minm=(*p2mymin)(minm,mm);
+	  }
+	  alpha[(k+1)*S+j]=minm;
+	  if(minm<norm) norm=minm;
+	}
+	for(int j=0;j<S;j++)
+	  alpha[(k+1)*S+j]-=norm; // normalize total metrics so they do not explode
+      }
+
+      if(SK<0) { // final state not specified
+	for(int i=0;i<S;i++) beta[K*S+i]=0;
+      }
+      else {
+	for(int i=0;i<S;i++) beta[K*S+i]=INF;
+	beta[K*S+SK]=0.0;
+      }
+
+      for(int k=K-1;k>=0;k--) { // backward recursion
+	norm=INF;
+	for(int j=0;j<S;j++) {
+	  minm=INF;
+	  for(int i=0;i<I;i++) {
+	    int i0 = j*I+i;
+	    mm=beta[(k+1)*S+NS[i0]]+priori[k*I+i]+prioro[k*O+OS[i0]];
+	    minm=(*p2mymin)(minm,mm);
+	  }
+	  beta[k*S+j]=minm;
+	  if(minm<norm) norm=minm;
+	}
+	for(int j=0;j<S;j++)
+	  beta[k*S+j]-=norm; // normalize total metrics so they do not explode
+      }
+
+      if(!POSTI && !POSTO)
+	throw std::runtime_error("Not both POSTI and POSTO can be false.");
+
+      // The posteriors of the inputs come first, then those of the
+      // outputs, each normalized on its own.
+      int stride = (POSTI ? I : 0) + (POSTO ? O : 0);
+
+      if(POSTI) {
+	for(int k=0;k<K;k++) { // input combining
+	  norm=INF;
+	  for(int i=0;i<I;i++) {
+	    minm=INF;
+	    for(int j=0;j<S;j++) {
+	      mm=alpha[k*S+j]+prioro[k*O+OS[j*I+i]]+beta[(k+1)*S+NS[j*I+i]];
+	      minm=(*p2mymin)(minm,mm);
+	    }
+	    post[k*stride+i]=minm;
+	    if(minm<norm) norm=minm;
+	  }
+	  for(int i=0;i<I;i++)
+	    post[k*stride+i]-=norm; // normalize metrics
+	}
+      }
+
+      if(POSTO) {
+	int base = POSTI ? I : 0;
+	for(int k=0;k<K;k++) { // output combining
+	  norm=INF;
+	  for(int n=0;n<O;n++) {
+	    minm=INF;
+	    for(int j=0;j<S;j++) {
+	      for(int i=0;i<I;i++) {
+		mm= (n==OS[j*I+i] ? alpha[k*S+j]+priori[k*I+i]+beta[(k+1)*S+NS[j*I+i]] : INF);
+		minm=(*p2mymin)(minm,mm);
+	      }
+	    }
+	    post[k*stride+base+n]=minm;
+	    if(minm<norm) norm=minm;
+	  }
+	  for(int n=0;n<O;n++)
+	    post[k*stride+base+n]-=norm; // normalize metrics
+	}
+      }
+    }
+
+    //
+    // Three codes, then random fsms in which input 0 moves every
+    // state on to the next, so that all are reachable, and the other
+    // inputs go anywhere. Their states end up with different numbers
+    // of predecessors.
+    //
+    static std::vector<fsm>
+    make_fsms()
+    {
+      std::vector<fsm> fsms;
+      int G1[] = {7, 5};
+      int G2[] = {0133, 0171};
+      int G3[] = {1, 2, 3, 1, 0, 2};
+      fsms.push_back(fsm(1, 2, std::vector<int>(G1, G1+2)));
+      fsms.push_back(fsm(1, 2, std::vector<int>(G2, G2+2)));
+      fsms.push_back(fsm(2, 3, std::vector<int>(G3, G3+6)));
+
+      for(int t = 0; t < 6; t++) {
+	int I = 2 + ::random() % 3;
+	int S = 3 + ::random() % 20;
+	int O = 2 + ::random() % 6;
+	std::vector<int> NS(I*S), OS(I*S);
+	for(int j = 0; j < S; j++) {
+	  for(int i = 0; i < I; i++) {
+	    NS[j*I+i] = i == 0 ? (j+1) % S : ::random() % S;
+	    OS[j*I+i] = ::random() % O;
+	  }
+	}
+	fsms.push_back(fsm(I, S, O, NS, OS));
+      }
+
+      bool irregular = false;
+      for(size_t n = 0; n < fsms.size(); n++)
+	for(int j = 1; j < fsms[n].S(); j++)
+	  if(fsms[n].PS()[j].size() != fsms[n].PS()[0].size())
+	    irregular = true;
+      CPPUNIT_ASSERT(irregular);
+
+      return fsms;
+    }
+
+    void
+    qa_trellis_engine::t_viterbi()
+    {
+      srandom(0);	// we want reproducibility
+      std::vector<fsm> fsms = make_fsms();
+
+      for(size_t n = 0; n < fsms.size(); n++) {
+	const fsm &F = fsms[n];
+	int I = F.I(), S = F.S(), O = F.O();
+
+	// Free and fixed end states; the last trial has metrics big
+	// enough for the dummy branches' INF to matter.
+	for(int trial = 0; trial < 4; trial++) {
+	  int K = 1 + ::random() % 300;
+	  int S0 = (trial & 1) ? ::random() % S : -1;
+	  int SK = (trial & 2) ? ::random() % S : -1;
+
+	  std::vector<float> in(K*O);
+	  for(size_t i = 0; i < in.size(); i++)
+	    in[i] = (trial == 3 ? 1e3f : 4.0f) * frand();
+
+	  std::vector<int> expected(K), actual(K);
+	  ref_viterbi(I, S, O, F.NS(), F.OS(), F.PS(), F.PI(), K, S0, SK, &in[0], &expected[0]);
+	  viterbi_algorithm(I, S, O, F.NS(), F.OS(), F.PS(), F.PI(), K, S0, SK, &in[0], &actual[0]);
+
+	  for(int k = 0; k < K; k++)
+	    CPPUNIT_ASSERT_EQUAL(expected[k], actual[k]);
+	}
+      }
+    }
+
+    static void
+    test_siso(float (*p2mymin)(float,float))
+    {
+      srandom(0);	// we want reproducibility
+      std::vector<fsm> fsms = make_fsms();
+
+      for(size_t n = 0; n < fsms.size(); n++) {
+	const fsm &F = fsms[n];
+	int I = F.I(), S = F.S(), O = F.O();
+
+	for(int trial = 0; trial < 4; trial++) {
+	  int K = 1 + ::random() % 200;
+	  int S0 = (trial & 1) ? ::random() % S : -1;
+	  int SK = (trial & 2) ? ::random() % S : -1;
+
+	  std::vector<float> priori(K*I), prioro(K*O);
+	  for(size_t i = 0; i < priori.size(); i++)
+	    priori[i] = 2.0f * frand() - (trial == 2 ? 1.0f : 0.0f);
+	  for(size_t i = 0; i < prioro.size(); i++)
+	    prioro[i] = 4.0f * frand();
+
+	  for(int posts = 1; posts <= 3; posts++) {
+	    bool POSTI = posts & 1, POSTO = posts & 2;
+	    int len = K * ((POSTI ? I : 0) + (POSTO ? O : 0));
+
+	    std::vector<float> expected(len), actual(len);
+	    ref_siso(I, S, O, F.NS(), F.OS(), F.PS(), F.PI(), K, S0, SK,
+		     POSTI, POSTO, p2mymin, &priori[0], &prioro[0], &expected[0]);
+	    siso_algorithm(I, S, O, F.NS(), F.OS(), F.PS(), F.PI(), K, S0, SK,
+			   POSTI, POSTO, p2mymin, &priori[0], &prioro[0], &actual[0]);
+
+	    // Bit for bit
+	    for(int i = 0; i < len; i++)
+	      CPPUNIT_ASSERT_EQUAL(expected[i], actual[i]);
+	  }
+	}
+      }
+    }
+
+    void
+    qa_trellis_engine::t_siso_min()
+    {
+      test_siso(&min);
+    }
+
+    void
+    qa_trellis_engine::t_siso_min_star()
+    {
+      test_siso(&min_star);
+    }
+
+  } /* namespace trellis */
+} /* namespace gr */
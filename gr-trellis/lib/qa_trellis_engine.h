@@ -0,0 +1,56 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _QA_TRELLIS_ENGINE_H_
+#define _QA_TRELLIS_ENGINE_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCase.h>
+
+namespace gr {
+  namespace trellis {
+
+    /*!
+     * Checks that the Viterbi and SISO algorithms, which run on
+     * trellis_engine, give exactly what the plain loops they replaced
+     * gave. Besides a few codes, the fsms are random ones where
+     * states have different numbers of predecessors, so that the
+     * engine pads with dummy branches.
+     */
+    class qa_trellis_engine : public CppUnit::TestCase
+    {
+      CPPUNIT_TEST_SUITE(qa_trellis_engine);
+      CPPUNIT_TEST(t_viterbi);
+      CPPUNIT_TEST(t_siso_min);
+      CPPUNIT_TEST(t_siso_min_star);
+      CPPUNIT_TEST_SUITE_END();
+
+    private:
+      void t_viterbi();
+      void t_siso_min();
+      void t_siso_min_star();
+    };
+
+  } /* namespace trellis */
+} /* namespace gr */
+
+#endif /* _QA_TRELLIS_ENGINE_H_ */
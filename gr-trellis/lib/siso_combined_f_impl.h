@@ -24,6 +24,7 @@
 #define INCLUDED_TRELLIS_SISO_COMBINED_F_IMPL_H
 
 #include <gnuradio/trellis/siso_combined_f.h>
+#include "trellis_engine.h"
 
 namespace gr {
   namespace trellis {
@@ -41,6 +42,7 @@ namespace gr {
       int d_D;
       std::vector<float> d_TABLE;
       digital::trellis_metric_type_t d_TYPE;
+      trellis_engine d_engine;
       //std::vector<float> d_alpha;
       //std::vector<float> d_beta;
 
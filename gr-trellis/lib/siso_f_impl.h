@@ -28,6 +28,7 @@
 #include <gnuradio/trellis/siso_type.h>
 #include <gnuradio/trellis/core_algorithms.h>
 #include <gnuradio/trellis/siso_f.h>
+#include "trellis_engine.h"
 
 namespace gr {
   namespace trellis {
@@ -42,6 +43,7 @@ namespace gr {
       bool d_POSTI;
       bool d_POSTO;
       siso_type_t d_SISO_TYPE;
+      trellis_engine d_engine;
       //std::vector<float> d_alpha;
       //std::vector<float> d_beta;
 
@@ -0,0 +1,292 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "trellis_engine.h"
+#include <gnuradio/trellis/core_algorithms.h>
+#include <volk/volk.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace gr {
+  namespace trellis {
+
+    static const float INF = 1.0e9;
+
+    trellis_engine::trellis_engine(const fsm &FSM)
+    {
+      build(FSM.I(), FSM.S(), FSM.O(),
+	    FSM.NS(), FSM.OS(), FSM.PS(), FSM.PI());
+    }
+
+    trellis_engine::trellis_engine(int I, int S, int O,
+				   const std::vector<int> &NS,
+				   const std::vector<int> &OS,
+				   const std::vector< std::vector<int> > &PS,
+				   const std::vector< std::vector<int> > &PI)
+    {
+      build(I, S, O, NS, OS, PS, PI);
+    }
+
+    void
+    trellis_engine::build(int I, int S, int O,
+			  const std::vector<int> &NS,
+			  const std::vector<int> &OS,
+			  const std::vector< std::vector<int> > &PS,
+			  const std::vector< std::vector<int> > &PI)
+    {
+      d_I = I;
+      d_S = S;
+      d_O = O;
+      d_NS = NS;
+      d_OS = OS;
+
+      d_ns.resize(I*S);
+      d_os.resize(I*S);
+      for(int j = 0; j < S; j++) {
+	for(int i = 0; i < I; i++) {
+	  d_ns[i*S+j] = NS[j*I+i];
+	  d_os[i*S+j] = OS[j*I+i];
+	}
+      }
+
+      d_P = 0;
+      for(int j = 0; j < S; j++)
+	d_P = std::max(d_P, (int)PS[j].size());
+
+      // Dummy branches point at the INF past the end of the state
+      // metrics and at a zero past the end of the symbol metrics.
+      d_ps.assign(d_P*S, S);
+      d_pi.assign(d_P*S, I);
+      d_po.assign(d_P*S, O);
+      for(int j = 0; j < S; j++) {
+	for(unsigned int b = 0; b < PS[j].size(); b++) {
+	  d_ps[b*S+j] = PS[j][b];
+	  d_pi[b*S+j] = PI[j][b];
+	  d_po[b*S+j] = OS[PS[j][b]*I+PI[j][b]];
+	}
+      }
+
+      d_pri.assign(I+1, 0);
+      d_pro.assign(O+1, 0);
+      d_post.resize(O);
+    }
+
+    int
+    trellis_engine::viterbi_acs(int K, int S0, int SK, const float *in)
+    {
+      const int S = d_S;
+      const int W = S+1;	// a row of state metrics and its INF
+      const int nb = d_P*S;
+
+      d_alpha.resize(2*W);
+      d_trace.resize(K*S);
+
+      // Row 0 of the candidates stays INF, so a state takes no
+      // branch unless it beats INF, as in the scalar ACS; the
+      // decision is the branch number plus one.
+      d_cand.resize((d_P+1)*S);
+      for(int j = 0; j < S; j++)
+	d_cand[j] = INF;
+
+      float *alpha = &d_alpha[0];
+      float *next = &d_alpha[W];
+      float *cand = &d_cand[S];
+      float *metric = &d_pro[0];
+
+      if(S0 < 0) { // initial state not specified
+	for(int j = 0; j < S; j++) alpha[j] = 0;
+      }
+      else {
+	for(int j = 0; j < S; j++) alpha[j] = INF;
+	alpha[S0] = 0.0;
+      }
+      alpha[S] = next[S] = INF;
+
+      for(int k = 0; k < K; k++) {
+	memcpy(metric, &(in[k*d_O]), d_O*sizeof(float));
+	for(int e = 0; e < nb; e++)
+	  cand[e] = alpha[d_ps[e]] + metric[d_po[e]];
+
+	volk_32f_rows_index_min_32f_32u(next, &(d_trace[k*S]), &(d_cand[0]), d_P+1, S);
+
+	float norm = INF;
+	for(int j = 0; j < S; j++)
+	  if(next[j] < norm) norm = next[j];
+	for(int j = 0; j < S; j++)
+	  next[j] -= norm; // normalize total metrics so they do not explode
+
+	std::swap(alpha, next);
+      }
+
+      if(SK >= 0)
+	return SK;
+
+      // final state not specified
+      float minm = INF;
+      int minmi = 0;
+      for(int j = 0; j < S; j++)
+	if(alpha[j] < minm) minm = alpha[j], minmi = j;
+      return minmi;
+    }
+
+    void
+    trellis_engine::siso(int K, int S0, int SK,
+			 bool POSTI, bool POSTO,
+			 float (*p2mymin)(float,float),
+			 const float *priori, const float *prioro, float *post)
+    {
+      const int I = d_I, S = d_S, O = d_O;
+      const int W = S+1;	// a row of alpha and its INF
+      const bool use_min = (p2mymin == &min);
+      float norm;
+
+      if(!POSTI && !POSTO)
+	throw std::runtime_error("Not both POSTI and POSTO can be false.");
+
+      d_alpha.resize(W*(K+1));
+      d_beta.resize(S*(K+1));
+      d_cand.resize(S);
+
+      float *alpha = &d_alpha[0];
+      float *beta = &d_beta[0];
+      float *cand = &d_cand[0];
+
+      if(S0 < 0) { // initial state not specified
+	for(int j = 0; j < S; j++) alpha[j] = 0;
+      }
+      else {
+	for(int j = 0; j < S; j++) alpha[j] = INF;
+	alpha[S0] = 0.0;
+      }
+
+      for(int k = 0; k < K; k++) { // forward recursion
+	const float *a = &alpha[k*W];
+	float *na = &alpha[(k+1)*W];
+
+	alpha[k*W+S] = INF;
+	memcpy(&d_pri[0], &(priori[k*I]), I*sizeof(float));
+	memcpy(&d_pro[0], &(prioro[k*O]), O*sizeof(float));
+
+	for(int j = 0; j < S; j++)
+	  na[j] = INF;
+	for(int b = 0; b < d_P; b++) {
+	  const int *ps = &d_ps[b*S], *pi = &d_pi[b*S], *po = &d_po[b*S];
+	  for(int j = 0; j < S; j++)
+	    cand[j] = a[ps[j]] + d_pri[pi[j]] + d_pro[po[j]];
+	  if(use_min)
+	    volk_32f_x2_min_32f(na, na, cand, S);
+	  else
+	    for(int j = 0; j < S; j++)
+	      na[j] = (*p2mymin)(na[j], cand[j]);
+	}
+
+	norm = INF;
+	for(int j = 0; j < S; j++)
+	  if(na[j] < norm) norm = na[j];
+	for(int j = 0; j < S; j++)
+	  na[j] -= norm; // normalize total metrics so they do not explode
+      }
+
+      if(SK < 0) { // final state not specified
+	for(int j = 0; j < S; j++) beta[K*S+j] = 0;
+      }
+      else {
+	for(int j = 0; j < S; j++) beta[K*S+j] = INF;
+	beta[K*S+SK] = 0.0;
+      }
+
+      for(int k = K-1; k >= 0; k--) { // backward recursion
+	const float *b = &beta[(k+1)*S];
+	float *nb = &beta[k*S];
+
+	for(int j = 0; j < S; j++)
+	  nb[j] = INF;
+	for(int i = 0; i < I; i++) {
+	  const int *ns = &d_ns[i*S], *os = &d_os[i*S];
+	  const float pri = priori[k*I+i];
+	  for(int j = 0; j < S; j++)
+	    cand[j] = b[ns[j]] + pri + prioro[k*O+os[j]];
+	  if(use_min)
+	    volk_32f_x2_min_32f(nb, nb, cand, S);
+	  else
+	    for(int j = 0; j < S; j++)
+	      nb[j] = (*p2mymin)(nb[j], cand[j]);
+	}
+
+	norm = INF;
+	for(int j = 0; j < S; j++)
+	  if(nb[j] < norm) norm = nb[j];
+	for(int j = 0; j < S; j++)
+	  nb[j] -= norm; // normalize total metrics so they do not explode
+      }
+
+      for(int k = 0; k < K; k++) {
+	const float *a = &alpha[k*W];
+	const float *b = &beta[(k+1)*S];
+	float minm, mm;
+
+	if(POSTI) { // input combining
+	  float *p = &post[POSTO ? k*(I+O) : k*I];
+	  norm = INF;
+	  for(int i = 0; i < I; i++) {
+	    const int *ns = &d_ns[i*S], *os = &d_os[i*S];
+	    minm = INF;
+	    for(int j = 0; j < S; j++) {
+	      mm = a[j] + prioro[k*O+os[j]] + b[ns[j]];
+	      minm = (*p2mymin)(minm, mm);
+	    }
+	    p[i] = minm;
+	    if(minm < norm) norm = minm;
+	  }
+	  for(int i = 0; i < I; i++)
+	    p[i] -= norm; // normalize metrics
+	}
+
+	if(POSTO) { // output combining
+	  // Each transition goes to the metric of its output symbol
+	  // only, in the order the transitions are numbered.
+	  float *p = &post[POSTI ? k*(I+O)+I : k*O];
+	  for(int n = 0; n < O; n++)
+	    d_post[n] = INF;
+	  for(int j = 0; j < S; j++) {
+	    for(int i = 0; i < I; i++) {
+	      int e = j*I+i;
+	      mm = a[j] + priori[k*I+i] + b[d_NS[e]];
+	      d_post[d_OS[e]] = (*p2mymin)(d_post[d_OS[e]], mm);
+	    }
+	  }
+	  norm = INF;
+	  for(int n = 0; n < O; n++)
+	    if(d_post[n] < norm) norm = d_post[n];
+	  for(int n = 0; n < O; n++)
+	    p[n] = d_post[n] - norm; // normalize metrics
+	}
+      }
+    }
+
+  } /* namespace trellis */
+} /* namespace gr */
@@ -0,0 +1,137 @@
+/* -*- c++ -*- */
+/*
+ * Copyright 2013 Free Software Foundation, Inc.
+ *
+ * This file is part of GNU Radio
+ *
+ * GNU Radio is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * GNU Radio is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with GNU Radio; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_TRELLIS_ENGINE_H
+#define INCLUDED_TRELLIS_ENGINE_H
+
+#include <vector>
+#include <gnuradio/trellis/fsm.h>
+#include <gnuradio/trellis/calc_metric.h>
+
+namespace gr {
+  namespace trellis {
+
+    /*!
+     * \brief Viterbi and SISO decoding on an fsm compiled into flat
+     * tables.
+     *
+     * Branch b into (or out of) state j is entry b*S+j of the
+     * tables, so one branch of every state is a contiguous row and
+     * the compare-select runs across the states with VOLK. States
+     * with fewer than the most predecessors get dummy branches
+     * whose metric is INF. The working memory grows to the longest
+     * block decoded and is kept between calls, so a block holding
+     * an engine allocates nothing per call.
+     *
+     * The results are the same as the ones of the functions in
+     * core_algorithms.h, which are implemented with this.
+     */
+    class trellis_engine
+    {
+    private:
+      int d_I;
+      int d_S;
+      int d_O;
+      int d_P;			// most predecessors of a state
+      std::vector<int> d_NS;	// as in fsm: entry j*I+i
+      std::vector<int> d_OS;
+      std::vector<int> d_ns;	// transposed: entry i*S+j
+      std::vector<int> d_os;
+      std::vector<int> d_ps;	// entry b*S+j; S, I and O for the
+      std::vector<int> d_pi;	// dummy branches
+      std::vector<int> d_po;
+
+      std::vector<float> d_alpha;
+      std::vector<float> d_beta;
+      std::vector<float> d_cand;
+      std::vector<float> d_pri;
+      std::vector<float> d_pro;
+      std::vector<float> d_post;
+      std::vector<float> d_metric;
+      std::vector<unsigned int> d_trace;
+
+      void build(int I, int S, int O,
+		 const std::vector<int> &NS,
+		 const std::vector<int> &OS,
+		 const std::vector< std::vector<int> > &PS,
+		 const std::vector< std::vector<int> > &PI);
+
+      // Forward pass of the Viterbi algorithm; returns the final state.
+      int viterbi_acs(int K, int S0, int SK, const float *in);
+
+    public:
+      trellis_engine(const fsm &FSM);
+      trellis_engine(int I, int S, int O,
+		     const std::vector<int> &NS,
+		     const std::vector<int> &OS,
+		     const std::vector< std::vector<int> > &PS,
+		     const std::vector< std::vector<int> > &PI);
+
+      template <class T>
+      void viterbi(int K, int S0, int SK, const float *in, T *out)
+      {
+	int st = viterbi_acs(K, S0, SK, in);
+
+	for(int k = K-1; k >= 0; k--) { // traceback
+	  unsigned int r = d_trace[k*d_S+st];
+	  int e = (r ? r-1 : 0)*d_S + st;
+	  out[k] = (T)d_pi[e];
+	  st = d_ps[e];
+	}
+      }
+
+      template <class Ti, class To>
+      void viterbi_combined(int K, int S0, int SK,
+			    int D, const std::vector<Ti> &TABLE,
+			    digital::trellis_metric_type_t TYPE,
+			    const Ti *in, To *out)
+      {
+	d_metric.resize(K*d_O);
+	for(int k = 0; k < K; k++)
+	  calc_metric(d_O, D, TABLE, &(in[k*D]), &(d_metric[k*d_O]), TYPE);
+	viterbi(K, S0, SK, &(d_metric[0]), out);
+      }
+
+      void siso(int K, int S0, int SK,
+		bool POSTI, bool POSTO,
+		float (*p2mymin)(float,float),
+		const float *priori, const float *prioro, float *post);
+
+      template <class T>
+      void siso_combined(int K, int S0, int SK,
+			 bool POSTI, bool POSTO,
+			 float (*p2mymin)(float,float),
+			 int D, const std::vector<T> &TABLE,
+			 digital::trellis_metric_type_t TYPE,
+			 const float *priori, const T *observations, float *post)
+      {
+	d_metric.resize(K*d_O);
+	for(int k = 0; k < K; k++)
+	  calc_metric(d_O, D, TABLE, &(observations[k*D]), &(d_metric[k*d_O]), TYPE);
+	siso(K, S0, SK, POSTI, POSTO, p2mymin, priori, &(d_metric[0]), post);
+      }
+    };
+
+  } /* namespace trellis */
+} /* namespace gr */
+
+#endif /* INCLUDED_TRELLIS_ENGINE_H */
@@ -26,6 +26,7 @@
 #define @GUARD_NAME@
 
 #include <gnuradio/trellis/@BASE_NAME@.h>
+#include "trellis_engine.h"
 
 namespace gr {
   namespace trellis {
@@ -37,6 +38,7 @@ namespace gr {
       int d_K;
       int d_S0;
       int d_SK;
+      trellis_engine d_engine;
       //std::vector<int> d_trace;
 
     public:
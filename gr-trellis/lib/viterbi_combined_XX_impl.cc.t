@@ -53,7 +53,7 @@ namespace gr {
 	       io_signature::make(1, -1, sizeof(@I_TYPE@)),
 	       io_signature::make(1, -1, sizeof(@O_TYPE@))),
       d_FSM(FSM), d_K(K), d_S0(S0), d_SK(SK), d_D(D),
-      d_TABLE(TABLE), d_TYPE(TYPE)//,
+      d_TABLE(TABLE), d_TYPE(TYPE), d_engine(FSM)//,
       //d_trace(FSM.S()*K)
     {
       set_relative_rate(1.0 / ((double)d_D));
@@ -95,11 +95,9 @@ namespace gr {
 	@O_TYPE@ *out = (@O_TYPE@*)output_items[m];
 
 	for(int n=0;n<nblocks;n++) {
-	  viterbi_algorithm_combined(d_FSM.I(), d_FSM.S(), d_FSM.O(),
-				     d_FSM.NS(), d_FSM.OS(), d_FSM.PS(),
-				     d_FSM.PI(), d_K,d_S0, d_SK, d_D,
-				     d_TABLE, d_TYPE,
-				     &(in[n*d_K*d_D]), &(out[n*d_K]));
+	  d_engine.viterbi_combined(d_K, d_S0, d_SK, d_D,
+				    d_TABLE, d_TYPE,
+				    &(in[n*d_K*d_D]), &(out[n*d_K]));
 	}
       }
 
@@ -26,6 +26,7 @@
 #define @GUARD_NAME@
 
 #include <gnuradio/trellis/@BASE_NAME@.h>
+#include "trellis_engine.h"
 
 namespace gr {
   namespace trellis {
@@ -40,6 +41,7 @@ namespace gr {
       int d_D;
       std::vector<@I_TYPE@> d_TABLE;
       digital::trellis_metric_type_t d_TYPE;
+      trellis_engine d_engine;
       //std::vector<int> d_trace;
 
     public:
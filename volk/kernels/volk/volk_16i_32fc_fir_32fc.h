@@ -0,0 +1,150 @@
+#ifndef INCLUDED_volk_16i_32fc_fir_32fc_u_H
+#define INCLUDED_volk_16i_32fc_fir_32fc_u_H
+
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+#include <stdio.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+/*!
+  \brief Runs a complex FIR filter over a block of short input, four outputs per pass over the taps
+  \param outputs The num_points outputs; outputs[j] is the dot product of input[j ... j+num_taps-1] and taps
+  \param input The num_points+num_taps-1 input samples
+  \param taps The filter taps, in the order they are applied to the input (ie, time reversed)
+  \param num_taps The number of taps
+  \param num_points The number of outputs to compute
+*/
+static inline void volk_16i_32fc_fir_32fc_generic(lv_32fc_t* outputs, const short* input, const lv_32fc_t* taps, unsigned int num_taps, unsigned int num_points){
+  unsigned int j = 0, i;
+
+  // Four outputs share every tap load.
+  for(; j + 4 <= num_points; j += 4){
+    const short* aPtr = input + j;
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+    float acc0r = 0, acc0i = 0, acc1r = 0, acc1i = 0;
+    float acc2r = 0, acc2i = 0, acc3r = 0, acc3i = 0;
+
+    for(i = 0; i < num_taps; i++){
+      const float tr = bPtr[0];
+      const float ti = bPtr[1];
+      acc0r += (float)aPtr[0] * tr;
+      acc0i += (float)aPtr[0] * ti;
+      acc1r += (float)aPtr[1] * tr;
+      acc1i += (float)aPtr[1] * ti;
+      acc2r += (float)aPtr[2] * tr;
+      acc2i += (float)aPtr[2] * ti;
+      acc3r += (float)aPtr[3] * tr;
+      acc3i += (float)aPtr[3] * ti;
+      aPtr++;
+      bPtr += 2;
+    }
+
+    oPtr[0] = acc0r;
+    oPtr[1] = acc0i;
+    oPtr[2] = acc1r;
+    oPtr[3] = acc1i;
+    oPtr[4] = acc2r;
+    oPtr[5] = acc2i;
+    oPtr[6] = acc3r;
+    oPtr[7] = acc3i;
+  }
+
+  for(; j < num_points; j++){
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+    float accr = 0, acci = 0;
+    for(i = 0; i < num_taps; i++){
+      accr += (float)input[j+i] * bPtr[2*i];
+      acci += (float)input[j+i] * bPtr[2*i+1];
+    }
+    oPtr[0] = accr;
+    oPtr[1] = acci;
+  }
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_16i_32fc_fir_32fc_u_sse2(lv_32fc_t* outputs, const short* input, const lv_32fc_t* taps, unsigned int num_taps, unsigned int num_points){
+  const unsigned int quarterTaps = num_taps / 4;
+  unsigned int j = 0, i, k;
+
+  for(; j + 4 <= num_points; j += 4){
+    const short* aPtr = input + j;
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+
+    __m128i sVal;
+    __m128 xVal, t0Val, t1Val;
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+
+    for(i = 0; i < quarterTaps; i++){
+      t0Val = _mm_loadu_ps(bPtr);   // taps 0 and 1
+      t1Val = _mm_loadu_ps(bPtr+4); // taps 2 and 3
+
+      // Output k starts k samples further on. Sign extend four
+      // shorts to floats, then spread each over the real and
+      // imaginary part of its tap.
+      sVal = _mm_loadl_epi64((const __m128i*)(aPtr));
+      xVal = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(sVal, sVal), 16));
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_unpacklo_ps(xVal, xVal), t0Val));
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_unpackhi_ps(xVal, xVal), t1Val));
+      sVal = _mm_loadl_epi64((const __m128i*)(aPtr+1));
+      xVal = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(sVal, sVal), 16));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_unpacklo_ps(xVal, xVal), t0Val));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_unpackhi_ps(xVal, xVal), t1Val));
+      sVal = _mm_loadl_epi64((const __m128i*)(aPtr+2));
+      xVal = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(sVal, sVal), 16));
+      acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_unpacklo_ps(xVal, xVal), t0Val));
+      acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_unpackhi_ps(xVal, xVal), t1Val));
+      sVal = _mm_loadl_epi64((const __m128i*)(aPtr+3));
+      xVal = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(sVal, sVal), 16));
+      acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_unpacklo_ps(xVal, xVal), t0Val));
+      acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_unpackhi_ps(xVal, xVal), t1Val));
+      aPtr += 4;
+      bPtr += 8;
+    }
+
+    // Each accumulator holds two partial sums of one output; fold
+    // them into (out0, out1) and (out2, out3).
+    acc0 = _mm_add_ps(_mm_movelh_ps(acc0, acc1), _mm_movehl_ps(acc1, acc0));
+    acc2 = _mm_add_ps(_mm_movelh_ps(acc2, acc3), _mm_movehl_ps(acc3, acc2));
+    _mm_storeu_ps(oPtr, acc0);
+    _mm_storeu_ps(oPtr+4, acc2);
+
+    for(i = quarterTaps * 4; i < num_taps; i++){
+      for(k = 0; k < 4; k++){
+        oPtr[2*k] += (float)aPtr[k] * bPtr[0];
+        oPtr[2*k+1] += (float)aPtr[k] * bPtr[1];
+      }
+      aPtr++;
+      bPtr += 2;
+    }
+  }
+
+  for(; j < num_points; j++){
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+    float accr = 0, acci = 0;
+    for(i = 0; i < num_taps; i++){
+      accr += (float)input[j+i] * bPtr[2*i];
+      acci += (float)input[j+i] * bPtr[2*i+1];
+    }
+    oPtr[0] = accr;
+    oPtr[1] = acci;
+  }
+}
+
+#endif /*LV_HAVE_SSE2*/
+
+
+#endif /*INCLUDED_volk_16i_32fc_fir_32fc_u_H*/
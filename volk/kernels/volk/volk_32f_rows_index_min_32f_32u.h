@@ -0,0 +1,141 @@
+#ifndef INCLUDED_volk_32f_rows_index_min_32f_32u_u_H
+#define INCLUDED_volk_32f_rows_index_min_32f_32u_u_H
+
+#include <volk/volk_common.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+/*!
+  \brief Finds, for every column of a matrix stored row after row, the smallest entry and the row it is in
+  \param minVector The num_points column minima
+  \param indexVector The num_points rows the minima are in; the first such row if there are several
+  \param rows The num_rows rows of num_points values each, one after the other
+  \param num_rows The number of rows
+  \param num_points The number of values in a row
+*/
+static inline void volk_32f_rows_index_min_32f_32u_generic(float* minVector, unsigned int* indexVector, const float* rows, unsigned int num_rows, unsigned int num_points){
+  unsigned int j, r;
+
+  for(j = 0; j < num_points; j++){
+    float best = rows[j];
+    unsigned int index = 0;
+    for(r = 1; r < num_rows; r++){
+      const float c = rows[r*num_points+j];
+      if(c < best){
+        best = c;
+        index = r;
+      }
+    }
+    minVector[j] = best;
+    indexVector[j] = index;
+  }
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_SSE2
+#include <emmintrin.h>
+
+static inline void volk_32f_rows_index_min_32f_32u_u_sse2(float* minVector, unsigned int* indexVector, const float* rows, unsigned int num_rows, unsigned int num_points){
+  const unsigned int quarterPoints = num_points / 4;
+  unsigned int number, r;
+
+  for(number = 0; number < quarterPoints; number++){
+    const float* aPtr = rows + number * 4;
+
+    __m128 best = _mm_loadu_ps(aPtr);
+    __m128 cVal, lt;
+    __m128 index = _mm_setzero_ps();
+    __m128 rVal = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    // The row numbers are counted as floats, which is exact for any
+    // sensible number of rows, and converted once at the end.
+    for(r = 1; r < num_rows; r++){
+      aPtr += num_points;
+      cVal = _mm_loadu_ps(aPtr);
+      rVal = _mm_add_ps(rVal, one);
+
+      // Strictly smaller only, so ties keep the earlier row.
+      lt = _mm_cmplt_ps(cVal, best);
+      best = _mm_min_ps(cVal, best);
+      index = _mm_or_ps(_mm_and_ps(lt, rVal), _mm_andnot_ps(lt, index));
+    }
+
+    _mm_storeu_ps(minVector + number * 4, best);
+    _mm_storeu_si128((__m128i*)(indexVector + number * 4), _mm_cvttps_epi32(index));
+  }
+
+  for(number = quarterPoints * 4; number < num_points; number++){
+    float best = rows[number];
+    unsigned int index = 0;
+    for(r = 1; r < num_rows; r++){
+      const float c = rows[r*num_points+number];
+      if(c < best){
+        best = c;
+        index = r;
+      }
+    }
+    minVector[number] = best;
+    indexVector[number] = index;
+  }
+}
+
+#endif /*LV_HAVE_SSE2*/
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32f_rows_index_min_32f_32u_u_avx(float* minVector, unsigned int* indexVector, const float* rows, unsigned int num_rows, unsigned int num_points){
+  const unsigned int eighthPoints = num_points / 8;
+  unsigned int number, r;
+
+  for(number = 0; number < eighthPoints; number++){
+    const float* aPtr = rows + number * 8;
+
+    __m256 best = _mm256_loadu_ps(aPtr);
+    __m256 cVal, lt;
+    __m256 index = _mm256_setzero_ps();
+    __m256 rVal = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    // The row numbers are counted as floats, as in the SSE2 version.
+    for(r = 1; r < num_rows; r++){
+      aPtr += num_points;
+      cVal = _mm256_loadu_ps(aPtr);
+      rVal = _mm256_add_ps(rVal, one);
+
+      // Strictly smaller only, so ties keep the earlier row.
+      lt = _mm256_cmp_ps(cVal, best, _CMP_LT_OQ);
+      best = _mm256_min_ps(cVal, best);
+      index = _mm256_or_ps(_mm256_and_ps(lt, rVal), _mm256_andnot_ps(lt, index));
+    }
+
+    _mm256_storeu_ps(minVector + number * 8, best);
+    _mm256_storeu_si256((__m256i*)(indexVector + number * 8), _mm256_cvttps_epi32(index));
+  }
+
+  for(number = eighthPoints * 8; number < num_points; number++){
+    float best = rows[number];
+    unsigned int index = 0;
+    for(r = 1; r < num_rows; r++){
+      const float c = rows[r*num_points+number];
+      if(c < best){
+        best = c;
+        index = r;
+      }
+    }
+    minVector[number] = best;
+    indexVector[number] = index;
+  }
+}
+
+#endif /*LV_HAVE_AVX*/
+
+
+#endif /*INCLUDED_volk_32f_rows_index_min_32f_32u_u_H*/
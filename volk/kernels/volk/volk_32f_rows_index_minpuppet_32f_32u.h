@@ -0,0 +1,45 @@
+#ifndef INCLUDED_volk_32f_rows_index_minpuppet_32f_32u_u_H
+#define INCLUDED_volk_32f_rows_index_minpuppet_32f_32u_u_H
+
+#include <volk/volk_common.h>
+#include <volk/volk_32f_rows_index_min_32f_32u.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+/*!
+  \brief Runs volk_32f_rows_index_min_32f_32u on num_points values taken as 7 rows, so that it can be driven like any other kernel
+  \param minVector The num_points/7 column minima
+  \param indexVector The num_points/7 rows the minima are in
+  \param rows The num_points values
+  \param num_points The number of values
+*/
+static inline void volk_32f_rows_index_minpuppet_32f_32u_generic(float* minVector, unsigned int* indexVector, const float* rows, unsigned int num_points){
+  const unsigned int num_rows = 7;
+  volk_32f_rows_index_min_32f_32u_generic(minVector, indexVector, rows, num_rows, num_points / num_rows);
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_SSE2
+
+static inline void volk_32f_rows_index_minpuppet_32f_32u_u_sse2(float* minVector, unsigned int* indexVector, const float* rows, unsigned int num_points){
+  const unsigned int num_rows = 7;
+  volk_32f_rows_index_min_32f_32u_u_sse2(minVector, indexVector, rows, num_rows, num_points / num_rows);
+}
+
+#endif /*LV_HAVE_SSE2*/
+
+
+#ifdef LV_HAVE_AVX
+
+static inline void volk_32f_rows_index_minpuppet_32f_32u_u_avx(float* minVector, unsigned int* indexVector, const float* rows, unsigned int num_points){
+  const unsigned int num_rows = 7;
+  volk_32f_rows_index_min_32f_32u_u_avx(minVector, indexVector, rows, num_rows, num_points / num_rows);
+}
+
+#endif /*LV_HAVE_AVX*/
+
+
+#endif /*INCLUDED_volk_32f_rows_index_minpuppet_32f_32u_u_H*/
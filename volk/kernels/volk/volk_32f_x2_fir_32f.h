@@ -0,0 +1,173 @@
+#ifndef INCLUDED_volk_32f_x2_fir_32f_u_H
+#define INCLUDED_volk_32f_x2_fir_32f_u_H
+
+#include <volk/volk_common.h>
+#include <stdio.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+/*!
+  \brief Runs an FIR filter over a block of input, four outputs per pass over the taps
+  \param outputs The num_points outputs; outputs[j] is the dot product of input[j ... j+num_taps-1] and taps
+  \param input The num_points+num_taps-1 input samples
+  \param taps The filter taps, in the order they are applied to the input (ie, time reversed)
+  \param num_taps The number of taps
+  \param num_points The number of outputs to compute
+*/
+static inline void volk_32f_x2_fir_32f_generic(float* outputs, const float* input, const float* taps, unsigned int num_taps, unsigned int num_points){
+  unsigned int j = 0, i;
+
+  // Four outputs share every tap load.
+  for(; j + 4 <= num_points; j += 4){
+    const float* aPtr = input + j;
+    float acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+
+    for(i = 0; i < num_taps; i++){
+      const float t = taps[i];
+      acc0 += aPtr[i] * t;
+      acc1 += aPtr[i+1] * t;
+      acc2 += aPtr[i+2] * t;
+      acc3 += aPtr[i+3] * t;
+    }
+
+    outputs[j] = acc0;
+    outputs[j+1] = acc1;
+    outputs[j+2] = acc2;
+    outputs[j+3] = acc3;
+  }
+
+  for(; j < num_points; j++){
+    float acc = 0;
+    for(i = 0; i < num_taps; i++){
+      acc += input[j+i] * taps[i];
+    }
+    outputs[j] = acc;
+  }
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_SSE
+#include <xmmintrin.h>
+
+static inline void volk_32f_x2_fir_32f_u_sse(float* outputs, const float* input, const float* taps, unsigned int num_taps, unsigned int num_points){
+  const unsigned int quarterTaps = num_taps / 4;
+  unsigned int j = 0, i;
+
+  for(; j + 4 <= num_points; j += 4){
+    const float* aPtr = input + j;
+    const float* bPtr = taps;
+
+    __m128 tVal;
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+
+    // Output k only sees the input shifted by k; the taps are loaded
+    // once for all four.
+    for(i = 0; i < quarterTaps; i++){
+      tVal = _mm_loadu_ps(bPtr);
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(aPtr), tVal));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(aPtr+1), tVal));
+      acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(aPtr+2), tVal));
+      acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(aPtr+3), tVal));
+      aPtr += 4;
+      bPtr += 4;
+    }
+
+    // Sum across each accumulator: lane k of the result is output k.
+    _MM_TRANSPOSE4_PS(acc0, acc1, acc2, acc3);
+    acc0 = _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3));
+    _mm_storeu_ps(outputs + j, acc0);
+
+    for(i = quarterTaps * 4; i < num_taps; i++){
+      const float t = *bPtr++;
+      outputs[j] += aPtr[0] * t;
+      outputs[j+1] += aPtr[1] * t;
+      outputs[j+2] += aPtr[2] * t;
+      outputs[j+3] += aPtr[3] * t;
+      aPtr++;
+    }
+  }
+
+  for(; j < num_points; j++){
+    float acc = 0;
+    for(i = 0; i < num_taps; i++){
+      acc += input[j+i] * taps[i];
+    }
+    outputs[j] = acc;
+  }
+}
+
+#endif /*LV_HAVE_SSE*/
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32f_x2_fir_32f_u_avx(float* outputs, const float* input, const float* taps, unsigned int num_taps, unsigned int num_points){
+  const unsigned int eighthTaps = num_taps / 8;
+  unsigned int j = 0, i, k;
+
+  // Eight outputs per pass; eight accumulators, the taps and one
+  // input vector still fit in the registers.
+  for(; j + 8 <= num_points; j += 8){
+    const float* aPtr = input + j;
+    const float* bPtr = taps;
+
+    __m256 tVal;
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    __m256 acc4 = _mm256_setzero_ps();
+    __m256 acc5 = _mm256_setzero_ps();
+    __m256 acc6 = _mm256_setzero_ps();
+    __m256 acc7 = _mm256_setzero_ps();
+
+    for(i = 0; i < eighthTaps; i++){
+      tVal = _mm256_loadu_ps(bPtr);
+      acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(aPtr), tVal));
+      acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(aPtr+1), tVal));
+      acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(aPtr+2), tVal));
+      acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(aPtr+3), tVal));
+      acc4 = _mm256_add_ps(acc4, _mm256_mul_ps(_mm256_loadu_ps(aPtr+4), tVal));
+      acc5 = _mm256_add_ps(acc5, _mm256_mul_ps(_mm256_loadu_ps(aPtr+5), tVal));
+      acc6 = _mm256_add_ps(acc6, _mm256_mul_ps(_mm256_loadu_ps(aPtr+6), tVal));
+      acc7 = _mm256_add_ps(acc7, _mm256_mul_ps(_mm256_loadu_ps(aPtr+7), tVal));
+      aPtr += 8;
+      bPtr += 8;
+    }
+
+    // Sum across each accumulator: element k of the result is output k.
+    acc0 = _mm256_hadd_ps(_mm256_hadd_ps(acc0, acc1), _mm256_hadd_ps(acc2, acc3));
+    acc4 = _mm256_hadd_ps(_mm256_hadd_ps(acc4, acc5), _mm256_hadd_ps(acc6, acc7));
+    acc0 = _mm256_add_ps(_mm256_permute2f128_ps(acc0, acc4, 0x20),
+                         _mm256_permute2f128_ps(acc0, acc4, 0x31));
+    _mm256_storeu_ps(outputs + j, acc0);
+
+    for(i = eighthTaps * 8; i < num_taps; i++){
+      const float t = *bPtr++;
+      for(k = 0; k < 8; k++){
+        outputs[j+k] += aPtr[k] * t;
+      }
+      aPtr++;
+    }
+  }
+
+  for(; j < num_points; j++){
+    float acc = 0;
+    for(i = 0; i < num_taps; i++){
+      acc += input[j+i] * taps[i];
+    }
+    outputs[j] = acc;
+  }
+}
+
+#endif /*LV_HAVE_AVX*/
+
+
+#endif /*INCLUDED_volk_32f_x2_fir_32f_u_H*/
@@ -0,0 +1,203 @@
+#ifndef INCLUDED_volk_32fc_32f_fir_32fc_u_H
+#define INCLUDED_volk_32fc_32f_fir_32fc_u_H
+
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+#include <stdio.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+/*!
+  \brief Runs a real FIR filter over a block of complex input, four outputs per pass over the taps
+  \param outputs The num_points outputs; outputs[j] is the dot product of input[j ... j+num_taps-1] and taps
+  \param input The num_points+num_taps-1 input samples
+  \param taps The filter taps, in the order they are applied to the input (ie, time reversed)
+  \param num_taps The number of taps
+  \param num_points The number of outputs to compute
+*/
+static inline void volk_32fc_32f_fir_32fc_generic(lv_32fc_t* outputs, const lv_32fc_t* input, const float* taps, unsigned int num_taps, unsigned int num_points){
+  unsigned int j = 0, i;
+
+  // Four outputs share every tap load.
+  for(; j + 4 <= num_points; j += 4){
+    const float* aPtr = (const float*)(input + j);
+    float* oPtr = (float*)(outputs + j);
+    float acc0r = 0, acc0i = 0, acc1r = 0, acc1i = 0;
+    float acc2r = 0, acc2i = 0, acc3r = 0, acc3i = 0;
+
+    for(i = 0; i < num_taps; i++){
+      const float t = taps[i];
+      acc0r += aPtr[0] * t;
+      acc0i += aPtr[1] * t;
+      acc1r += aPtr[2] * t;
+      acc1i += aPtr[3] * t;
+      acc2r += aPtr[4] * t;
+      acc2i += aPtr[5] * t;
+      acc3r += aPtr[6] * t;
+      acc3i += aPtr[7] * t;
+      aPtr += 2;
+    }
+
+    oPtr[0] = acc0r;
+    oPtr[1] = acc0i;
+    oPtr[2] = acc1r;
+    oPtr[3] = acc1i;
+    oPtr[4] = acc2r;
+    oPtr[5] = acc2i;
+    oPtr[6] = acc3r;
+    oPtr[7] = acc3i;
+  }
+
+  for(; j < num_points; j++){
+    const float* aPtr = (const float*)(input + j);
+    float* oPtr = (float*)(outputs + j);
+    float accr = 0, acci = 0;
+    for(i = 0; i < num_taps; i++){
+      accr += aPtr[2*i] * taps[i];
+      acci += aPtr[2*i+1] * taps[i];
+    }
+    oPtr[0] = accr;
+    oPtr[1] = acci;
+  }
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_SSE
+#include <xmmintrin.h>
+
+static inline void volk_32fc_32f_fir_32fc_u_sse(lv_32fc_t* outputs, const lv_32fc_t* input, const float* taps, unsigned int num_taps, unsigned int num_points){
+  const unsigned int quarterTaps = num_taps / 4;
+  unsigned int j = 0, i, k;
+
+  for(; j + 4 <= num_points; j += 4){
+    const float* aPtr = (const float*)(input + j);
+    const float* bPtr = taps;
+    float* oPtr = (float*)(outputs + j);
+
+    __m128 xVal, t0Val, t1Val;
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+
+    for(i = 0; i < quarterTaps; i++){
+      xVal = _mm_loadu_ps(bPtr);
+      t0Val = _mm_unpacklo_ps(xVal, xVal); // t0 t0 t1 t1
+      t1Val = _mm_unpackhi_ps(xVal, xVal); // t2 t2 t3 t3
+
+      // Output k starts k complex samples (2k floats) further on.
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(aPtr), t0Val));
+      acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(aPtr+4), t1Val));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(aPtr+2), t0Val));
+      acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(aPtr+6), t1Val));
+      acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(aPtr+4), t0Val));
+      acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(aPtr+8), t1Val));
+      acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(aPtr+6), t0Val));
+      acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(aPtr+10), t1Val));
+      aPtr += 8;
+      bPtr += 4;
+    }
+
+    // Each accumulator holds two partial sums of one output; fold
+    // them into (out0, out1) and (out2, out3).
+    acc0 = _mm_add_ps(_mm_movelh_ps(acc0, acc1), _mm_movehl_ps(acc1, acc0));
+    acc2 = _mm_add_ps(_mm_movelh_ps(acc2, acc3), _mm_movehl_ps(acc3, acc2));
+    _mm_storeu_ps(oPtr, acc0);
+    _mm_storeu_ps(oPtr+4, acc2);
+
+    for(i = quarterTaps * 4; i < num_taps; i++){
+      const float t = *bPtr++;
+      for(k = 0; k < 8; k++){
+        oPtr[k] += aPtr[k] * t;
+      }
+      aPtr += 2;
+    }
+  }
+
+  for(; j < num_points; j++){
+    const float* aPtr = (const float*)(input + j);
+    float* oPtr = (float*)(outputs + j);
+    float accr = 0, acci = 0;
+    for(i = 0; i < num_taps; i++){
+      accr += aPtr[2*i] * taps[i];
+      acci += aPtr[2*i+1] * taps[i];
+    }
+    oPtr[0] = accr;
+    oPtr[1] = acci;
+  }
+}
+
+#endif /*LV_HAVE_SSE*/
+
+
+#ifdef LV_HAVE_AVX
+#include <immintrin.h>
+
+static inline void volk_32fc_32f_fir_32fc_u_avx(lv_32fc_t* outputs, const lv_32fc_t* input, const float* taps, unsigned int num_taps, unsigned int num_points){
+  const unsigned int quarterTaps = num_taps / 4;
+  unsigned int j = 0, i, k;
+
+  for(; j + 4 <= num_points; j += 4){
+    const float* aPtr = (const float*)(input + j);
+    const float* bPtr = taps;
+    float* oPtr = (float*)(outputs + j);
+
+    __m128 xVal, sum0, sum1, sum2, sum3;
+    __m256 tVal;
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+
+    for(i = 0; i < quarterTaps; i++){
+      xVal = _mm_loadu_ps(bPtr);
+      tVal = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(xVal, xVal)),
+                                  _mm_unpackhi_ps(xVal, xVal), 1); // t0 t0 t1 t1 t2 t2 t3 t3
+
+      // Output k starts k complex samples (2k floats) further on.
+      acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(aPtr), tVal));
+      acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(aPtr+2), tVal));
+      acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(aPtr+4), tVal));
+      acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(aPtr+6), tVal));
+      aPtr += 8;
+      bPtr += 4;
+    }
+
+    // Each accumulator holds four partial sums of one output; fold
+    // them into (out0, out1) and (out2, out3).
+    sum0 = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    sum1 = _mm_add_ps(_mm256_castps256_ps128(acc1), _mm256_extractf128_ps(acc1, 1));
+    sum2 = _mm_add_ps(_mm256_castps256_ps128(acc2), _mm256_extractf128_ps(acc2, 1));
+    sum3 = _mm_add_ps(_mm256_castps256_ps128(acc3), _mm256_extractf128_ps(acc3, 1));
+    _mm_storeu_ps(oPtr, _mm_add_ps(_mm_movelh_ps(sum0, sum1), _mm_movehl_ps(sum1, sum0)));
+    _mm_storeu_ps(oPtr+4, _mm_add_ps(_mm_movelh_ps(sum2, sum3), _mm_movehl_ps(sum3, sum2)));
+
+    for(i = quarterTaps * 4; i < num_taps; i++){
+      const float t = *bPtr++;
+      for(k = 0; k < 8; k++){
+        oPtr[k] += aPtr[k] * t;
+      }
+      aPtr += 2;
+    }
+  }
+
+  for(; j < num_points; j++){
+    const float* aPtr = (const float*)(input + j);
+    float* oPtr = (float*)(outputs + j);
+    float accr = 0, acci = 0;
+    for(i = 0; i < num_taps; i++){
+      accr += aPtr[2*i] * taps[i];
+      acci += aPtr[2*i+1] * taps[i];
+    }
+    oPtr[0] = accr;
+    oPtr[1] = acci;
+  }
+}
+
+#endif /*LV_HAVE_AVX*/
+
+
+#endif /*INCLUDED_volk_32fc_32f_fir_32fc_u_H*/
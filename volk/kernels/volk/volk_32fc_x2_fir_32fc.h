@@ -0,0 +1,152 @@
+#ifndef INCLUDED_volk_32fc_x2_fir_32fc_u_H
+#define INCLUDED_volk_32fc_x2_fir_32fc_u_H
+
+#include <volk/volk_common.h>
+#include <volk/volk_complex.h>
+#include <stdio.h>
+
+
+#ifdef LV_HAVE_GENERIC
+
+/*!
+  \brief Runs a complex FIR filter over a block of complex input, four outputs per pass over the taps
+  \param outputs The num_points outputs; outputs[j] is the dot product of input[j ... j+num_taps-1] and taps
+  \param input The num_points+num_taps-1 input samples
+  \param taps The filter taps, in the order they are applied to the input (ie, time reversed)
+  \param num_taps The number of taps
+  \param num_points The number of outputs to compute
+*/
+static inline void volk_32fc_x2_fir_32fc_generic(lv_32fc_t* outputs, const lv_32fc_t* input, const lv_32fc_t* taps, unsigned int num_taps, unsigned int num_points){
+  unsigned int j = 0, i;
+
+  // Four outputs share every tap load.
+  for(; j + 4 <= num_points; j += 4){
+    const float* aPtr = (const float*)(input + j);
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+    float acc0r = 0, acc0i = 0, acc1r = 0, acc1i = 0;
+    float acc2r = 0, acc2i = 0, acc3r = 0, acc3i = 0;
+
+    for(i = 0; i < num_taps; i++){
+      const float tr = bPtr[0];
+      const float ti = bPtr[1];
+      acc0r += aPtr[0] * tr - aPtr[1] * ti;
+      acc0i += aPtr[0] * ti + aPtr[1] * tr;
+      acc1r += aPtr[2] * tr - aPtr[3] * ti;
+      acc1i += aPtr[2] * ti + aPtr[3] * tr;
+      acc2r += aPtr[4] * tr - aPtr[5] * ti;
+      acc2i += aPtr[4] * ti + aPtr[5] * tr;
+      acc3r += aPtr[6] * tr - aPtr[7] * ti;
+      acc3i += aPtr[6] * ti + aPtr[7] * tr;
+      aPtr += 2;
+      bPtr += 2;
+    }
+
+    oPtr[0] = acc0r;
+    oPtr[1] = acc0i;
+    oPtr[2] = acc1r;
+    oPtr[3] = acc1i;
+    oPtr[4] = acc2r;
+    oPtr[5] = acc2i;
+    oPtr[6] = acc3r;
+    oPtr[7] = acc3i;
+  }
+
+  for(; j < num_points; j++){
+    const float* aPtr = (const float*)(input + j);
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+    float accr = 0, acci = 0;
+    for(i = 0; i < num_taps; i++){
+      accr += aPtr[2*i] * bPtr[2*i] - aPtr[2*i+1] * bPtr[2*i+1];
+      acci += aPtr[2*i] * bPtr[2*i+1] + aPtr[2*i+1] * bPtr[2*i];
+    }
+    oPtr[0] = accr;
+    oPtr[1] = acci;
+  }
+}
+
+#endif /*LV_HAVE_GENERIC*/
+
+
+#ifdef LV_HAVE_SSE3
+#include <pmmintrin.h>
+
+static inline void volk_32fc_x2_fir_32fc_u_sse3(lv_32fc_t* outputs, const lv_32fc_t* input, const lv_32fc_t* taps, unsigned int num_taps, unsigned int num_points){
+  const unsigned int halfTaps = num_taps / 2;
+  unsigned int j = 0, i, k;
+
+  for(; j + 4 <= num_points; j += 4){
+    const float* aPtr = (const float*)(input + j);
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+
+    __m128 xVal, trVal, tiVal;
+    __m128 acc0r = _mm_setzero_ps(), acc0i = _mm_setzero_ps();
+    __m128 acc1r = _mm_setzero_ps(), acc1i = _mm_setzero_ps();
+    __m128 acc2r = _mm_setzero_ps(), acc2i = _mm_setzero_ps();
+    __m128 acc3r = _mm_setzero_ps(), acc3i = _mm_setzero_ps();
+
+    // Accumulate the input times the real and times the imaginary
+    // parts of the taps separately; they are combined into complex
+    // products once, at the end.
+    for(i = 0; i < halfTaps; i++){
+      xVal = _mm_loadu_ps(bPtr);
+      trVal = _mm_moveldup_ps(xVal); // tr0 tr0 tr1 tr1
+      tiVal = _mm_movehdup_ps(xVal); // ti0 ti0 ti1 ti1
+
+      xVal = _mm_loadu_ps(aPtr);
+      acc0r = _mm_add_ps(acc0r, _mm_mul_ps(xVal, trVal));
+      acc0i = _mm_add_ps(acc0i, _mm_mul_ps(xVal, tiVal));
+      xVal = _mm_loadu_ps(aPtr+2);
+      acc1r = _mm_add_ps(acc1r, _mm_mul_ps(xVal, trVal));
+      acc1i = _mm_add_ps(acc1i, _mm_mul_ps(xVal, tiVal));
+      xVal = _mm_loadu_ps(aPtr+4);
+      acc2r = _mm_add_ps(acc2r, _mm_mul_ps(xVal, trVal));
+      acc2i = _mm_add_ps(acc2i, _mm_mul_ps(xVal, tiVal));
+      xVal = _mm_loadu_ps(aPtr+6);
+      acc3r = _mm_add_ps(acc3r, _mm_mul_ps(xVal, trVal));
+      acc3i = _mm_add_ps(acc3i, _mm_mul_ps(xVal, tiVal));
+      aPtr += 4;
+      bPtr += 4;
+    }
+
+    // ar*tr - ai*ti, ai*tr + ar*ti
+    acc0r = _mm_addsub_ps(acc0r, _mm_shuffle_ps(acc0i, acc0i, 0xB1));
+    acc1r = _mm_addsub_ps(acc1r, _mm_shuffle_ps(acc1i, acc1i, 0xB1));
+    acc2r = _mm_addsub_ps(acc2r, _mm_shuffle_ps(acc2i, acc2i, 0xB1));
+    acc3r = _mm_addsub_ps(acc3r, _mm_shuffle_ps(acc3i, acc3i, 0xB1));
+
+    // Each accumulator holds two partial sums of one output; fold
+    // them into (out0, out1) and (out2, out3).
+    acc0r = _mm_add_ps(_mm_movelh_ps(acc0r, acc1r), _mm_movehl_ps(acc1r, acc0r));
+    acc2r = _mm_add_ps(_mm_movelh_ps(acc2r, acc3r), _mm_movehl_ps(acc3r, acc2r));
+    _mm_storeu_ps(oPtr, acc0r);
+    _mm_storeu_ps(oPtr+4, acc2r);
+
+    if(num_taps & 1){
+      for(k = 0; k < 4; k++){
+        oPtr[2*k] += aPtr[2*k] * bPtr[0] - aPtr[2*k+1] * bPtr[1];
+        oPtr[2*k+1] += aPtr[2*k] * bPtr[1] + aPtr[2*k+1] * bPtr[0];
+      }
+    }
+  }
+
+  for(; j < num_points; j++){
+    const float* aPtr = (const float*)(input + j);
+    const float* bPtr = (const float*)taps;
+    float* oPtr = (float*)(outputs + j);
+    float accr = 0, acci = 0;
+    for(i = 0; i < num_taps; i++){
+      accr += aPtr[2*i] * bPtr[2*i] - aPtr[2*i+1] * bPtr[2*i+1];
+      acci += aPtr[2*i] * bPtr[2*i+1] + aPtr[2*i+1] * bPtr[2*i];
+    }
+    oPtr[0] = accr;
+    oPtr[1] = acci;
+  }
+}
+
+#endif /*LV_HAVE_SSE3*/
+
+
+#endif /*INCLUDED_volk_32fc_x2_fir_32fc_u_H*/
@@ -475,3 +475,67 @@ bool run_volk_tests(volk_func_desc_t desc,
 }
 
 
+
+static void fir_random(float &x) { x = uniform(); }
+static void fir_random(lv_32fc_t &x) { x = lv_cmake(uniform(), uniform()); }
+static void fir_random(short &x) { x = short(uniform() * 32767); }
+static float fir_abs(float x) { return std::fabs(x); }
+static float fir_abs(lv_32fc_t x) { return std::abs(x); }
+
+//The fir kernels take a tap count besides the vector length, so they
+//get their own runner. Sums of random data can cancel to almost
+//nothing, which makes a relative error meaningless; each output is
+//held to tol times the sum of the magnitudes of its terms instead.
+template <class O, class I, class T>
+bool run_volk_fir_tests(volk_func_desc_t desc,
+                        void (*manual_func)(O *, const I *, const T *, unsigned int, unsigned int, const char *),
+                        std::string name,
+                        float tol) {
+    std::cout << "RUN_VOLK_FIR_TESTS: " << name << std::endl;
+
+    std::vector<std::string> arch_list = get_arch_list(desc);
+    const unsigned int num_points = 2047;
+    const unsigned int tap_counts[] = {1, 3, 13, 64};
+
+    bool fail = false;
+    for(size_t t = 0; t < sizeof(tap_counts)/sizeof(tap_counts[0]); t++) {
+        const unsigned int num_taps = tap_counts[t];
+        std::vector<I> input(num_points + num_taps - 1);
+        std::vector<T> taps(num_taps);
+        for(size_t i = 0; i < input.size(); i++) fir_random(input[i]);
+        for(size_t i = 0; i < taps.size(); i++) fir_random(taps[i]);
+
+        std::vector<float> scale(num_points, 0);
+        for(unsigned int j = 0; j < num_points; j++)
+            for(unsigned int i = 0; i < num_taps; i++)
+                scale[j] += fir_abs(input[j+i]) * fir_abs(taps[i]);
+
+        std::vector<O> expected(num_points);
+        manual_func(&expected[0], &input[0], &taps[0], num_taps, num_points, "generic");
+
+        for(size_t a = 0; a < arch_list.size(); a++) {
+            if(arch_list[a] == "generic") continue;
+            std::vector<O> result(num_points);
+            manual_func(&result[0], &input[0], &taps[0], num_taps, num_points, arch_list[a].c_str());
+
+            int print_max_errs = 10;
+            for(unsigned int j = 0; j < num_points; j++) {
+                if(fir_abs(result[j] - expected[j]) > tol * scale[j]) {
+                    fail = true;
+                    if(print_max_errs-- > 0) {
+                        std::cout << name << ": fail on arch " << arch_list[a] << " with " << num_taps
+                                  << " taps at offset " << j << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    return fail;
+}
+
+template bool run_volk_fir_tests(volk_func_desc_t, void (*)(float *, const float *, const float *, unsigned int, unsigned int, const char *), std::string, float);
+template bool run_volk_fir_tests(volk_func_desc_t, void (*)(lv_32fc_t *, const lv_32fc_t *, const lv_32fc_t *, unsigned int, unsigned int, const char *), std::string, float);
+template bool run_volk_fir_tests(volk_func_desc_t, void (*)(lv_32fc_t *, const lv_32fc_t *, const float *, unsigned int, unsigned int, const char *), std::string, float);
+template bool run_volk_fir_tests(volk_func_desc_t, void (*)(lv_32fc_t *, const float *, const lv_32fc_t *, unsigned int, unsigned int, const char *), std::string, float);
+template bool run_volk_fir_tests(volk_func_desc_t, void (*)(lv_32fc_t *, const short *, const lv_32fc_t *, unsigned int, unsigned int, const char *), std::string, float);
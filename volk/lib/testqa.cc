@@ -88,3 +88,9 @@ VOLK_RUN_TESTS(volk_32f_x2_multiply_32f, 1e-4, 0, 20462, 1);
 VOLK_RUN_TESTS(volk_32fc_s32fc_multiply_32fc, 1e-4, 0, 20462, 1);
 VOLK_RUN_TESTS(volk_32f_s32f_multiply_32f, 1e-4, 0, 20462, 1);
 VOLK_RUN_TESTS(volk_32fc_s32fc_rotatorpuppet_32fc, 1e-2, (lv_32fc_t)lv_cmake(0.953939201, 0.3), 20462, 1);
+VOLK_RUN_TESTS(volk_32f_rows_index_minpuppet_32f_32u, 0, 0, 20462, 1);
+VOLK_RUN_FIR_TESTS(volk_32f_x2_fir_32f, 1e-5);
+VOLK_RUN_FIR_TESTS(volk_32fc_x2_fir_32fc, 1e-5);
+VOLK_RUN_FIR_TESTS(volk_32fc_32f_fir_32fc, 1e-5);
+VOLK_RUN_FIR_TESTS(volk_32f_32fc_fir_32fc, 1e-5);
+VOLK_RUN_FIR_TESTS(volk_16i_32fc_fir_32fc, 1e-5);